@@ -1,9 +1,18 @@
+#include "fe12x4.h"
+#include "fe51.h"
+#include "fe_convert.h"
+#include "ge.h"
+#include "hash_to_curve.h"
+#include "keypool.h"
+#include "mxcsr.h"
+#include "scalarmult.h"
+#include "schnorr.h"
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
-extern int crypto_scalarmult_curve13318_scalarmult(uint8_t*, const uint8_t*, const uint8_t*);
-
 static __inline__ unsigned long long rdtsc(void)
 {
   unsigned hi, lo;
@@ -11,19 +20,386 @@ static __inline__ unsigned long long rdtsc(void)
   return ( (unsigned long long)lo)|( ((unsigned long long)hi)<<32 );
 }
 
+static uint8_t out[64] = {0}, out2[64] = {0};
+static const uint8_t key[32] = {1};
+static const uint8_t in[64] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 179, 43, 106, 247, 206, 176, 201, 77, 137, 224, 122, 176, 76, 93, 29, 69, 190, 137, 17, 103, 105, 172, 236, 172, 225, 72, 243, 7, 94, 128, 240, 17};
+static ge p, q;
+static ge_x4 __attribute__((aligned(32))) p4, q4;
+static ge_interleaved __attribute__((aligned(32))) r_i, ptable_i[16];
+static ge_interleaved_packed __attribute__((aligned(32))) ptable_p[16];
+static fe12x4 __attribute__((aligned(32))) f4, g4;
+static uint8_t bytes4[4][32], out4[4][64];
+static const uint8_t lanes4[4] = {0, 1, 1, 0};
+static int8_t chi4[4];
+static fe51 f51[4];
+
+static void bench_scalarmult(void)
+{
+    int ret = scalarmult(out, key, in);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_scalarmult_two(void)
+{
+    int ret = scalarmult_two(out, out2, key, in, in);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_scalarmult_x2(void)
+{
+    int ret = scalarmult(out, key, in) | scalarmult(out2, key, in);
+    assert(ret == 0);
+    (void)ret;
+}
+
+// One point times many keys, batched or with a scalarmult call per key
+#define MANY_MAX 64
+static uint8_t many_keys[MANY_MAX][32] = {{1}, {2}, {3}, {4}, {5}, {6}, {7}};
+static uint8_t many_out[MANY_MAX][64];
+
+static void bench_scalarmult_many(size_t len)
+{
+    int ret = scalarmult_many(many_out, (const uint8_t (*)[32])many_keys, in, len);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_scalarmult_calls(size_t len)
+{
+    int ret = 0;
+    for (size_t i = 0; i < len; i++) ret |= scalarmult(many_out[i], many_keys[i], in);
+    assert(ret == 0);
+    (void)ret;
+}
+
+// 16 multiplications in one context session, against bench_scalarmult_x16
+static void bench_scalarmult_ctx16(void)
+{
+    static struct scalarmult_ctx *ctx = NULL;
+    if (ctx == NULL) ctx = scalarmult_ctx_new();
+    int ret = scalarmult_ctx_enter(ctx);
+    for (size_t i = 0; i < 16; i++) ret |= scalarmult_ctx_run(ctx, many_out[i], many_keys[i], in);
+    ret |= scalarmult_ctx_leave(ctx);
+    assert(ret == 0);
+    (void)ret;
+}
+
+// Low-stack mode, with an arena of our own or with the one of this thread
+static void bench_scalarmult_arena(void)
+{
+    static void *arena = NULL;
+    if (arena == NULL) arena = malloc(scalarmult_arena_size());
+    int ret = scalarmult_arena(out, key, in, arena);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_scalarmult_lowstack(void)
+{
+    int ret = scalarmult_lowstack(out, key, in);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_scalarmult_many4(void) { bench_scalarmult_many(4); }
+static void bench_scalarmult_many16(void) { bench_scalarmult_many(16); }
+static void bench_scalarmult_many64(void) { bench_scalarmult_many(64); }
+static void bench_scalarmult_x4(void) { bench_scalarmult_calls(4); }
+static void bench_scalarmult_x16(void) { bench_scalarmult_calls(16); }
+
+// The latency of one multiplication of a registered point
+static void bench_scalarmult_split(void)
+{
+    static struct split_point *point = NULL;
+    if (point == NULL) point = scalarmult_split_new(in);
+    int ret = scalarmult_split(out, key, point);
+    assert(ret == 0);
+    (void)ret;
+}
+
+// A handshake: a fresh ephemeral key pair, and the shared secret with a peer
+static void bench_handshake_inline(void)
+{
+    uint8_t secret_key[32], public_key[64];
+    int ret = keypair(secret_key, public_key, in) | scalarmult(out, secret_key, in);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_handshake_keypool(void)
+{
+    static struct keypool *pool = NULL;
+    uint8_t secret_key[32], public_key[64];
+    if (pool == NULL) {
+        // Start with a full pool, i.e. measure the steady state
+        pool = keypool_new(in, 16, 64);
+        assert(pool != NULL);
+        while (keypool_available(pool) < 64) {}
+    }
+    int ret = keypool_pop(pool, secret_key, public_key) | scalarmult(out, secret_key, in);
+    assert(ret == 0);
+    (void)ret;
+}
+
+#define SCHNORR_BATCH_MAX 64
+static uint8_t schnorr_public_keys[SCHNORR_BATCH_MAX][64];
+static uint8_t schnorr_secret_keys[SCHNORR_BATCH_MAX][96];
+static uint8_t schnorr_sigs[SCHNORR_BATCH_MAX][96];
+static const uint8_t *schnorr_msgs[SCHNORR_BATCH_MAX];
+static size_t schnorr_msg_lens[SCHNORR_BATCH_MAX];
+
+// Sign `in` with SCHNORR_BATCH_MAX different keys
+static void schnorr_setup(void)
+{
+    static int done = 0;
+    if (done) return;
+    for (unsigned int i = 0; i < SCHNORR_BATCH_MAX; i++) {
+        int ret = schnorr_keypair(schnorr_public_keys[i], schnorr_secret_keys[i]);
+        ret |= schnorr_sign(schnorr_sigs[i], in, sizeof(in), schnorr_secret_keys[i]);
+        assert(ret == 0);
+        (void)ret;
+        schnorr_msgs[i] = in;
+        schnorr_msg_lens[i] = sizeof(in);
+    }
+    done = 1;
+}
+
+static void bench_schnorr_sign(void)
+{
+    schnorr_setup();
+    int ret = schnorr_sign(schnorr_sigs[0], in, sizeof(in), schnorr_secret_keys[0]);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_schnorr_verify(void)
+{
+    schnorr_setup();
+    int ret = schnorr_verify(schnorr_sigs[0], in, sizeof(in), schnorr_public_keys[0]);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_schnorr_verify_batch(size_t len)
+{
+    schnorr_setup();
+    int ret = schnorr_verify_batch((const uint8_t (*)[96])schnorr_sigs, schnorr_msgs,
+                                   schnorr_msg_lens,
+                                   (const uint8_t (*)[64])schnorr_public_keys, len);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_schnorr_verify_batch4(void) { bench_schnorr_verify_batch(4); }
+static void bench_schnorr_verify_batch16(void) { bench_schnorr_verify_batch(16); }
+static void bench_schnorr_verify_batch64(void) { bench_schnorr_verify_batch(64); }
+
+static const uint8_t hash_dst[] = "curve13318-bench";
+static const uint8_t *const hash_msgs[4] = {in, in + 16, in + 32, in + 48};
+static const size_t hash_msg_lens[4] = {16, 16, 16, 16};
+
+static void bench_hash_to_curve(void)
+{
+    int ret = hash_to_curve(out, in, 16, hash_dst, sizeof(hash_dst) - 1);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_hash_to_curve_x4(void)
+{
+    static uint8_t outs[4][64];
+    int ret = hash_to_curve_x4(outs, hash_msgs, hash_msg_lens, hash_dst, sizeof(hash_dst) - 1);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_scalarmult_avx(void)
+{
+    int ret = scalarmult_avx(out, key, in);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_scalarmult_avx_intrin(void)
+{
+    int ret = scalarmult_avx_intrin(out, key, in);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_scalarmult_mulx(void)
+{
+    int ret = scalarmult_mulx(out, key, in);
+    assert(ret == 0);
+    (void)ret;
+}
+
+static void bench_scalarmult_sse2(void)
+{
+    int ret = scalarmult_sse2(out, key, in);
+    assert(ret == 0);
+    (void)ret;
+}
+
+// What the fe12 backend pays for its floating point environment
+static void bench_mxcsr(void)
+{
+    const unsigned int saved_mxcsr = replace_mxcsr();
+    const bool mxcsr_ok = restore_mxcsr(saved_mxcsr);
+    assert(mxcsr_ok);
+    (void)mxcsr_ok;
+}
+
+static void bench_ge_frombytes(void)
+{
+    int ret = ge_frombytes(q, in);
+    assert(ret == 0);
+    (void)ret;
+}
+
+// The output of one point, and of four points with two shared inversions
+static void bench_ge_tobytes(void) { ge_tobytes(out, p); }
+static void bench_ge_tobytes2_x2(void) {
+    ge_tobytes2(out4[0], out4[1], p, q);
+    ge_tobytes2(out4[2], out4[3], p, q);
+}
+
+static void bench_ge_add(void) { ge_add(q, q, p); }
+static void bench_ge_add_gen(void) { ge_add_gen(q, q, p); }
+static void bench_ge_add_c(void) { ge_add_c(q, q, p); }
+static void bench_ge_add_sse2(void) { ge_add_sse2(q, q, p); }
+static void bench_ge_add_intrin(void) { ge_add_intrin(q, q, p); }
+static void bench_ge_double(void) { ge_double(q, q); }
+static void bench_ge_double_gen(void) { ge_double_gen(q, q); }
+static void bench_ge_double_c(void) { ge_double_c(q, q); }
+static void bench_ge_double_sse2(void) { ge_double_sse2(q, q); }
+static void bench_ge_double_intrin(void) { ge_double_intrin(q, q); }
+static void bench_select_intrin(void) { select_intrin(r_i, 7, ptable_i); }
+static void bench_select_packed_intrin(void) { select_packed_intrin(r_i, 7, ptable_p); }
+static void bench_ge_add_x4(void) { ge_add_x4(q4, q4, p4); }
+static void bench_ge_double_x4(void) { ge_double_x4(q4, q4); }
+
+static void bench_fe12x4_add(void) { fe12x4_add(f4, f4, g4); }
+static void bench_fe12x4_sub(void) { fe12x4_sub(f4, f4, g4); }
+static void bench_fe12x4_mul(void) { fe12x4_mul(f4, f4, g4); }
+static void bench_fe12x4_square(void) { fe12x4_square(f4, f4); }
+static void bench_fe12x4_squeeze(void) { fe12x4_squeeze(f4); }
+static void bench_fe12x4_carry(void) { fe12x4_carry(f4); }
+static void bench_fe12x4_select(void) { fe12x4_select(f4, f4, g4, lanes4); }
+static void bench_fe12x4_frombytes(void) { fe12x4_frombytes(f4, (const uint8_t (*)[32])bytes4); }
+static void bench_fe12x4_tobytes(void) { fe12x4_tobytes(bytes4, f4); }
+static void bench_fe12x4_invert(void) { fe12x4_invert(f4, f4); }
+static void bench_fe12x4_sqrt(void) { fe12x4_sqrt(f4, bytes4[0], g4); }
+static void bench_fe12x4_legendre(void) { fe12x4_legendre(chi4, g4); }
+static void bench_ge_map_to_curve(void) { ge_map_to_curve(q, bytes4[0]); }
+static void bench_ge_map_to_curve_x4(void) { ge_map_to_curve_x4(q4, (const uint8_t (*)[32])bytes4); }
+static void bench_fe51_invert_x4(void) {
+    for (unsigned int i = 0; i < 4; i++) fe51_invert(&f51[i], &f51[i]);
+}
+
+static const struct {
+    const char *name;
+    void (*fn)(void);
+} benchmarks[] = {
+    {"scalarmult", bench_scalarmult},
+    {"scalarmult_avx", bench_scalarmult_avx},
+    {"scalarmult_avx_intrin", bench_scalarmult_avx_intrin},
+    {"scalarmult_two", bench_scalarmult_two},
+    {"scalarmult_split", bench_scalarmult_split},
+    {"scalarmult_ctx16", bench_scalarmult_ctx16},
+    {"scalarmult_arena", bench_scalarmult_arena},
+    {"scalarmult_lowstack", bench_scalarmult_lowstack},
+    {"scalarmult_many4", bench_scalarmult_many4},
+    {"scalarmult_many16", bench_scalarmult_many16},
+    {"scalarmult_many64", bench_scalarmult_many64},
+    {"handshake_inline", bench_handshake_inline},
+    {"handshake_keypool", bench_handshake_keypool},
+    {"schnorr_sign", bench_schnorr_sign},
+    {"schnorr_verify", bench_schnorr_verify},
+    {"schnorr_verify_batch4", bench_schnorr_verify_batch4},
+    {"schnorr_verify_batch16", bench_schnorr_verify_batch16},
+    {"schnorr_verify_batch64", bench_schnorr_verify_batch64},
+    {"hash_to_curve", bench_hash_to_curve},
+    {"hash_to_curve_x4", bench_hash_to_curve_x4},
+    {"ge_map_to_curve", bench_ge_map_to_curve},
+    {"ge_map_to_curve_x4", bench_ge_map_to_curve_x4},
+    {"scalarmult_x2", bench_scalarmult_x2},
+    {"scalarmult_x4", bench_scalarmult_x4},
+    {"scalarmult_x16", bench_scalarmult_x16},
+    {"scalarmult_mulx", bench_scalarmult_mulx},
+    {"scalarmult_sse2", bench_scalarmult_sse2},
+    {"mxcsr", bench_mxcsr},
+    {"ge_frombytes", bench_ge_frombytes},
+    {"ge_tobytes", bench_ge_tobytes},
+    {"ge_tobytes2_x2", bench_ge_tobytes2_x2},
+    {"ge_add", bench_ge_add},
+    {"ge_add_gen", bench_ge_add_gen},
+    {"ge_add_c", bench_ge_add_c},
+    {"ge_add_sse2", bench_ge_add_sse2},
+    {"ge_add_intrin", bench_ge_add_intrin},
+    {"ge_double", bench_ge_double},
+    {"ge_double_gen", bench_ge_double_gen},
+    {"ge_double_c", bench_ge_double_c},
+    {"ge_double_sse2", bench_ge_double_sse2},
+    {"ge_double_intrin", bench_ge_double_intrin},
+    {"select_intrin", bench_select_intrin},
+    {"select_packed_intrin", bench_select_packed_intrin},
+    {"ge_add_x4", bench_ge_add_x4},
+    {"ge_double_x4", bench_ge_double_x4},
+    {"fe12x4_add", bench_fe12x4_add},
+    {"fe12x4_sub", bench_fe12x4_sub},
+    {"fe12x4_mul", bench_fe12x4_mul},
+    {"fe12x4_square", bench_fe12x4_square},
+    {"fe12x4_squeeze", bench_fe12x4_squeeze},
+    {"fe12x4_carry", bench_fe12x4_carry},
+    {"fe12x4_select", bench_fe12x4_select},
+    {"fe12x4_frombytes", bench_fe12x4_frombytes},
+    {"fe12x4_tobytes", bench_fe12x4_tobytes},
+    {"fe12x4_invert", bench_fe12x4_invert},
+    {"fe12x4_sqrt", bench_fe12x4_sqrt},
+    {"fe12x4_legendre", bench_fe12x4_legendre},
+    {"fe51_invert_x4", bench_fe51_invert_x4},
+};
+
 int main(int argc, char *argv[])
 {
     unsigned long long start, diff, blank = 58; // blank was measure by me, by hand
+    const char *name = argc > 1 ? argv[1] : "scalarmult";
+    void (*fn)(void) = NULL;
 
-    uint8_t out[64] = {0};
-    const uint8_t key[32] = {1};
-    const uint8_t in[64] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 179, 43, 106, 247, 206, 176, 201, 77, 137, 224, 122, 176, 76, 93, 29, 69, 190, 137, 17, 103, 105, 172, 236, 172, 225, 72, 243, 7, 94, 128, 240, 17};
+    for (unsigned int i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        if (strcmp(name, benchmarks[i].name) == 0) fn = benchmarks[i].fn;
+    }
+    if (fn == NULL) {
+        fprintf(stderr, "unknown benchmark: %s\n", name);
+        return 1;
+    }
+
+    int ret = ge_frombytes(p, in);
+    assert(ret == 0);
+    (void)ret;
+    ge_copy(q, p);
+    for (unsigned int i = 0; i < 16; i++) {
+        ge_interleave(ptable_i[i], p);
+        ge_interleaved_pack(ptable_p[i], ptable_i[i]);
+    }
+    for (unsigned int c = 0; c < 3; c++) {
+        fe12x4_load(p4[c], p[c], p[c], p[c], p[c]);
+        fe12x4_load(q4[c], p[c], p[c], p[c], p[c]);
+    }
+    fe12x4_load(f4, p[0], p[1], p[2], p[0]);
+    fe12x4_load(g4, p[1], p[2], p[0], p[1]);
+    convert_fe12_to_fe51(&f51[0], p[0]);
+    convert_fe12_to_fe51(&f51[1], p[1]);
+    convert_fe12_to_fe51(&f51[2], p[2]);
+    convert_fe12_to_fe51(&f51[3], p[0]);
 
     for (unsigned int i = 0; i < 1000; i++) {
         start = rdtsc();
-        int ret = crypto_scalarmult_curve13318_scalarmult(out, key, in);
+        fn();
         diff = rdtsc() - start - blank;
-        assert(ret == 0);
         printf("%llu\n", diff);
     }
 
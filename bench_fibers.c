@@ -0,0 +1,179 @@
+#define _DEFAULT_SOURCE
+#include "scalarmult.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+/*
+Run many concurrent handshakes on small fiber stacks, and report the memory
+per in-flight handshake, the deepest stack that any fiber used, and the
+throughput.
+
+Every fiber does a handshake: it multiplies the base point by its key (its
+public key), yields as if it waits for the peer, multiplies the peer's point
+by its key (the shared secret) and yields again. The fibers run round-robin
+on one thread, so all of them are in flight at once.
+
+Every stack is painted before its fiber starts, and scanned after it is done,
+to find how deep it was used. Below every stack is a guard page, so a stack
+that is too small crashes instead of silently corrupting its neighbour.
+
+Usage: fibers.out [MODE [FIBERS [STACK_BYTES]]]
+
+  - MODE is one of "scalarmult", "avx_intrin", "arena" (an arena per fiber)
+    and "lowstack" (the arena of the thread); default "lowstack"
+  - FIBERS defaults to 10000
+  - STACK_BYTES defaults to 8192, and is rounded up to whole pages
+*/
+
+#define PAINT 0xA5
+
+static const uint8_t base[64] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 179, 43, 106, 247, 206, 176, 201, 77, 137, 224, 122, 176, 76, 93, 29, 69, 190, 137, 17, 103, 105, 172, 236, 172, 225, 72, 243, 7, 94, 128, 240, 17};
+
+enum mode { MODE_SCALARMULT, MODE_AVX_INTRIN, MODE_ARENA, MODE_LOWSTACK };
+
+struct fiber {
+    ucontext_t ctx;
+    uint8_t *stack;
+    void *arena;
+    uint8_t key[32], public_key[64], shared[64];
+    int done;
+    int err;
+};
+
+static enum mode mode;
+static size_t stack_size, page_size;
+static int n_fibers;
+static struct fiber *fibers;
+static ucontext_t scheduler;
+
+static int multiply(struct fiber *f, uint8_t *out, const uint8_t *in)
+{
+    switch (mode) {
+        case MODE_SCALARMULT: return scalarmult(out, f->key, in);
+        case MODE_AVX_INTRIN: return scalarmult_avx_intrin(out, f->key, in);
+        case MODE_ARENA:      return scalarmult_arena(out, f->key, in, f->arena);
+        case MODE_LOWSTACK:   return scalarmult_lowstack(out, f->key, in);
+    }
+    return -1;
+}
+
+static int peer(int i)
+{
+    // An odd one out does a handshake with itself
+    return (i ^ 1) < n_fibers ? (i ^ 1) : i;
+}
+
+static void handshake(int i)
+{
+    struct fiber *f = &fibers[i];
+    f->err |= multiply(f, f->public_key, base);
+    swapcontext(&f->ctx, &scheduler);
+    // Our peer (fibers 2k and 2k + 1 are peers) has sent its public key by now
+    f->err |= multiply(f, f->shared, fibers[peer(i)].public_key);
+    swapcontext(&f->ctx, &scheduler);
+    f->done = 1;
+}
+
+// The number of bytes of the stack of `f` that were written
+static size_t stack_depth(const struct fiber *f)
+{
+    size_t unused = 0;
+    while (unused < stack_size && f->stack[unused] == PAINT) unused++;
+    return stack_size - unused;
+}
+
+static double seconds(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *mode_name = argc > 1 ? argv[1] : "lowstack";
+    const int n = argc > 2 ? atoi(argv[2]) : 10000;
+    page_size = (size_t)sysconf(_SC_PAGESIZE);
+    stack_size = argc > 3 ? (size_t)atol(argv[3]) : 8192;
+    stack_size = (stack_size + page_size - 1) / page_size * page_size;
+
+    if (strcmp(mode_name, "scalarmult") == 0) mode = MODE_SCALARMULT;
+    else if (strcmp(mode_name, "avx_intrin") == 0) mode = MODE_AVX_INTRIN;
+    else if (strcmp(mode_name, "arena") == 0) mode = MODE_ARENA;
+    else if (strcmp(mode_name, "lowstack") == 0) mode = MODE_LOWSTACK;
+    else {
+        fprintf(stderr, "unknown mode: %s\n", mode_name);
+        return 1;
+    }
+    if (n < 1) {
+        fprintf(stderr, "need at least 1 fiber\n");
+        return 1;
+    }
+    n_fibers = n;
+
+    fibers = calloc((size_t)n, sizeof(*fibers));
+    if (fibers == NULL) return 1;
+    for (int i = 0; i < n; i++) {
+        struct fiber *f = &fibers[i];
+        uint8_t *region = mmap(NULL, page_size + stack_size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED || mprotect(region, page_size, PROT_NONE) != 0) {
+            perror("mmap");
+            return 1;
+        }
+        f->stack = region + page_size;
+        memset(f->stack, PAINT, stack_size);
+        if (mode == MODE_ARENA) {
+            f->arena = malloc(scalarmult_arena_size());
+            if (f->arena == NULL) return 1;
+        }
+        for (unsigned int j = 0; j < 32; j++) f->key[j] = (uint8_t)(i >> (8 * (j % 4)));
+        f->key[31] = 1;
+
+        getcontext(&f->ctx);
+        f->ctx.uc_stack.ss_sp = f->stack;
+        f->ctx.uc_stack.ss_size = stack_size;
+        f->ctx.uc_link = &scheduler;
+        makecontext(&f->ctx, (void (*)(void))handshake, 1, i);
+    }
+
+    // Round-robin, until every fiber is done
+    const double start = seconds();
+    for (int alive = n; alive > 0;) {
+        alive = 0;
+        for (int i = 0; i < n; i++) {
+            if (fibers[i].done) continue;
+            swapcontext(&scheduler, &fibers[i].ctx);
+            alive += !fibers[i].done;
+        }
+    }
+    const double elapsed = seconds() - start;
+
+    size_t max_depth = 0;
+    int err = 0;
+    for (int i = 0; i < n; i++) {
+        const size_t depth = stack_depth(&fibers[i]);
+        if (depth > max_depth) max_depth = depth;
+        err |= fibers[i].err;
+    }
+    // Both ends of a pair must agree on the shared secret
+    for (int i = 0; i < n; i++) {
+        if (memcmp(fibers[i].shared, fibers[peer(i)].shared, 64) != 0) err = 1;
+    }
+    if (err) {
+        fprintf(stderr, "%s: a handshake failed\n", mode_name);
+        return 1;
+    }
+
+    const size_t arena = mode == MODE_ARENA ? scalarmult_arena_size() : 0;
+    printf("%s (%s): %d fibers, %zu B stacks, max stack depth %zu B, "
+           "%zu B per in-flight handshake, %.0f handshakes/s\n",
+           mode_name, scalarmult_variant(), n, stack_size, max_depth,
+           stack_size + arena + sizeof(struct fiber), n / elapsed);
+    return 0;
+}
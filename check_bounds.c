@@ -0,0 +1,58 @@
+#include "fe12_bounds.h"
+#include "ge.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Run `ge_add_c` and `ge_double_c` on random inputs in a CURVE13318_CHECK_BOUNDS
+// build, and report the worst-case headroom of every claimed bound.
+
+static const int offsets[12] = {0, 22, 43, 64, 85, 107, 128, 149, 170, 192, 213, 234};
+
+static uint64_t rng_state = 0x853c49e6748fea9bULL;
+
+static uint64_t rng(void)
+{
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+/*
+Make an element that looks like the output of `fe12_squeeze`, i.e. every limb
+of width b is bounded by 2^(b-1). Half of the limbs are at the extremes,
+because those are the interesting ones.
+*/
+static void random_fe12(fe12 z)
+{
+    for (unsigned int i = 0; i < 12; i++) {
+        const int width = (i == 11 ? 255 : offsets[i + 1]) - offsets[i];
+        const int64_t max = (int64_t)1 << (width - 1);
+        int64_t x;
+        switch (rng() % 4) {
+            case 0:  x = max; break;
+            case 1:  x = -max; break;
+            default: x = (int64_t)(rng() % (uint64_t)(2*max + 1)) - max;
+        }
+        z[i] = ldexp((double)x, offsets[i]);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+    ge p, q, r;
+
+    for (unsigned long i = 0; i < iterations; i++) {
+        for (unsigned int j = 0; j < 3; j++) {
+            random_fe12(p[j]);
+            random_fe12(q[j]);
+        }
+        ge_add_c(r, p, q);
+        ge_double_c(r, p);
+    }
+    return fe12_bounds_report(stdout) != 0;
+}
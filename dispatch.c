@@ -0,0 +1,300 @@
+/*
+    Runtime dispatch between the scalar multiplication backends.
+
+    When the library is loaded, we probe the CPU (and the OS support for the
+    AVX registers) once, and point `scalarmult` to the best backend that this
+    CPU can run. The choice can be forced with the environment variable
+    CURVE13318_VARIANT (one of the names in `variants` below), which is meant
+    for A/B tests. A forced variant that this CPU cannot run is ignored. The
+    same probe decides whether `scalarmult_two`, `scalarmult_many`,
+    `scalarmult_split`, `scalarmult_arena` and `hash_to_curve_x4` can use
+    their AVX versions. A `scalarmult_ctx` takes
+    the chosen backend when it is created, in the form that runs in its MxCsr
+    session.
+
+    Because this code (and everything that is shared between the backends)
+    runs before we know what the CPU supports, it must not be compiled with
+    anything newer than SSE2 enabled (see the Makefile).
+*/
+
+#include "hash_to_curve.h"
+#include "mxcsr.h"
+#include "scalarmult.h"
+#include <cpuid.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef int (*scalarmult_fn)(uint8_t *, const uint8_t *, const uint8_t *);
+// The kernel of a backend in a `scalarmult_ctx`, see below
+typedef int (*scalarmult_ctx_fn)(uint8_t *, const uint8_t *, const uint8_t *,
+                                 struct fe12_scratch *);
+
+struct cpu_features {
+    bool avx;
+    bool bmi2_adx;
+};
+
+static bool supports_mulx(const struct cpu_features *f) { return f->bmi2_adx; }
+static bool supports_avx(const struct cpu_features *f) { return f->avx; }
+static bool supports_sse2(const struct cpu_features *f) { (void)f; return true; }
+
+// The backends that do not use the fe12 scratch state, in a context. The
+// integer one does not touch the MxCsr register, and `scalarmult_sse2` restores
+// the value that the context set, so they can run in a session as they are.
+static int ctx_mulx(uint8_t *out, const uint8_t *key, const uint8_t *in,
+                    struct fe12_scratch *s)
+{
+    (void)s;
+    return scalarmult_mulx(out, key, in);
+}
+
+static int ctx_sse2(uint8_t *out, const uint8_t *key, const uint8_t *in,
+                    struct fe12_scratch *s)
+{
+    (void)s;
+    return scalarmult_sse2(out, key, in);
+}
+
+// In order of preference, i.e. the first one that the CPU supports is chosen.
+// They are ordered by `make bench-backends`.
+static const struct {
+    const char *name;
+    scalarmult_fn fn;
+    scalarmult_ctx_fn ctx_fn;
+    bool (*supported)(const struct cpu_features *);
+} variants[] = {
+    {"avx", scalarmult_avx, scalarmult_avx_scratch, supports_avx},
+    {"avx_intrin", scalarmult_avx_intrin, scalarmult_avx_intrin_scratch, supports_avx},
+    {"mulx", scalarmult_mulx, ctx_mulx, supports_mulx},
+    {"sse2", scalarmult_sse2, ctx_sse2, supports_sse2}, // Every x86-64 CPU has SSE2
+};
+
+#define VARIANTS_LEN (sizeof(variants) / sizeof(variants[0]))
+
+static scalarmult_fn chosen_fn = NULL;
+static scalarmult_ctx_fn chosen_ctx_fn = NULL;
+static const char *chosen_name = "none";
+// Whether `scalarmult_two` may use the fused AVX version
+static bool two_fused = false;
+// Whether `hash_to_curve_x4` may use the AVX version
+static bool hash_x4 = false;
+// Whether `scalarmult_many`, `scalarmult_split` and `scalarmult_arena` may use
+// their AVX versions
+static bool many_x4 = false;
+
+static void detect_cpu_features(struct cpu_features *f)
+{
+    unsigned int eax, ebx, ecx, edx;
+    f->avx = f->bmi2_adx = false;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return;
+    const bool osxsave = (ecx >> 27) & 1;
+    const bool cpu_avx = (ecx >> 28) & 1;
+    if (osxsave && cpu_avx) {
+        // Check that the OS saves the xmm and ymm registers
+        unsigned int xcr0_lo, xcr0_hi;
+        __asm__ __volatile__ ("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+        f->avx = (xcr0_lo & 0x6) == 0x6;
+    }
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return;
+    f->bmi2_adx = ((ebx >> 8) & 1) && ((ebx >> 19) & 1);
+}
+
+__attribute__((constructor))
+static void choose_variant(void)
+{
+    struct cpu_features features;
+    detect_cpu_features(&features);
+
+    // The fused and batched versions use the intrinsics code, so if another
+    // backend is forced, `scalarmult_two`, `scalarmult_many` and
+    // `hash_to_curve_x4` call that backend for every output instead
+    const char *forced = getenv("CURVE13318_VARIANT");
+    two_fused = features.avx;
+    hash_x4 = features.avx;
+    many_x4 = features.avx;
+    for (unsigned int i = 0; forced != NULL && i < VARIANTS_LEN; i++) {
+        if (strcmp(forced, variants[i].name) == 0 && variants[i].supported(&features)) {
+            chosen_name = variants[i].name;
+            chosen_fn = variants[i].fn;
+            chosen_ctx_fn = variants[i].ctx_fn;
+            two_fused = features.avx && (strcmp(chosen_name, "avx") == 0 ||
+                                         strcmp(chosen_name, "avx_intrin") == 0);
+            hash_x4 = two_fused;
+            many_x4 = two_fused;
+            return;
+        }
+    }
+    for (unsigned int i = 0; i < VARIANTS_LEN; i++) {
+        if (variants[i].supported(&features)) {
+            chosen_name = variants[i].name;
+            chosen_fn = variants[i].fn;
+            chosen_ctx_fn = variants[i].ctx_fn;
+            return;
+        }
+    }
+}
+
+int scalarmult(uint8_t *out, const uint8_t *key, const uint8_t *in)
+{
+    // We may be called from another constructor, before our own has run
+    if (chosen_fn == NULL) choose_variant();
+    if (chosen_fn == NULL) return -1;
+    return chosen_fn(out, key, in);
+}
+
+const char *scalarmult_variant(void)
+{
+    if (chosen_fn == NULL) choose_variant();
+    return chosen_name;
+}
+
+int scalarmult_two(uint8_t *out1, uint8_t *out2, const uint8_t *key,
+                   const uint8_t *in1, const uint8_t *in2)
+{
+    if (chosen_fn == NULL) choose_variant();
+    if (chosen_fn == NULL) return -1;
+    if (two_fused) return scalarmult_two_avx_intrin(out1, out2, key, in1, in2);
+    const int ret1 = chosen_fn(out1, key, in1);
+    const int ret2 = chosen_fn(out2, key, in2);
+    return (ret1 != 0 || ret2 != 0) ? -1 : 0;
+}
+
+int scalarmult_many(uint8_t (*out)[64], const uint8_t (*keys)[32],
+                    const uint8_t *in, size_t len)
+{
+    if (chosen_fn == NULL) choose_variant();
+    if (chosen_fn == NULL) return -1;
+    if (many_x4) return scalarmult_many_avx_intrin(out, keys, in, len);
+    int err = 0;
+    for (size_t i = 0; i < len; i++) err |= chosen_fn(out[i], keys[i], in);
+    return err;
+}
+
+struct scalarmult_ctx {
+    scalarmult_ctx_fn fn;
+    struct fe12_scratch *scratch;
+    unsigned int saved_mxcsr;
+    bool entered;
+};
+
+struct scalarmult_ctx *scalarmult_ctx_new(void)
+{
+    if (chosen_fn == NULL) choose_variant();
+    if (chosen_fn == NULL) return NULL;
+
+    struct scalarmult_ctx *ctx = malloc(sizeof(*ctx));
+    if (ctx == NULL) return NULL;
+    ctx->fn = chosen_ctx_fn;
+    ctx->scratch = fe12_scratch_new();
+    ctx->entered = false;
+    if (ctx->scratch == NULL) {
+        free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+int scalarmult_ctx_enter(struct scalarmult_ctx *ctx)
+{
+    if (ctx->entered) return -1;
+    ctx->saved_mxcsr = replace_mxcsr();
+    ctx->entered = true;
+    return 0;
+}
+
+int scalarmult_ctx_run(struct scalarmult_ctx *ctx, uint8_t *out, const uint8_t *key,
+                       const uint8_t *in)
+{
+    if (!ctx->entered) return -1;
+    return ctx->fn(out, key, in, ctx->scratch);
+}
+
+int scalarmult_ctx_leave(struct scalarmult_ctx *ctx)
+{
+    if (!ctx->entered) return -1;
+    ctx->entered = false;
+    return restore_mxcsr(ctx->saved_mxcsr) ? 0 : -1;
+}
+
+void scalarmult_ctx_free(struct scalarmult_ctx *ctx)
+{
+    if (ctx == NULL) return;
+    fe12_scratch_free(ctx->scratch);
+    free(ctx);
+}
+
+size_t scalarmult_arena_size(void)
+{
+    return scalarmult_avx_intrin_arena_size();
+}
+
+int scalarmult_arena(uint8_t *out, const uint8_t *key, const uint8_t *in, void *arena)
+{
+    if (chosen_fn == NULL) choose_variant();
+    if (chosen_fn == NULL) return -1;
+    if (many_x4) return scalarmult_avx_intrin_arena(out, key, in, arena);
+    return chosen_fn(out, key, in);
+}
+
+// The arenas of `scalarmult_lowstack`, one per thread, which are freed by the
+// destructor of the key when their thread exits
+static pthread_key_t arena_key;
+static pthread_once_t arena_key_once = PTHREAD_ONCE_INIT;
+static bool arena_key_ok = false;
+
+static void create_arena_key(void)
+{
+    arena_key_ok = pthread_key_create(&arena_key, free) == 0;
+}
+
+int scalarmult_lowstack(uint8_t *out, const uint8_t *key, const uint8_t *in)
+{
+    if (chosen_fn == NULL) choose_variant();
+    if (chosen_fn == NULL) return -1;
+    if (!many_x4) return chosen_fn(out, key, in);
+
+    pthread_once(&arena_key_once, create_arena_key);
+    if (!arena_key_ok) return -1;
+    void *arena = pthread_getspecific(arena_key);
+    if (arena == NULL) {
+        arena = malloc(scalarmult_avx_intrin_arena_size());
+        if (arena == NULL || pthread_setspecific(arena_key, arena) != 0) {
+            free(arena);
+            return -1;
+        }
+    }
+    return scalarmult_avx_intrin_arena(out, key, in, arena);
+}
+
+int scalarmult_x4_enabled(void)
+{
+    if (chosen_fn == NULL) choose_variant();
+    return many_x4;
+}
+
+int hash_to_curve_x4(uint8_t out[4][64], const uint8_t *const msgs[4],
+                     const size_t msg_lens[4], const uint8_t *dst, size_t dst_len)
+{
+    if (chosen_fn == NULL) choose_variant();
+    if (!hash_x4) {
+        int err = 0;
+        for (unsigned int i = 0; i < 4; i++) {
+            err |= hash_to_curve(out[i], msgs[i], msg_lens[i], dst, dst_len);
+        }
+        return err;
+    }
+
+    ge points[4];
+    const unsigned int saved_mxcsr = replace_mxcsr();
+    int err = ge_hash_to_curve_x4(points, msgs, msg_lens, dst, dst_len);
+    if (err == 0) {
+        ge_tobytes2(out[0], out[1], points[0], points[1]);
+        ge_tobytes2(out[2], out[3], points[2], points[3]);
+    }
+    if (!restore_mxcsr(saved_mxcsr)) err = -1;
+    return err;
+}
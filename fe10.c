@@ -1,5 +1,36 @@
 #include "fe10.h"
 
+static inline uint64_t load_8(const uint8_t *in)
+{
+    uint64_t ret = 0;
+    for (unsigned int i = 0; i < 8; i++) ret |= (uint64_t)in[i] << (8*i);
+    return ret;
+}
+
+/*
+Parse a bytestring into a field element (fe10). The 256'th bit is reduced
+using 2^255 = 19 (mod p), so the result is carried, but not frozen.
+*/
+void fe10_frombytes(fe10 z, const uint8_t *s)
+{
+    const uint64_t w0 = load_8(&s[ 0]);
+    const uint64_t w1 = load_8(&s[ 8]);
+    const uint64_t w2 = load_8(&s[16]);
+    const uint64_t w3 = load_8(&s[24]);
+
+    z[0] = w0 & ~_MASK26;
+    z[1] = (w0 >> 26) & ~_MASK25;
+    z[2] = ((w0 >> 51) | (w1 << 13)) & ~_MASK26;
+    z[3] = (w1 >> 13) & ~_MASK25;
+    z[4] = w1 >> 38;
+    z[5] = w2 & ~_MASK25;
+    z[6] = (w2 >> 25) & ~_MASK26;
+    z[7] = ((w2 >> 51) | (w3 << 13)) & ~_MASK25;
+    z[8] = (w3 >> 12) & ~_MASK26;
+    z[9] = (w3 >> 38) & ~_MASK25;
+    z[0] += 19 * (w3 >> 63);
+}
+
 /*
 Store a into a field element (fe10) into a bytestring
 */
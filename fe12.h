@@ -52,6 +52,7 @@ typedef double fe12_frozen[6];
 #define fe12_mul_schoolbook crypto_scalarmult_curve13318_ref12_fe12_mul_schoolbook
 #define fe12_square crypto_scalarmult_curve13318_ref12_fe12_square_karatsuba
 #define fe12_freeze crypto_scalarmult_curve13318_ref12_fe12_freeze
+#define fe12_tobytes crypto_scalarmult_curve13318_ref12_fe12_tobytes
 #define fe12_add_b crypto_scalarmult_curve13318_ref12_fe12_add_b
 #define fe12_mul_b crypto_scalarmult_curve13318_ref12_fe12_mul_b
 
@@ -121,9 +122,49 @@ extern void fe12_square(fe12 dest, const fe12 element);
 /*
 Reduce an element s.t. the result is always in [0, 2^255-19⟩. Input must
 be squeezed
+
+The result has pairs of limbs merged: out[i] is a multiple of 2^0, 2^43, 2^85,
+2^128, 2^170 and 2^213 (for i = 0..5), and these are the canonical 43- or
+42-bit digits of the value, so every out[i] is nonnegative and smaller than
+the next multiple. This only uses floating point operations, so the MxCsr
+must have been replaced (see mxcsr.h).
 */
 extern void fe12_freeze(fe12_frozen out, const fe12 element);
 
+/*
+Write the 32-byte encoding of the digits of a frozen element, i.e. of
+d[0] + 2^43 * d[1] + 2^85 * d[2] + ... + 2^213 * d[5]
+*/
+static inline void fe12_digits_tobytes(uint8_t *bytes, const uint64_t d[6]) {
+    uint64_t w[4];
+    w[0] = d[0] | (d[1] << 43);
+    w[1] = (d[1] >> 21) | (d[2] << 21);
+    w[2] = d[3] | (d[4] << 42);
+    w[3] = (d[4] >> 22) | (d[5] << 21);
+    for (unsigned int i = 0; i < 32; i++) bytes[i] = (uint8_t)(w[i / 8] >> (8 * (i % 8)));
+}
+
+/*
+Write the 32-byte encoding of a frozen element
+*/
+static inline void fe12_frozen_tobytes(uint8_t *bytes, const fe12_frozen z) {
+    const uint64_t d[6] = {
+        (uint64_t)(int64_t)z[0],
+        (uint64_t)(int64_t)(z[1] * 0x1p-43),
+        (uint64_t)(int64_t)(z[2] * 0x1p-85),
+        (uint64_t)(int64_t)(z[3] * 0x1p-128),
+        (uint64_t)(int64_t)(z[4] * 0x1p-170),
+        (uint64_t)(int64_t)(z[5] * 0x1p-213)
+    };
+    fe12_digits_tobytes(bytes, d);
+}
+
+/*
+Write the canonical 32-byte encoding of an element, with `fe12_freeze`. Input
+must be squeezed
+*/
+extern void fe12_tobytes(uint8_t *bytes, const fe12 element);
+
 /*
 Add 13318 to `z`
 */
@@ -0,0 +1,147 @@
+#include "fe12_bounds.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef CURVE13318_CHECK_BOUNDS
+
+// The largest operand that may be multiplied with a squeezed operand
+// (≤ 1.01 * 2^21), following the rule in `ge_add_c`: 0.98 * 2^53 / 210.
+#define SQUEEZED_PARTNER_LIMIT (0.98 * 0x1p53 / 210 / (1.01 * 0x1p21))
+
+#define MAX_SITES 256
+
+static const int offsets[12] = {0, 22, 43, 64, 85, 107, 128, 149, 170, 192, 213, 234};
+
+typedef struct {
+    const char *func;
+    int line;
+    const char *name;
+    double limit;       // c * 2^e, or 0 for a squeeze
+    double c;
+    int e;
+    double worst;       // largest |z[i]| / 2^k that was seen
+    unsigned long count;
+} site;
+
+static site sites[MAX_SITES];
+static unsigned int num_sites = 0;
+
+static site *lookup(const char *func, int line, const char *name)
+{
+    for (unsigned int i = 0; i < num_sites; i++) {
+        if (sites[i].line == line && strcmp(sites[i].func, func) == 0) {
+            return &sites[i];
+        }
+    }
+    if (num_sites == MAX_SITES) {
+        fprintf(stderr, "fe12_bounds: too many call sites\n");
+        abort();
+    }
+    site *s = &sites[num_sites++];
+    s->func = func;
+    s->line = line;
+    s->name = name;
+    return s;
+}
+
+static double magnitude(const fe12 z)
+{
+    double ret = 0;
+    for (unsigned int i = 0; i < 12; i++) {
+        double x = fabs(ldexp(z[i], -offsets[i]));
+        if (x > ret) ret = x;
+    }
+    return ret;
+}
+
+void fe12_bounds_check(const char *func, int line, const char *name,
+                       const fe12 z, double c, int e)
+{
+    site *s = lookup(func, line, name);
+    s->c = c;
+    s->e = e;
+    s->limit = ldexp(c, e);
+    double x = magnitude(z);
+    if (x > s->worst) s->worst = x;
+    s->count++;
+}
+
+void fe12_bounds_squeeze(const char *func, int line, const char *name, fe12 z)
+{
+    site *s = lookup(func, line, name);
+    double x = magnitude(z);
+    if (x > s->worst) s->worst = x;
+    s->count++;
+    fe12_squeeze(z);
+}
+
+static int compare_sites(const void *a, const void *b)
+{
+    const site *lhs = a, *rhs = b;
+    int ret = strcmp(lhs->func, rhs->func);
+    return ret != 0 ? ret : lhs->line - rhs->line;
+}
+
+static const char *short_name(const char *func)
+{
+    const char *prefix = "crypto_scalarmult_curve13318_ref12_";
+    size_t len = strlen(prefix);
+    return strncmp(func, prefix, len) == 0 ? func + len : func;
+}
+
+static void print_value(FILE *stream, double x)
+{
+    int e;
+    double c = frexp(x, &e);
+    if (x == 0) {
+        fprintf(stream, "%-13s", "0");
+    } else {
+        fprintf(stream, "%.2f * 2^%-4d", 2 * c, e - 1);
+    }
+}
+
+int fe12_bounds_report(FILE *stream)
+{
+    int violations = 0;
+    qsort(sites, num_sites, sizeof(site), compare_sites);
+
+    fprintf(stream, "Claimed bounds (headroom = log2(claimed / worst seen))\n\n");
+    fprintf(stream, "%-24s %5s  %-5s %-13s %-13s %9s\n",
+            "function", "line", "value", "claimed", "worst seen", "headroom");
+    for (unsigned int i = 0; i < num_sites; i++) {
+        const site *s = &sites[i];
+        if (s->limit == 0) continue;
+        fprintf(stream, "%-24s %5d  %-5s ", short_name(s->func), s->line, s->name);
+        print_value(stream, s->limit);
+        fprintf(stream, " ");
+        print_value(stream, s->worst);
+        if (s->worst == 0) {
+            fprintf(stream, " %9s", "-");
+        } else {
+            fprintf(stream, " %+9.2f", log2(s->limit / s->worst));
+        }
+        if (s->worst > s->limit) {
+            fprintf(stream, "  EXCEEDED");
+            violations++;
+        }
+        fprintf(stream, "\n");
+    }
+
+    fprintf(stream, "\nSqueezes (slack = log2(%.2f * 2^24 / worst input), i.e. the bits "
+            "left if this\nvalue were multiplied with a squeezed operand "
+            "without being squeezed)\n\n", SQUEEZED_PARTNER_LIMIT / 0x1p24);
+    fprintf(stream, "%-24s %5s  %-5s %-13s %9s\n",
+            "function", "line", "value", "worst input", "slack");
+    for (unsigned int i = 0; i < num_sites; i++) {
+        const site *s = &sites[i];
+        if (s->limit != 0) continue;
+        fprintf(stream, "%-24s %5d  %-5s ", short_name(s->func), s->line, s->name);
+        print_value(stream, s->worst);
+        fprintf(stream, " %+9.2f%s\n", log2(SQUEEZED_PARTNER_LIMIT / s->worst),
+                s->worst <= SQUEEZED_PARTNER_LIMIT ? "  has slack" : "");
+    }
+    return violations;
+}
+
+#endif /* CURVE13318_CHECK_BOUNDS */
@@ -0,0 +1,50 @@
+/*
+Limb-bound checking for the fe12 arithmetic
+
+In the C code, `fe12_bound(z, c, e)` states that every limb of `z` is bounded
+by c * 2^e * 2^k, with k the limb's offset (0, 22, 43, etc.). Normally this is
+only documentation. When compiled with `-DCURVE13318_CHECK_BOUNDS`, every
+`fe12_bound` is checked and the worst-case headroom per call site is recorded.
+The inputs of the squeezes in `ge.c` are recorded as well, so the report can
+show which squeezes have slack. Run `make check-bounds` to get that report.
+*/
+
+#ifndef REF12_FE12_BOUNDS_H_
+#define REF12_FE12_BOUNDS_H_
+
+#include "fe12.h"
+#include <stdio.h>
+
+#ifdef CURVE13318_CHECK_BOUNDS
+
+#define fe12_bounds_check crypto_scalarmult_curve13318_ref12_fe12_bounds_check
+#define fe12_bounds_squeeze crypto_scalarmult_curve13318_ref12_fe12_bounds_squeeze
+#define fe12_bounds_report crypto_scalarmult_curve13318_ref12_fe12_bounds_report
+
+#define fe12_bound(z, c, e) fe12_bounds_check(__func__, __LINE__, #z, z, c, e)
+
+/*
+Check that |z| ≤ c * 2^e and record the headroom for this call site
+*/
+void fe12_bounds_check(const char *func, int line, const char *name,
+                       const fe12 z, double c, int e);
+
+/*
+Record the input of a squeeze at this call site and squeeze `z`
+*/
+void fe12_bounds_squeeze(const char *func, int line, const char *name, fe12 z);
+
+/*
+Print the worst-case headroom of every call site to `stream`
+
+Returns the number of call sites where a bound was exceeded.
+*/
+int fe12_bounds_report(FILE *stream);
+
+#else
+
+#define fe12_bound(z, c, e)
+
+#endif /* CURVE13318_CHECK_BOUNDS */
+
+#endif /* REF12_FE12_BOUNDS_H_ */
@@ -1,4 +1,5 @@
 #include "fe12.h"
+#include "fe12_bounds.h"
 #include <stdint.h>
 #include <xmmintrin.h>
 
@@ -75,6 +76,7 @@ void fe12_squeeze(fe12 z)
     //   - All significands fit in b + 1 bits (b = 22, 21, 21, etc.)
 
     double t0, t1;
+    fe12_bound(z, 0.99, 53);
     t0 = z[0] + 0x3p73 - 0x3p73; // Round 1a
     z[0] -= t0;
     z[1] += t0;
@@ -123,6 +125,79 @@ void fe12_squeeze(fe12 z)
     t1 = z[1] + 0x3p94 - 0x3p94; // Round 8b
     z[1] -= t1;
     z[2] += t1;
+    fe12_bound(z, 1.01, 21);
+}
+
+/*
+The carries of `fe12_freeze` round down, so that every digit ends up
+nonnegative: for a multiple x of 2^b[i], floor(x / 2^k[i]) * 2^k[i] is x minus
+just under half a step (2^(k[i] - 1) - 2^(b[i] - 1)), rounded to a multiple of
+2^k[i] with the precisionloss trick. That never ties, because the fraction is
+never exactly a half. k[i] is the offset of frozen limb i + 1.
+*/
+static const double freeze_offset[6] = {
+    0x1p42 - 0x1p-1, 0x1p84 - 0x1p42, 0x1p127 - 0x1p84,
+    0x1p169 - 0x1p127, 0x1p212 - 0x1p169, 0x1p254 - 0x1p212
+};
+static const double freeze_precisionloss[6] = {
+    0x3p94, 0x3p136, 0x3p179, 0x3p221, 0x3p264, 0x3p306
+};
+
+// The carry out of frozen limb i, for x + carry_in in that limb. The offset is
+// subtracted from x first, so that it is not on the critical path of a chain.
+static inline double floor_carry(double x, double carry_in, unsigned int i)
+{
+    return x - freeze_offset[i] + carry_in + freeze_precisionloss[i] - freeze_precisionloss[i];
+}
+
+void fe12_freeze(fe12_frozen out, const fe12 z)
+{
+    // 8*p in frozen limbs, which makes every limb of a squeezed value positive
+    static const double eight_p[6] = {
+        8 * (0x1p43 - 19), 8 * (0x1p85 - 0x1p43), 8 * (0x1p128 - 0x1p85),
+        8 * (0x1p170 - 0x1p128), 8 * (0x1p213 - 0x1p170), 8 * (0x1p255 - 0x1p213)
+    };
+    double u[6], c[6], d[6], a[6], b[6];
+
+    // Merge the limbs in pairs. The sums are exact, because the limbs are
+    // squeezed, and so is adding 8*p (every u[i] is smaller than 2^(k[i] + 4)).
+    for (unsigned int i = 0; i < 6; i++) u[i] = z[2*i] + z[2*i + 1] + eight_p[i];
+
+    // Carry every limb once, all at once. Every carry is smaller than 2^4
+    // (times the offset of the next limb), so now the value is smaller than
+    // 2^255 + 2^217, and every limb is nonnegative.
+    for (unsigned int i = 0; i < 6; i++) c[i] = floor_carry(u[i], 0, i);
+    u[0] = u[0] - c[0] + 0x13p-255 * c[5];
+    for (unsigned int i = 1; i < 6; i++) u[i] = u[i] - c[i] + c[i - 1];
+
+    // Carry the value and the value + 19 in two independent chains. The
+    // carry out of the second one is q = (value + 19) >> 255, which is 1 if
+    // the value is at least p, and 0 otherwise. If it is 1, the digits of
+    // the second chain without that carry are value - p, otherwise the
+    // digits of the first chain are already canonical.
+    c[0] = floor_carry(u[0], 0, 0);
+    d[0] = floor_carry(u[0], 19, 0);
+    for (unsigned int i = 1; i < 6; i++) {
+        c[i] = floor_carry(u[i], c[i - 1], i);
+        d[i] = floor_carry(u[i], d[i - 1], i);
+    }
+    a[0] = u[0] - c[0];
+    b[0] = u[0] + 19 - d[0];
+    for (unsigned int i = 1; i < 6; i++) {
+        a[i] = u[i] + c[i - 1] - c[i];
+        b[i] = u[i] + d[i - 1] - d[i];
+    }
+
+    // Select without a branch; all of these operations are exact
+    const double q = 0x1p-255 * d[5];
+    for (unsigned int i = 0; i < 6; i++) out[i] = a[i] + q * (b[i] - a[i]);
+}
+
+void fe12_tobytes(uint8_t *bytes, const fe12 z)
+{
+    fe12_frozen frozen;
+    fe12_freeze(frozen, z);
+    fe12_frozen_tobytes(bytes, frozen);
 }
 
 static inline double unset_bit59(const double x)
@@ -298,6 +373,7 @@ void fe12_mul(fe12 C, const fe12 A, const fe12 B)
     C[ 9] =  l9 + 0x1p+128 * ( m3 + l3 + h3) + 0x26*h9;
     C[10] = l10 + 0x1p+128 * ( m4 + l4 + h4) + 0x26*h10;
     C[11] =       0x1p+128 * ( m5 + l5 + h5);
+    fe12_bound(C, 0.98, 53);
 }
 
 void fe12_mul_schoolbook(fe12 dest, const fe12 A, const fe12 B)
@@ -657,4 +733,5 @@ void fe12_square(fe12 C, const fe12 A)
     C[ 9] =  l9 +  0x1p+128 * ( -m3 +  l3 +  h3) + 0x26*h9;
     C[10] = l10 +  0x1p+128 * ( -m4 +  l4 +  h4) + 0x26*h10;
     C[11] =        0x1p+128 * ( -m5 +  l5 +  h5);
+    fe12_bound(C, 0.98, 53);
 }
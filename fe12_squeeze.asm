@@ -5,6 +5,7 @@
 %include "fe12_squeeze.mac"
 
 global crypto_scalarmult_curve13318_ref12_fe12x4_squeeze, crypto_scalarmult_curve13318_ref12_fe12x4_squeeze_noload
+global crypto_scalarmult_curve13318_ref12_fe12x4_carry
 
 
 section .text
@@ -17,3 +18,12 @@ crypto_scalarmult_curve13318_ref12_fe12x4_squeeze_noload:
 
 section .rodata:
 fe12x4_squeeze_consts
+
+section .text
+crypto_scalarmult_curve13318_ref12_fe12x4_carry:
+    ; Carry every limb once (see `fe12x4_carry_body`)
+    fe12x4_carry rdi, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+    ret
+
+section .rodata
+fe12x4_squeeze_consts
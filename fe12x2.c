@@ -0,0 +1,119 @@
+/*
+    SSE2 kernels for two fe12 values at once (see fe12x2.h).
+*/
+
+#include "fe12x2.h"
+#include <emmintrin.h>
+
+typedef __m128d vec;
+
+static inline vec vset1(double x) { return _mm_set1_pd(x); }
+
+// Load limb i of z0 and z1 into the two lanes of a vector
+static inline vec vload(const fe12 z0, const fe12 z1, unsigned int i)
+{
+    return _mm_loadh_pd(_mm_load_sd(&z0[i]), &z1[i]);
+}
+
+// Store the two lanes of x to limb i of z0 and z1
+static inline void vstore(fe12 z0, fe12 z1, unsigned int i, vec x)
+{
+    _mm_storel_pd(&z0[i], x);
+    _mm_storeh_pd(&z1[i], x);
+}
+
+// Move the part of z[i] that does not fit in its limb to z[j]. `c` is
+// 3 * 2^(k + 51) for the offset k of the next limb (see `fe12_squeeze`).
+static inline void carry(vec z[12], unsigned int i, unsigned int j, double c)
+{
+    const vec cv = vset1(c);
+    const vec t = _mm_sub_pd(_mm_add_pd(z[i], cv), cv);
+    z[i] = _mm_sub_pd(z[i], t);
+    z[j] = _mm_add_pd(z[j], t);
+}
+
+// Schoolbook multiplication of two 6-limb halves: r = a * b
+static inline void mul6(vec r[11], const vec a[6], const vec b[6])
+{
+    for (unsigned int k = 0; k < 11; k++) r[k] = _mm_setzero_pd();
+    #pragma GCC unroll 6
+    for (unsigned int i = 0; i < 6; i++) {
+        #pragma GCC unroll 6
+        for (unsigned int j = 0; j < 6; j++) {
+            r[i + j] = _mm_add_pd(r[i + j], _mm_mul_pd(a[i], b[j]));
+        }
+    }
+}
+
+void fe12x2_mul(fe12 h0, const fe12 f0, const fe12 g0,
+                fe12 h1, const fe12 f1, const fe12 g1)
+{
+    // The same Karatsuba multiplication as in `fe12_mul`. All products are
+    // exact, so the result is exactly the same as that of `fe12_mul`.
+    const vec shr = vset1(0x1p-128);
+    const vec shl = vset1(0x1p+128);
+    const vec c38 = vset1(0x26);
+    vec a_lo[6], a_hi[6], b_lo[6], b_hi[6], a_m[6], b_m[6];
+    vec l[11], hh[11], m[11];
+    for (unsigned int i = 0; i < 6; i++) {
+        a_lo[i] = vload(f0, f1, i);
+        b_lo[i] = vload(g0, g1, i);
+        a_hi[i] = _mm_mul_pd(shr, vload(f0, f1, i + 6));
+        b_hi[i] = _mm_mul_pd(shr, vload(g0, g1, i + 6));
+        a_m[i] = _mm_sub_pd(a_lo[i], a_hi[i]);
+        b_m[i] = _mm_sub_pd(b_hi[i], b_lo[i]);
+    }
+    mul6(l, a_lo, b_lo);
+    mul6(hh, a_hi, b_hi);
+    mul6(m, a_m, b_m);
+
+    // Sum up the accs into h0 and h1. The inputs have all been loaded, so
+    // h0 and h1 may alias them.
+    for (unsigned int k = 0; k < 6; k++) {
+        // h[k] = l[k] + 38 * (2^-128 * (m[k+6] + l[k+6] + h[k+6]) + h[k])
+        vec t = hh[k];
+        if (k < 5) {
+            const vec mid = _mm_add_pd(_mm_add_pd(m[k + 6], l[k + 6]), hh[k + 6]);
+            t = _mm_add_pd(_mm_mul_pd(shr, mid), t);
+        }
+        vstore(h0, h1, k, _mm_add_pd(l[k], _mm_mul_pd(c38, t)));
+    }
+    for (unsigned int k = 6; k < 12; k++) {
+        // h[k] = l[k] + 2^128 * (m[k-6] + l[k-6] + h[k-6]) + 38 * h[k]
+        const vec mid = _mm_add_pd(_mm_add_pd(m[k - 6], l[k - 6]), hh[k - 6]);
+        vec t = _mm_mul_pd(shl, mid);
+        if (k < 11) t = _mm_add_pd(_mm_add_pd(l[k], t), _mm_mul_pd(c38, hh[k]));
+        vstore(h0, h1, k, t);
+    }
+}
+
+void fe12x2_squeeze(fe12 z0, fe12 z1)
+{
+    // The same two interleaved carry chains as in `fe12_squeeze`
+    vec zv[12];
+    for (unsigned int i = 0; i < 12; i++) zv[i] = vload(z0, z1, i);
+
+    carry(zv, 0, 1, 0x3p73);     // Round 1a
+    carry(zv, 6, 7, 0x3p200);    // Round 1b
+    carry(zv, 1, 2, 0x3p94);     // Round 2a
+    carry(zv, 7, 8, 0x3p221);    // Round 2b
+    carry(zv, 2, 3, 0x3p115);    // Round 3a
+    carry(zv, 8, 9, 0x3p243);    // Round 3b
+    carry(zv, 3, 4, 0x3p136);    // Round 4a
+    carry(zv, 9, 10, 0x3p264);   // Round 4b
+    carry(zv, 4, 5, 0x3p158);    // Round 5a
+    carry(zv, 10, 11, 0x3p285);  // Round 5b
+    carry(zv, 5, 6, 0x3p179);    // Round 6a
+    {                            // Round 6b
+        const vec cv = vset1(0x3p306);
+        const vec t = _mm_sub_pd(_mm_add_pd(zv[11], cv), cv);
+        zv[11] = _mm_sub_pd(zv[11], t);
+        zv[0] = _mm_add_pd(zv[0], _mm_mul_pd(vset1(0x13p-255), t));
+    }
+    carry(zv, 6, 7, 0x3p200);    // Round 7a
+    carry(zv, 0, 1, 0x3p73);     // Round 7b
+    carry(zv, 7, 8, 0x3p221);    // Round 8a
+    carry(zv, 1, 2, 0x3p94);     // Round 8b
+
+    for (unsigned int i = 0; i < 12; i++) vstore(z0, z1, i, zv[i]);
+}
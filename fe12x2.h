@@ -0,0 +1,36 @@
+/*
+SSE2 kernels for two fe12 values at once
+
+Every kernel loads limb i of both values into a single xmm word, so that two
+independent field operations cost about as much as one. This is the two-lane
+version of the fe12x4 layout that the AVX code uses, for CPUs (or virtual
+machines) that do not expose AVX. The values themselves are plain fe12 values,
+so the group operations do not need to convert them.
+
+SSE2 is part of x86-64, so these kernels run on every CPU that runs this
+library.
+*/
+
+#ifndef CURVE13318_REF12_FE12X2_H_
+#define CURVE13318_REF12_FE12X2_H_
+
+#include "fe12.h"
+
+#define fe12x2_mul crypto_scalarmult_curve13318_ref12_fe12x2_mul
+#define fe12x2_squeeze crypto_scalarmult_curve13318_ref12_fe12x2_squeeze
+
+/*
+Compute h0 = f0 * g0 and h1 = f1 * g1, like `fe12_mul`
+
+The products are not squeezed. The same bounds as for `fe12_mul` apply. The
+outputs may alias the inputs.
+*/
+void fe12x2_mul(fe12 h0, const fe12 f0, const fe12 g0,
+                fe12 h1, const fe12 f1, const fe12 g1);
+
+/*
+Carry ripple two field elements, like `fe12_squeeze`
+*/
+void fe12x2_squeeze(fe12 z0, fe12 z1);
+
+#endif /* CURVE13318_REF12_FE12X2_H_ */
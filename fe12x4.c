@@ -0,0 +1,59 @@
+/*
+    The fe12x4 functions that are not in NASM (see fe12x4.h).
+*/
+
+#include "fe12x4.h"
+#include "fe12x4_intrin.h"
+#include "fe51.h"
+#include "fe_convert.h"
+
+static inline void load(__m256d dest[12], const fe12x4 src)
+{
+    for (unsigned int i = 0; i < 12; i++) dest[i] = _mm256_load_pd(src[i]);
+}
+
+static inline void store(fe12x4 dest, const __m256d src[12])
+{
+    for (unsigned int i = 0; i < 12; i++) _mm256_store_pd(dest[i], src[i]);
+}
+
+void fe12x4_square(fe12x4 dest, const fe12x4 element)
+{
+    __m256d z[12];
+    load(z, element);
+    fe12x4_square_intrin(z, z);
+    store(dest, z);
+}
+
+void fe12x4_select(fe12x4 dest, const fe12x4 op1, const fe12x4 op2, const uint8_t c[4])
+{
+    const __m256d mask = _mm256_castsi256_pd(_mm256_setr_epi64x(
+        -(int64_t)c[0], -(int64_t)c[1], -(int64_t)c[2], -(int64_t)c[3]));
+    for (unsigned int i = 0; i < 12; i++) {
+        const __m256d f = _mm256_load_pd(op1[i]);
+        const __m256d g = _mm256_load_pd(op2[i]);
+        _mm256_store_pd(dest[i], _mm256_or_pd(_mm256_andnot_pd(mask, f),
+                                              _mm256_and_pd(mask, g)));
+    }
+}
+
+void fe12x4_frombytes(fe12x4 dest, const uint8_t bytes[4][32])
+{
+    fe12 z;
+    for (unsigned int lane = 0; lane < 4; lane++) {
+        fe12_frombytes(z, bytes[lane]);
+        fe12x4_insert(dest, lane, z);
+    }
+}
+
+void fe12x4_tobytes(uint8_t bytes[4][32], const fe12x4 element)
+{
+    // fe51_pack does the final reduction
+    fe12 z;
+    fe51 z51;
+    for (unsigned int lane = 0; lane < 4; lane++) {
+        fe12x4_extract(z, element, lane);
+        convert_fe12_to_fe51(&z51, z);
+        fe51_pack(bytes[lane], &z51);
+    }
+}
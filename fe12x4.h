@@ -0,0 +1,201 @@
+/*
+Four fe12 values, for batched field arithmetic
+
+Every limb is stored in a single ymm word, i.e. `z[i][lane]` is limb `i` of
+the fe12 value in `lane`. This is the layout that the AVX code uses for its
+four independent multiplications, and that `ge_interleaved` uses for the
+coordinates of one point. Every lane is a normal fe12 value, so the same
+bounds apply per lane. Values of this type must be aligned to 32 bytes.
+
+The functions below that are not `static inline` need AVX. Only call them on
+CPUs that support AVX. None of them branch on, or index memory with, the lane
+values.
+*/
+
+#ifndef CURVE13318_REF12_FE12X4_H_
+#define CURVE13318_REF12_FE12X4_H_
+
+#include "fe12.h"
+
+typedef double fe12x4[12][4];
+
+#define fe12x4_mul crypto_scalarmult_curve13318_ref12_fe12x4_mul
+#define fe12x4_mul_nosqueeze crypto_scalarmult_curve13318_ref12_fe12x4_mul_nosqueeze
+#define fe12x4_square crypto_scalarmult_curve13318_ref12_fe12x4_square
+#define fe12x4_squeeze crypto_scalarmult_curve13318_ref12_fe12x4_squeeze
+#define fe12x4_carry crypto_scalarmult_curve13318_ref12_fe12x4_carry
+#define fe12x4_select crypto_scalarmult_curve13318_ref12_fe12x4_select
+#define fe12x4_frombytes crypto_scalarmult_curve13318_ref12_fe12x4_frombytes
+#define fe12x4_tobytes crypto_scalarmult_curve13318_ref12_fe12x4_tobytes
+#define fe12x4_invert crypto_scalarmult_curve13318_ref12_fe12x4_invert
+#define fe12x4_pow2523 crypto_scalarmult_curve13318_ref12_fe12x4_pow2523
+#define fe12x4_sqrt crypto_scalarmult_curve13318_ref12_fe12x4_sqrt
+#define fe12x4_legendre crypto_scalarmult_curve13318_ref12_fe12x4_legendre
+
+/*
+Set all four lanes to zero
+*/
+static inline void fe12x4_zero(fe12x4 z) {
+    for (unsigned int i = 0; i < 12; i++) {
+        for (unsigned int j = 0; j < 4; j++) z[i][j] = 0;
+    }
+}
+
+/*
+Write the fe12 value `src` to lane `lane` of `dest`
+*/
+static inline void fe12x4_insert(fe12x4 dest, unsigned int lane, const fe12 src) {
+    for (unsigned int i = 0; i < 12; i++) dest[i][lane] = src[i];
+}
+
+/*
+Read lane `lane` of `src` into the fe12 value `dest`
+*/
+static inline void fe12x4_extract(fe12 dest, const fe12x4 src, unsigned int lane) {
+    for (unsigned int i = 0; i < 12; i++) dest[i] = src[i][lane];
+}
+
+/*
+Load four fe12 values into the lanes of `dest`
+*/
+static inline void fe12x4_load(fe12x4 dest, const fe12 z0, const fe12 z1,
+                               const fe12 z2, const fe12 z3) {
+    for (unsigned int i = 0; i < 12; i++) {
+        dest[i][0] = z0[i];
+        dest[i][1] = z1[i];
+        dest[i][2] = z2[i];
+        dest[i][3] = z3[i];
+    }
+}
+
+/*
+Store the lanes of `src` into four fe12 values
+*/
+static inline void fe12x4_store(fe12 z0, fe12 z1, fe12 z2, fe12 z3, const fe12x4 src) {
+    for (unsigned int i = 0; i < 12; i++) {
+        z0[i] = src[i][0];
+        z1[i] = src[i][1];
+        z2[i] = src[i][2];
+        z3[i] = src[i][3];
+    }
+}
+
+/*
+Add `rhs` to `lhs` and store the result in `z`
+*/
+static inline void fe12x4_add(fe12x4 z, const fe12x4 lhs, const fe12x4 rhs) {
+    for (unsigned int i = 0; i < 12; i++) {
+        for (unsigned int j = 0; j < 4; j++) z[i][j] = lhs[i][j] + rhs[i][j];
+    }
+}
+
+/*
+Subtract `rhs` from `lhs` and store the result in `z`
+*/
+static inline void fe12x4_sub(fe12x4 z, const fe12x4 lhs, const fe12x4 rhs) {
+    for (unsigned int i = 0; i < 12; i++) {
+        for (unsigned int j = 0; j < 4; j++) z[i][j] = lhs[i][j] - rhs[i][j];
+    }
+}
+
+/*
+Multiply every lane of z by a small constant
+*/
+static inline void fe12x4_mul_small(fe12x4 z, const double n) {
+    for (unsigned int i = 0; i < 12; i++) {
+        for (unsigned int j = 0; j < 4; j++) z[i][j] = n * z[i][j];
+    }
+}
+
+/*
+Multiply four pairs of field elements and squeeze the products
+
+`dest` may alias `op1` and `op2`.
+
+Precondition:
+  - Both operands are squeezed (see `fe12x4_squeeze`), or at least every limb
+    is bounded like in `fe12_mul`
+
+Postcondition:
+  - The result is squeezed
+*/
+void fe12x4_mul(fe12x4 dest, const fe12x4 op1, const fe12x4 op2);
+
+/*
+Same as `fe12x4_mul`, but the products are not squeezed
+*/
+void fe12x4_mul_nosqueeze(fe12x4 dest, const fe12x4 op1, const fe12x4 op2);
+
+/*
+Square four field elements and squeeze the results. `dest` may alias
+`element`.
+
+Precondition and postcondition: the same as for `fe12x4_mul`
+*/
+void fe12x4_square(fe12x4 dest, const fe12x4 element);
+
+/*
+Carry ripple four field elements
+
+Precondition:
+  - For all limbs x in z : |x| <= 0.99 * 2^53
+
+Postcondition:
+  - All significands fit in b + 1 bits (b = 22, 21, 21, etc.)
+*/
+void fe12x4_squeeze(fe12x4 element);
+
+/*
+Carry every limb of four field elements once. This is a lot cheaper than
+`fe12x4_squeeze`, but it only works for values that are not much bigger than
+a squeezed value (see `fe12x4_carry_body` in fe12_squeeze.mac).
+*/
+void fe12x4_carry(fe12x4 element);
+
+/*
+Constant time lane select: lane i of `dest` becomes lane i of `op2` if
+`c[i]` == 1, and lane i of `op1` if `c[i]` == 0. Every `c[i]` must be exactly
+0 or 1. `dest` may alias `op1` and `op2`.
+*/
+void fe12x4_select(fe12x4 dest, const fe12x4 op1, const fe12x4 op2, const uint8_t c[4]);
+
+/*
+Parse four 32-byte strings into the lanes of `dest`, like `fe12_frombytes`
+*/
+void fe12x4_frombytes(fe12x4 dest, const uint8_t bytes[4][32]);
+
+/*
+Write the canonical (i.e. fully reduced) 32-byte encoding of every lane. The
+input must be squeezed.
+*/
+void fe12x4_tobytes(uint8_t bytes[4][32], const fe12x4 element);
+
+/*
+Invert four field elements, i.e. compute z^(p - 2) for every lane. A lane
+that is zero stays zero. The input must be squeezed, the output is squeezed.
+*/
+void fe12x4_invert(fe12x4 dest, const fe12x4 element);
+
+/*
+Compute z^((p - 5) / 8) for every lane, which is the exponentiation of a
+square root of a fraction (see hash_to_curve.h). The input must be squeezed,
+the output is squeezed.
+*/
+void fe12x4_pow2523(fe12x4 dest, const fe12x4 element);
+
+/*
+Compute a square root of every lane, i.e. z^((p + 3) / 8), times sqrt(-1) if
+that is needed. `ok[lane]` is set to 1 if the lane has a square root, and to
+0 if it does not (then the value of that lane in `dest` is meaningless). The
+input must be squeezed, the output is squeezed.
+*/
+void fe12x4_sqrt(fe12x4 dest, uint8_t ok[4], const fe12x4 element);
+
+/*
+Compute the Legendre symbol of every lane, i.e. z^((p - 1) / 2): `chi[lane]`
+is 1 if the lane is a nonzero square, -1 if it is not a square, and 0 if it
+is zero. The input must be squeezed.
+*/
+void fe12x4_legendre(int8_t chi[4], const fe12x4 element);
+
+#endif /* CURVE13318_REF12_FE12X4_H_ */
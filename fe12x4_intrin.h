@@ -0,0 +1,234 @@
+/*
+AVX intrinsics versions of the fe12x4 kernels
+
+These are C translations of the `fe12x4_mul_body`, `fe12x4_squeeze_body` and
+`fe12x4_carry_body` macros (fe12_mul.mac and fe12_squeeze.mac). Every limb is a
+__m256d holding limb i of four fe12 values, like a ymm register in the
+assembly. The kernels do the same floating point operations as the macros, so
+they compute exactly the same values, and the same bounds hold.
+
+The kernels are `static inline`, so that the compiler can inline them into the
+group operations and schedule across them (see ladder_intrin.c). Only include
+this header from code that is compiled with AVX enabled.
+*/
+
+#ifndef CURVE13318_REF12_FE12X4_INTRIN_H_
+#define CURVE13318_REF12_FE12X4_INTRIN_H_
+
+#include <immintrin.h>
+
+// Move the part of z[i] that does not fit in its limb to z[j]. `c` is the
+// precisionloss value of limb i, i.e. 3 * 2^(k + 51) for the offset k of the
+// next limb (see `.carrystep`).
+static inline void fe12x4_carrystep_intrin(__m256d z[12], unsigned int i,
+                                           unsigned int j, double c)
+{
+    const __m256d cv = _mm256_set1_pd(c);
+    const __m256d t = _mm256_sub_pd(_mm256_add_pd(z[i], cv), cv);
+    z[j] = _mm256_add_pd(z[j], t);
+    z[i] = _mm256_sub_pd(z[i], t);
+}
+
+// The carry from z[11] to z[0], which is multiplied by 19 * 2^-255
+static inline __m256d fe12x4_carry11_intrin(__m256d z[12])
+{
+    const __m256d cv = _mm256_set1_pd(0x3p306);
+    const __m256d t = _mm256_sub_pd(_mm256_add_pd(z[11], cv), cv);
+    z[11] = _mm256_sub_pd(z[11], t);
+    return _mm256_mul_pd(t, _mm256_set1_pd(0x13p-255));
+}
+
+// Schoolbook multiplication of two 6-limb halves: r = a * b
+static inline void fe12x4_mul6_intrin(__m256d r[11], const __m256d a[6],
+                                      const __m256d b[6])
+{
+    for (unsigned int k = 0; k < 11; k++) r[k] = _mm256_setzero_pd();
+    #pragma GCC unroll 6
+    for (unsigned int i = 0; i < 6; i++) {
+        #pragma GCC unroll 6
+        for (unsigned int j = 0; j < 6; j++) {
+            r[i + j] = _mm256_add_pd(r[i + j], _mm256_mul_pd(a[i], b[j]));
+        }
+    }
+}
+
+/*
+Carry ripple four field elements, like `fe12x4_squeeze_body`
+
+Three interleaved carry chains in five rounds:
+
+  - a: z[0] -> z[1] ->  z[2] ->  z[3] -> z[4] -> z[5]
+  - b: z[4] -> z[5] ->  z[6] ->  z[7] -> z[8] -> z[9]
+  - c: z[8] -> z[9] -> z[10] -> z[11] -> z[0] -> z[1]
+
+Precondition:
+  - For all limbs x in z : |x| <= 0.99 * 2^53
+
+Postcondition:
+  - All significands fit in b + 1 bits (b = 22, 21, 21, etc.)
+*/
+static inline void fe12x4_squeeze_intrin(__m256d z[12])
+{
+    fe12x4_carrystep_intrin(z, 0, 1, 0x3p73);     // Round 1
+    fe12x4_carrystep_intrin(z, 4, 5, 0x3p158);
+    fe12x4_carrystep_intrin(z, 8, 9, 0x3p243);
+    fe12x4_carrystep_intrin(z, 1, 2, 0x3p94);     // Round 2
+    fe12x4_carrystep_intrin(z, 5, 6, 0x3p179);
+    fe12x4_carrystep_intrin(z, 9, 10, 0x3p264);
+    fe12x4_carrystep_intrin(z, 2, 3, 0x3p115);    // Round 3
+    fe12x4_carrystep_intrin(z, 6, 7, 0x3p200);
+    fe12x4_carrystep_intrin(z, 10, 11, 0x3p285);
+    fe12x4_carrystep_intrin(z, 3, 4, 0x3p136);    // Round 4
+    fe12x4_carrystep_intrin(z, 7, 8, 0x3p221);
+    z[0] = _mm256_add_pd(z[0], fe12x4_carry11_intrin(z));
+    fe12x4_carrystep_intrin(z, 4, 5, 0x3p158);    // Round 5
+    fe12x4_carrystep_intrin(z, 8, 9, 0x3p243);
+    fe12x4_carrystep_intrin(z, 0, 1, 0x3p73);
+}
+
+/*
+Carry all limbs of four field elements once, like
+`fe12x4_carry_body 11, 10, ..., 0`
+
+All carries are computed from the input limbs (see `fe12x4_carry_body` for the
+bounds).
+*/
+static inline void fe12x4_carry_intrin(__m256d z[12])
+{
+    static const double precisionloss[11] = {
+        0x3p73, 0x3p94, 0x3p115, 0x3p136, 0x3p158, 0x3p179,
+        0x3p200, 0x3p221, 0x3p243, 0x3p264, 0x3p285
+    };
+    const __m256d c11 = fe12x4_carry11_intrin(z);
+    #pragma GCC unroll 11
+    for (int i = 10; i >= 0; i--) {
+        fe12x4_carrystep_intrin(z, i, i + 1, precisionloss[i]);
+    }
+    z[0] = _mm256_add_pd(z[0], c11);
+}
+
+/*
+Multiply four pairs of field elements and squeeze the products, like
+`fe12x4_mul`
+
+This is the same subtractive Karatsuba multiplication as `fe12x4_mul_body`.
+The assembly divides limbs 7..10 of the high halves by 2^128 with a mask
+instead of a multiplication; that gives the same values. All products are
+exact, so the result is exactly the same. `h` may alias `f` and `g`.
+
+Precondition:
+  - The same as for `fe12_mul`
+*/
+static inline void fe12x4_mul_intrin(__m256d h[12], const __m256d f[12],
+                                     const __m256d g[12])
+{
+    const __m256d shr = _mm256_set1_pd(0x1p-128);
+    const __m256d shl = _mm256_set1_pd(0x1p+128);
+    const __m256d c38 = _mm256_set1_pd(0x26);
+    // The low halves are f[0..5] and g[0..5] themselves, and the differences
+    // overwrite the high halves once their product is done, so that the frame
+    // stays small (see `scalarmult_arena`)
+    __m256d a[6], b[6];
+    __m256d l[11], hh[11], m[11];
+    for (unsigned int i = 0; i < 6; i++) {
+        a[i] = _mm256_mul_pd(shr, f[i + 6]);
+        b[i] = _mm256_mul_pd(shr, g[i + 6]);
+    }
+    fe12x4_mul6_intrin(hh, a, b);
+    for (unsigned int i = 0; i < 6; i++) {
+        a[i] = _mm256_sub_pd(f[i], a[i]);
+        b[i] = _mm256_sub_pd(b[i], g[i]);
+    }
+    fe12x4_mul6_intrin(l, f, g);
+    fe12x4_mul6_intrin(m, a, b);
+
+    for (unsigned int k = 0; k < 6; k++) {
+        // h[k] = l[k] + 38 * (2^-128 * (m[k+6] + l[k+6] + h[k+6]) + h[k])
+        __m256d t = hh[k];
+        if (k < 5) {
+            const __m256d mid = _mm256_add_pd(_mm256_add_pd(m[k + 6], l[k + 6]), hh[k + 6]);
+            t = _mm256_add_pd(_mm256_mul_pd(mid, shr), t);
+        }
+        h[k] = _mm256_add_pd(_mm256_mul_pd(t, c38), l[k]);
+    }
+    for (unsigned int k = 6; k < 12; k++) {
+        // h[k] = l[k] + 2^128 * (m[k-6] + l[k-6] + h[k-6]) + 38 * h[k]
+        const __m256d mid = _mm256_add_pd(_mm256_add_pd(m[k - 6], l[k - 6]), hh[k - 6]);
+        __m256d t = _mm256_mul_pd(mid, shl);
+        if (k < 11) t = _mm256_add_pd(t, _mm256_add_pd(_mm256_mul_pd(c38, hh[k]), l[k]));
+        h[k] = t;
+    }
+    fe12x4_squeeze_intrin(h);
+}
+
+// Schoolbook squaring of a 6-limb half: r = a^2, with the cross products
+// doubled instead of computed twice
+static inline void fe12x4_square6_intrin(__m256d r[11], const __m256d a[6])
+{
+    __m256d a2[6];
+    for (unsigned int i = 0; i < 6; i++) a2[i] = _mm256_add_pd(a[i], a[i]);
+    for (unsigned int k = 0; k < 11; k++) r[k] = _mm256_setzero_pd();
+    #pragma GCC unroll 6
+    for (unsigned int i = 0; i < 6; i++) {
+        r[2*i] = _mm256_add_pd(r[2*i], _mm256_mul_pd(a[i], a[i]));
+        #pragma GCC unroll 5
+        for (unsigned int j = i + 1; j < 6; j++) {
+            r[i + j] = _mm256_add_pd(r[i + j], _mm256_mul_pd(a2[i], a[j]));
+        }
+    }
+}
+
+/*
+Square four field elements and squeeze the results
+
+This is `fe12x4_mul_intrin` with f == g, but every half is squared with 21
+instead of 36 products. The middle product of the subtractive Karatsuba
+method is (a_lo - a_hi) * (a_hi - a_lo) = -(a_lo - a_hi)^2. All products and
+sums are exact, so the result is exactly the same as that of
+`fe12x4_mul_intrin(h, f, f)`. `h` may alias `f`.
+*/
+static inline void fe12x4_square_intrin(__m256d h[12], const __m256d f[12])
+{
+    const __m256d shr = _mm256_set1_pd(0x1p-128);
+    const __m256d shl = _mm256_set1_pd(0x1p+128);
+    const __m256d c38 = _mm256_set1_pd(0x26);
+    __m256d a_lo[6], a_hi[6], a_d[6];
+    __m256d l[11], hh[11], d[11];
+    for (unsigned int i = 0; i < 6; i++) {
+        a_lo[i] = f[i];
+        a_hi[i] = _mm256_mul_pd(shr, f[i + 6]);
+        a_d[i] = _mm256_sub_pd(a_lo[i], a_hi[i]);
+    }
+    fe12x4_square6_intrin(l, a_lo);
+    fe12x4_square6_intrin(hh, a_hi);
+    fe12x4_square6_intrin(d, a_d);
+
+    for (unsigned int k = 0; k < 6; k++) {
+        // h[k] = l[k] + 38 * (2^-128 * (l[k+6] + h[k+6] - d[k+6]) + h[k])
+        __m256d t = hh[k];
+        if (k < 5) {
+            const __m256d mid = _mm256_sub_pd(_mm256_add_pd(l[k + 6], hh[k + 6]), d[k + 6]);
+            t = _mm256_add_pd(_mm256_mul_pd(mid, shr), t);
+        }
+        h[k] = _mm256_add_pd(_mm256_mul_pd(t, c38), l[k]);
+    }
+    for (unsigned int k = 6; k < 12; k++) {
+        // h[k] = l[k] + 2^128 * (l[k-6] + h[k-6] - d[k-6]) + 38 * h[k]
+        const __m256d mid = _mm256_sub_pd(_mm256_add_pd(l[k - 6], hh[k - 6]), d[k - 6]);
+        __m256d t = _mm256_mul_pd(mid, shl);
+        if (k < 11) t = _mm256_add_pd(t, _mm256_add_pd(_mm256_mul_pd(c38, hh[k]), l[k]));
+        h[k] = t;
+    }
+    fe12x4_squeeze_intrin(h);
+}
+
+/*
+Square four field elements `n` times, squeezing after every square
+*/
+static inline void fe12x4_nsquare_intrin(__m256d h[12], const __m256d f[12], unsigned int n)
+{
+    fe12x4_square_intrin(h, f);
+    for (unsigned int i = 1; i < n; i++) fe12x4_square_intrin(h, h);
+}
+
+#endif /* CURVE13318_REF12_FE12X4_INTRIN_H_ */
@@ -0,0 +1,159 @@
+/*
+    Exponentiation of four field elements at once (see fe12x4.h).
+
+    Every exponent is computed with the same addition chain as `fe51_invert`
+    (up to z^(2^250 - 1)), on all four lanes at once. The runs of squarings
+    stay in registers (`fe12x4_nsquare_intrin`), so there are no loads or
+    stores between them.
+*/
+
+#include "fe12x4.h"
+#include "fe12x4_intrin.h"
+
+typedef __m256d vec;
+
+static inline void load(vec dest[12], const fe12x4 src)
+{
+    for (unsigned int i = 0; i < 12; i++) dest[i] = _mm256_load_pd(src[i]);
+}
+
+static inline void store(fe12x4 dest, const vec src[12])
+{
+    for (unsigned int i = 0; i < 12; i++) _mm256_store_pd(dest[i], src[i]);
+}
+
+static inline void copy(vec dest[12], const vec src[12])
+{
+    for (unsigned int i = 0; i < 12; i++) dest[i] = src[i];
+}
+
+// Compute z^(2^250 - 1), as well as z^2 and z^11, which the callers need to
+// finish their exponents
+static void pow_2_250_1(vec z2_250_0[12], vec z2[12], vec z11[12], const vec z[12])
+{
+    vec z9[12], z2_5_0[12], z2_10_0[12], z2_20_0[12], z2_50_0[12], z2_100_0[12], t[12];
+
+    /* 2 */ fe12x4_square_intrin(z2, z);
+    /* 8 */ fe12x4_nsquare_intrin(t, z2, 2);
+    /* 9 */ fe12x4_mul_intrin(z9, t, z);
+    /* 11 */ fe12x4_mul_intrin(z11, z9, z2);
+    /* 22 */ fe12x4_square_intrin(t, z11);
+    /* 2^5 - 2^0 = 31 */ fe12x4_mul_intrin(z2_5_0, t, z9);
+
+    /* 2^10 - 2^5 */ fe12x4_nsquare_intrin(t, z2_5_0, 5);
+    /* 2^10 - 2^0 */ fe12x4_mul_intrin(z2_10_0, t, z2_5_0);
+
+    /* 2^20 - 2^10 */ fe12x4_nsquare_intrin(t, z2_10_0, 10);
+    /* 2^20 - 2^0 */ fe12x4_mul_intrin(z2_20_0, t, z2_10_0);
+
+    /* 2^40 - 2^20 */ fe12x4_nsquare_intrin(t, z2_20_0, 20);
+    /* 2^40 - 2^0 */ fe12x4_mul_intrin(t, t, z2_20_0);
+
+    /* 2^50 - 2^10 */ fe12x4_nsquare_intrin(t, t, 10);
+    /* 2^50 - 2^0 */ fe12x4_mul_intrin(z2_50_0, t, z2_10_0);
+
+    /* 2^100 - 2^50 */ fe12x4_nsquare_intrin(t, z2_50_0, 50);
+    /* 2^100 - 2^0 */ fe12x4_mul_intrin(z2_100_0, t, z2_50_0);
+
+    /* 2^200 - 2^100 */ fe12x4_nsquare_intrin(t, z2_100_0, 100);
+    /* 2^200 - 2^0 */ fe12x4_mul_intrin(t, t, z2_100_0);
+
+    /* 2^250 - 2^50 */ fe12x4_nsquare_intrin(t, t, 50);
+    /* 2^250 - 2^0 */ fe12x4_mul_intrin(z2_250_0, t, z2_50_0);
+}
+
+// Set c[lane] to 1 if lane `lane` of `f` and `g` are the same field element,
+// and to 0 otherwise. Both must be squeezed.
+static void equal(uint8_t c[4], const fe12x4 f, const fe12x4 g)
+{
+    uint8_t f_bytes[4][32], g_bytes[4][32];
+    fe12x4_tobytes(f_bytes, f);
+    fe12x4_tobytes(g_bytes, g);
+    for (unsigned int lane = 0; lane < 4; lane++) {
+        unsigned int diff = 0;
+        for (unsigned int i = 0; i < 32; i++) diff |= f_bytes[lane][i] ^ g_bytes[lane][i];
+        c[lane] = ((diff - 1) >> 8) & 1;
+    }
+}
+
+void fe12x4_invert(fe12x4 dest, const fe12x4 element)
+{
+    vec z[12], z2[12], z11[12], t[12];
+    load(z, element);
+    pow_2_250_1(t, z2, z11, z);
+    /* 2^255 - 2^5 */ fe12x4_nsquare_intrin(t, t, 5);
+    /* 2^255 - 21 */ fe12x4_mul_intrin(t, t, z11);
+    store(dest, t);
+}
+
+void fe12x4_pow2523(fe12x4 dest, const fe12x4 element)
+{
+    vec z[12], z2[12], z11[12], t[12];
+    load(z, element);
+    pow_2_250_1(t, z2, z11, z);
+    /* 2^252 - 4 */ fe12x4_nsquare_intrin(t, t, 2);
+    /* 2^252 - 3 */ fe12x4_mul_intrin(t, t, z);
+    store(dest, t);
+}
+
+void fe12x4_sqrt(fe12x4 dest, uint8_t ok[4], const fe12x4 element)
+{
+    // sqrt(-1) = 2^((p - 1) / 4)
+    static const fe12 sqrtm1 = {
+        958640, 826664 * 0x1p22, 1613251 * 0x1p43, 1041528 * 0x1p64,
+        13673 * 0x1p85, 387171 * 0x1p107, 1824679 * 0x1p128,
+        313839 * 0x1p149, 709440 * 0x1p170, 122635 * 0x1p192,
+        262782 * 0x1p213, 712905 * 0x1p234
+    };
+    vec z[12], z2[12], z11[12], t[12], u[12];
+    fe12x4 __attribute__((aligned(32))) neg_x, r, r_i, r2;
+    uint8_t is_root[4], is_neg_root[4];
+
+    load(z, element);
+    pow_2_250_1(t, z2, z11, z);
+    /* 2^251 - 2 */ fe12x4_square_intrin(t, t);
+    /* 2^251 - 1 */ fe12x4_mul_intrin(t, t, z);
+    /* 2^252 - 2 = (p + 3) / 8 */ fe12x4_square_intrin(t, t);
+    store(r, t);
+    for (unsigned int i = 0; i < 12; i++) u[i] = _mm256_set1_pd(sqrtm1[i]);
+    fe12x4_mul_intrin(u, u, t);
+    store(r_i, u);
+
+    // r^2 is x, or -x (then r * sqrt(-1) is a root), or neither (then x is not
+    // a square)
+    fe12x4_square_intrin(t, t);
+    store(r2, t);
+    for (unsigned int i = 0; i < 12; i++) u[i] = _mm256_sub_pd(_mm256_setzero_pd(), z[i]);
+    fe12x4_squeeze_intrin(u);
+    store(neg_x, u);
+    equal(is_root, r2, element);
+    equal(is_neg_root, r2, neg_x);
+
+    fe12x4_select(dest, r, r_i, is_neg_root);
+    for (unsigned int lane = 0; lane < 4; lane++) ok[lane] = is_root[lane] | is_neg_root[lane];
+}
+
+void fe12x4_legendre(int8_t chi[4], const fe12x4 element)
+{
+    static const fe12 one = { 1 };
+    vec z[12], z2[12], z11[12], t[12];
+    fe12x4 __attribute__((aligned(32))) s, zero, ones;
+    uint8_t is_zero[4], is_one[4];
+
+    load(z, element);
+    pow_2_250_1(t, z2, z11, z);
+    /* 2^252 - 4 */ fe12x4_nsquare_intrin(t, t, 2);
+    /* 2^252 - 3 */ fe12x4_mul_intrin(t, t, z);
+    /* 2^254 - 12 */ fe12x4_nsquare_intrin(t, t, 2);
+    /* 2^254 - 10 = (p - 1) / 2 */ fe12x4_mul_intrin(t, t, z2);
+    store(s, t);
+
+    fe12x4_zero(zero);
+    fe12x4_load(ones, one, one, one, one);
+    equal(is_zero, s, zero);
+    equal(is_one, s, ones);
+    for (unsigned int lane = 0; lane < 4; lane++) {
+        // 1 if s == 1, 0 if s == 0, and -1 otherwise (then s == -1)
+        chi[lane] = (int8_t)(is_one[lane] - (1 - is_one[lane] - is_zero[lane]));
+    }
+}
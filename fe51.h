@@ -11,6 +11,12 @@
 #define fe51_mul crypto_scalarmult_curve13318_ref12_fe51_mul
 #define fe51_nsquare crypto_scalarmult_curve13318_ref12_fe51_nsquare
 #define fe51_invert crypto_scalarmult_curve13318_ref12_fe51_invert
+#define fe51_pow2523 crypto_scalarmult_curve13318_ref12_fe51_pow2523
+#define fe51_frombytes crypto_scalarmult_curve13318_ref12_fe51_frombytes
+#define fe51_add crypto_scalarmult_curve13318_ref12_fe51_add
+#define fe51_sub crypto_scalarmult_curve13318_ref12_fe51_sub
+#define fe51_mul_small crypto_scalarmult_curve13318_ref12_fe51_mul_small
+#define fe51_cmov crypto_scalarmult_curve13318_ref12_fe51_cmov
 
 typedef struct
 {
@@ -22,5 +28,82 @@ extern void fe51_pack(unsigned char *, const fe51 *);
 extern void fe51_mul(fe51 *, const fe51 *, const fe51 *);
 extern void fe51_nsquare(fe51 *, const fe51 *, int);
 extern void fe51_invert(fe51 *, const fe51 *);
+extern void fe51_pow2523(fe51 *, const fe51 *);
+
+/*
+The functions below are not from sandy2x. Their outputs are carried, i.e.
+every limb is smaller than 2^51 + 2^18, so they can be passed straight to
+`fe51_mul` and `fe51_nsquare`. They expect the same of their inputs.
+*/
+
+static inline void fe51_carry(fe51 *h)
+{
+  const uint64_t mask = (1ULL << 51) - 1;
+  uint64_t c = 0;
+  for (unsigned int i = 0; i < 5; i++) {
+    h->v[i] += c;
+    c = h->v[i] >> 51;
+    h->v[i] &= mask;
+  }
+  h->v[0] += 19 * c;
+}
+
+/*
+Parse 32 bytes (little endian) into a fe51 value, ignoring the 255'th bit
+*/
+static inline void fe51_frombytes(fe51 *h, const unsigned char *s)
+{
+  uint64_t w[4] = {0};
+  for (unsigned int i = 0; i < 32; i++) w[i / 8] |= (uint64_t)s[i] << (8 * (i % 8));
+  const uint64_t mask = (1ULL << 51) - 1;
+  h->v[0] = w[0] & mask;
+  h->v[1] = ((w[0] >> 51) | (w[1] << 13)) & mask;
+  h->v[2] = ((w[1] >> 38) | (w[2] << 26)) & mask;
+  h->v[3] = ((w[2] >> 25) | (w[3] << 39)) & mask;
+  h->v[4] = (w[3] >> 12) & mask;
+}
+
+static inline void fe51_add(fe51 *h, const fe51 *f, const fe51 *g)
+{
+  for (unsigned int i = 0; i < 5; i++) h->v[i] = f->v[i] + g->v[i];
+  fe51_carry(h);
+}
+
+/*
+Compute h = f - g, by adding 4*p to f first so that no limb goes negative
+*/
+static inline void fe51_sub(fe51 *h, const fe51 *f, const fe51 *g)
+{
+  const uint64_t four_p0 = 0x1FFFFFFFFFFFB4, four_p = 0x1FFFFFFFFFFFFC;
+  h->v[0] = f->v[0] + four_p0 - g->v[0];
+  for (unsigned int i = 1; i < 5; i++) h->v[i] = f->v[i] + four_p - g->v[i];
+  fe51_carry(h);
+}
+
+/*
+Multiply f by a small constant n < 2^32
+*/
+static inline void fe51_mul_small(fe51 *h, const fe51 *f, uint32_t n)
+{
+  const uint64_t mask = (1ULL << 51) - 1;
+  unsigned __int128 c = 0;
+  for (unsigned int i = 0; i < 5; i++) {
+    c += (unsigned __int128)f->v[i] * n;
+    h->v[i] = (uint64_t)c & mask;
+    c >>= 51;
+  }
+  h->v[0] += 19 * (uint64_t)c;
+  fe51_carry(h);
+}
+
+/*
+Constant time conditional move: h becomes g if `b` == 1, and stays the same
+if `b` == 0. `b` must be exactly 0 or 1.
+*/
+static inline void fe51_cmov(fe51 *h, const fe51 *g, uint64_t b)
+{
+  const uint64_t mask = -b;
+  for (unsigned int i = 0; i < 5; i++) h->v[i] ^= mask & (h->v[i] ^ g->v[i]);
+}
 
 #endif /* REF12_FE51_H_ */
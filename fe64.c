@@ -0,0 +1,150 @@
+#include "fe64.h"
+#include <stdint.h>
+
+typedef unsigned __int128 uint128_t;
+
+static inline uint64_t load_8(const uint8_t *in)
+{
+    uint64_t ret = 0;
+    for (unsigned int i = 0; i < 8; i++) ret |= (uint64_t)in[i] << (8*i);
+    return ret;
+}
+
+static inline void store_8(uint8_t *out, uint64_t x)
+{
+    for (unsigned int i = 0; i < 8; i++) out[i] = (uint8_t)(x >> (8*i));
+}
+
+void fe64_frombytes(fe64 z, const uint8_t *in)
+{
+    // All 256 bits are used, bit 255 is implicitly reduced by every operation
+    for (unsigned int i = 0; i < 4; i++) z[i] = load_8(&in[8*i]);
+}
+
+void fe64_tobytes(uint8_t *out, const fe64 z)
+{
+    fe64 t;
+    fe64_copy(t, z);
+    fe64_freeze(t);
+    for (unsigned int i = 0; i < 4; i++) store_8(&out[8*i], t[i]);
+}
+
+void fe64_add(fe64 h, const fe64 f, const fe64 g)
+{
+    // Add and fold the carry back in using 2^256 = 38 (mod p). If the second
+    // fold also carries, the low limb is at most 37, so the third fold into
+    // the low limb cannot overflow.
+    uint128_t t = 0;
+    uint64_t carry;
+    for (unsigned int i = 0; i < 4; i++) {
+        t += (uint128_t)f[i] + g[i];
+        h[i] = (uint64_t)t;
+        t >>= 64;
+    }
+    carry = (uint64_t)t;
+    t = (uint128_t)h[0] + 38 * carry;
+    h[0] = (uint64_t)t;
+    for (unsigned int i = 1; i < 4; i++) {
+        t = (t >> 64) + h[i];
+        h[i] = (uint64_t)t;
+    }
+    h[0] += 38 * (uint64_t)(t >> 64);
+}
+
+void fe64_sub(fe64 h, const fe64 f, const fe64 g)
+{
+    // Subtract and fold the borrow back in using 2^256 = 38 (mod p), like in
+    // `fe64_add`
+    uint64_t borrow = 0;
+    for (unsigned int i = 0; i < 4; i++) {
+        const uint128_t t = (uint128_t)f[i] - g[i] - borrow;
+        h[i] = (uint64_t)t;
+        borrow = (uint64_t)(t >> 64) & 1;
+    }
+    borrow *= 38;
+    for (unsigned int i = 0; i < 4; i++) {
+        const uint128_t t = (uint128_t)h[i] - borrow;
+        h[i] = (uint64_t)t;
+        borrow = (uint64_t)(t >> 64) & 1;
+    }
+    h[0] -= 38 * borrow;
+}
+
+void fe64_mul_small(fe64 h, const fe64 f, uint64_t c)
+{
+    uint128_t t = 0;
+    for (unsigned int i = 0; i < 4; i++) {
+        t += (uint128_t)f[i] * c;
+        h[i] = (uint64_t)t;
+        t >>= 64;
+    }
+    // The top word is at most c, fold it back using 2^256 = 38 (mod p)
+    t = (uint128_t)h[0] + 38 * (uint64_t)t;
+    h[0] = (uint64_t)t;
+    for (unsigned int i = 1; i < 4; i++) {
+        t = (t >> 64) + h[i];
+        h[i] = (uint64_t)t;
+    }
+    h[0] += 38 * (uint64_t)(t >> 64);
+}
+
+void fe64_freeze(fe64 z)
+{
+    uint128_t t;
+    fe64 r;
+
+    // Fold bit 255 using 2^255 = 19 (mod p), so that z < 2^255 + 19
+    t = (uint128_t)z[0] + 19 * (z[3] >> 63);
+    z[3] &= 0x7FFFFFFFFFFFFFFF;
+    z[0] = (uint64_t)t;
+    for (unsigned int i = 1; i < 4; i++) {
+        t = (t >> 64) + z[i];
+        z[i] = (uint64_t)t;
+    }
+
+    // z >= p iff z + 19 >= 2^255, in which case z - p = (z + 19) - 2^255
+    t = (uint128_t)z[0] + 19;
+    r[0] = (uint64_t)t;
+    for (unsigned int i = 1; i < 4; i++) {
+        t = (t >> 64) + z[i];
+        r[i] = (uint64_t)t;
+    }
+    const uint64_t mask = -(r[3] >> 63);
+    r[3] &= 0x7FFFFFFFFFFFFFFF;
+    fe64_cmov(z, r, mask);
+}
+
+static void fe64_nsquare(fe64 z, const fe64 f, unsigned int n)
+{
+    fe64_square(z, f);
+    for (unsigned int i = 1; i < n; i++) fe64_square(z, z);
+}
+
+void fe64_invert(fe64 out, const fe64 z)
+{
+    // Compute z^(p-2) with the usual addition chain for 2^255 - 21
+    fe64 z2, z9, z11, z2_5_0, z2_10_0, z2_20_0, z2_50_0, z2_100_0, t;
+
+    fe64_square(z2, z);                 // 2
+    fe64_nsquare(t, z2, 2);             // 8
+    fe64_mul(z9, t, z);                 // 9
+    fe64_mul(z11, z9, z2);              // 11
+    fe64_square(t, z11);                // 22
+    fe64_mul(z2_5_0, t, z9);            // 2^5 - 2^0
+    fe64_nsquare(t, z2_5_0, 5);         // 2^10 - 2^5
+    fe64_mul(z2_10_0, t, z2_5_0);       // 2^10 - 2^0
+    fe64_nsquare(t, z2_10_0, 10);       // 2^20 - 2^10
+    fe64_mul(z2_20_0, t, z2_10_0);      // 2^20 - 2^0
+    fe64_nsquare(t, z2_20_0, 20);       // 2^40 - 2^20
+    fe64_mul(t, t, z2_20_0);            // 2^40 - 2^0
+    fe64_nsquare(t, t, 10);             // 2^50 - 2^10
+    fe64_mul(z2_50_0, t, z2_10_0);      // 2^50 - 2^0
+    fe64_nsquare(t, z2_50_0, 50);       // 2^100 - 2^50
+    fe64_mul(z2_100_0, t, z2_50_0);     // 2^100 - 2^0
+    fe64_nsquare(t, z2_100_0, 100);     // 2^200 - 2^100
+    fe64_mul(t, t, z2_100_0);           // 2^200 - 2^0
+    fe64_nsquare(t, t, 50);             // 2^250 - 2^50
+    fe64_mul(t, t, z2_50_0);            // 2^250 - 2^0
+    fe64_nsquare(t, t, 5);              // 2^255 - 2^5
+    fe64_mul(out, t, z11);              // 2^255 - 21
+}
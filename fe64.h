@@ -0,0 +1,102 @@
+/*
+Field element arithmetic modulo 2^255 - 19 in packed radix 2^64
+
+A field element is stored in four 64-bit limbs, i.e. as an integer in
+[0, 2^256). It is not necessarily reduced modulo p, and all operations accept
+any value in that range. Multiplication and squaring use the BMI2/ADX
+instructions (mulx, adcx and adox), so this representation must only be used
+on CPUs that support those (Broadwell, Zen and later).
+*/
+
+#ifndef CURVE13318_REF12_FE64_H_
+#define CURVE13318_REF12_FE64_H_
+
+#include <stdint.h>
+
+typedef uint64_t fe64[4];
+
+#define fe64_frombytes crypto_scalarmult_curve13318_ref12_fe64_frombytes
+#define fe64_tobytes crypto_scalarmult_curve13318_ref12_fe64_tobytes
+#define fe64_add crypto_scalarmult_curve13318_ref12_fe64_add
+#define fe64_sub crypto_scalarmult_curve13318_ref12_fe64_sub
+#define fe64_mul crypto_scalarmult_curve13318_ref12_fe64_mul
+#define fe64_square crypto_scalarmult_curve13318_ref12_fe64_square
+#define fe64_mul_small crypto_scalarmult_curve13318_ref12_fe64_mul_small
+#define fe64_freeze crypto_scalarmult_curve13318_ref12_fe64_freeze
+#define fe64_invert crypto_scalarmult_curve13318_ref12_fe64_invert
+
+/*
+Set a fe64 value to zero
+*/
+static inline void fe64_zero(fe64 z) {
+    for (unsigned int i = 0; i < 4; i++) z[i] = 0;
+}
+
+/*
+Set a fe64 value to one
+*/
+static inline void fe64_one(fe64 z) {
+    z[0] = 1;
+    for (unsigned int i = 1; i < 4; i++) z[i] = 0;
+}
+
+/*
+Copy a fe64 value to another fe64 value
+*/
+static inline void fe64_copy(fe64 dest, const fe64 src) {
+    for (unsigned int i = 0; i < 4; i++) dest[i] = src[i];
+}
+
+/*
+Replace `dest` with `src` if `mask` is all ones, keep it if `mask` is zero
+*/
+static inline void fe64_cmov(fe64 dest, const fe64 src, uint64_t mask) {
+    for (unsigned int i = 0; i < 4; i++) dest[i] ^= (dest[i] ^ src[i]) & mask;
+}
+
+/*
+Parse 32 bytes (little endian) into a fe64 value
+*/
+void fe64_frombytes(fe64 element, const uint8_t *bytes);
+
+/*
+Store a fe64 value as 32 bytes (little endian), fully reduced modulo p
+*/
+void fe64_tobytes(uint8_t *bytes, const fe64 element);
+
+/*
+Add `lhs` and `rhs` and store the result in `dest`
+*/
+void fe64_add(fe64 dest, const fe64 lhs, const fe64 rhs);
+
+/*
+Subtract `rhs` from `lhs` and store the result in `dest`
+*/
+void fe64_sub(fe64 dest, const fe64 lhs, const fe64 rhs);
+
+/*
+Multiply two field elements (mulx/adcx/adox assembly)
+*/
+void fe64_mul(fe64 dest, const fe64 op1, const fe64 op2);
+
+/*
+Square a field element (mulx/adcx/adox assembly)
+*/
+void fe64_square(fe64 dest, const fe64 element);
+
+/*
+Multiply a field element by a small (at most 32-bit) constant
+*/
+void fe64_mul_small(fe64 dest, const fe64 element, uint64_t c);
+
+/*
+Reduce a field element to its unique representative in [0, p)
+*/
+void fe64_freeze(fe64 element);
+
+/*
+Invert a field element (the inverse of zero is zero)
+*/
+void fe64_invert(fe64 dest, const fe64 element);
+
+#endif /* CURVE13318_REF12_FE64_H_ */
@@ -1,35 +1,43 @@
 #include "fe_convert.h"
+#include "fe12_bounds.h"
 #include "ge.h"
 #include <stdbool.h>
 
-static bool ge_affine_point_on_curve(ge p)
+#ifdef CURVE13318_CHECK_BOUNDS
+// Record the input of every squeeze in this file, to see which ones have slack
+#undef fe12_squeeze
+#define fe12_squeeze(z) fe12_bounds_squeeze(__func__, __LINE__, #z, z)
+#endif
+
+// Return an all-ones mask if `z` is zero (mod p), and zero otherwise
+static uint64_t fe51_zero_mask(const fe51 *z)
+{
+    uint8_t bytes[32];
+    uint64_t nonzero = 0;
+    fe51_pack(bytes, z);
+    for (unsigned int i = 0; i < 32; i++) nonzero |= bytes[i];
+    return -((nonzero - 1) >> 63);
+}
+
+static bool ge_affine_point_on_curve(const uint8_t *s)
 {
     // Use the general curve equation to check if this point is on the curve
     // y^2 = x^3 - 3*x + 13318
-    // TODO(dsprenkels) Implement this function using radix-2^51 arithmetic.
-    fe10 x, y, lhs, rhs, t0;
-    fe10_frozen result;
-    convert_fe12_to_fe10(x, p[0]);
-    convert_fe12_to_fe10(y, p[1]);
-    fe10_square(lhs, y);     // y^2
-    fe10_square(t0, x);      // x^2
-    fe10_mul(rhs, t0, x);    // x^3
-    fe10_zero(t0);            // 0
-    fe10_add2p(t0);           // 0
-    fe10_sub(t0, t0, x);     // -x
-    fe10_add(rhs, rhs, t0);   // x^3 - x
-    fe10_add(rhs, rhs, t0);   // x^3 - 2*x
-    fe10_add(rhs, rhs, t0);   // x^3 - 3*x
-    fe10_add_b(rhs);          // x^3 - 3*x + 13318
-    fe10_carry(rhs);
-    fe10_add2p(lhs);          // Still y^2
-    fe10_sub(lhs, lhs, rhs);  // (==0) or (!=0) mod p
-    fe10_carry(lhs);
-    fe10_reduce(result, lhs); // 0 or !0
-
-    uint64_t nonzero = 0;
-    for (unsigned int i = 0; i < 5; i++) nonzero |= result[i];
-    return nonzero == 0;
+    static const fe51 three = {{3, 0, 0, 0, 0}};
+    static const fe51 b = {{13318, 0, 0, 0, 0}};
+    fe51 x, y, lhs, rhs, t0;
+    fe51_frombytes(&x, &s[0]);
+    fe51_frombytes(&y, &s[32]);
+    // Like `fe12_frombytes`, reduce the 255'th bit instead of ignoring it
+    x.v[0] += 19 * (uint64_t)(s[31] >> 7);
+    y.v[0] += 19 * (uint64_t)(s[63] >> 7);
+    fe51_nsquare(&lhs, &y, 1);  // y^2
+    fe51_nsquare(&t0, &x, 1);   // x^2
+    fe51_sub(&t0, &t0, &three); // x^2 - 3
+    fe51_mul(&rhs, &t0, &x);    // x^3 - 3*x
+    fe51_add(&rhs, &rhs, &b);   // x^3 - 3*x + 13318
+    fe51_sub(&lhs, &lhs, &rhs); // (==0) or (!=0) mod p
+    return fe51_zero_mask(&lhs) != 0;
 }
 
 int ge_frombytes(ge p, const uint8_t *s)
@@ -58,7 +66,7 @@ int ge_frombytes(ge p, const uint8_t *s)
     for (unsigned int i = 1; i < 12; i++) p[2][i] = 0;
 
     // Check if this point is valid
-    if (!infinity & !ge_affine_point_on_curve(p)) return -1;
+    if (!infinity & !ge_affine_point_on_curve(s)) return -1;
     return 0;
 }
 
@@ -87,6 +95,88 @@ void ge_tobytes(uint8_t *s, ge p)
     fe51_pack(&s[32], &y_affine);
 }
 
+void ge_tobytes2(uint8_t *s1, uint8_t *s2, ge p1, ge p2)
+{
+    /*
+    Montgomery's trick: 1/z1 = z2 / (z1*z2) and 1/z2 = z1 / (z1*z2). If one
+    of the points is the point at infinity, its z is replaced by 1, so that
+    the other one can still be inverted, and its encoding is cleared to
+    (0, 0) afterwards.
+    */
+    fe51 x1, y1, z1, x2, y2, z2, z12, z12_inverse, z1_inverse, z2_inverse, t;
+
+    convert_fe12_to_fe51(&x1, p1[0]);
+    convert_fe12_to_fe51(&y1, p1[1]);
+    convert_fe12_to_fe51(&z1, p1[2]);
+    convert_fe12_to_fe51(&x2, p2[0]);
+    convert_fe12_to_fe51(&y2, p2[1]);
+    convert_fe12_to_fe51(&z2, p2[2]);
+    const uint64_t infinity1 = fe51_zero_mask(&z1);
+    const uint64_t infinity2 = fe51_zero_mask(&z2);
+    z1.v[0] += infinity1 & 1;
+    z2.v[0] += infinity2 & 1;
+
+    fe51_mul(&z12, &z1, &z2);
+    fe51_invert(&z12_inverse, &z12);
+    fe51_mul(&z1_inverse, &z12_inverse, &z2);
+    fe51_mul(&z2_inverse, &z12_inverse, &z1);
+
+    fe51_mul(&t, &x1, &z1_inverse);
+    fe51_pack(&s1[ 0], &t);
+    fe51_mul(&t, &y1, &z1_inverse);
+    fe51_pack(&s1[32], &t);
+    fe51_mul(&t, &x2, &z2_inverse);
+    fe51_pack(&s2[ 0], &t);
+    fe51_mul(&t, &y2, &z2_inverse);
+    fe51_pack(&s2[32], &t);
+
+    for (unsigned int i = 0; i < 64; i++) {
+        s1[i] &= (uint8_t)~infinity1;
+        s2[i] &= (uint8_t)~infinity2;
+    }
+}
+
+void ge_tobytes_batch(uint8_t (*s)[64], const ge *p, fe51 *acc, size_t len)
+{
+    /*
+    Montgomery's trick for `len` points: acc[i] = z_0 * ... * z_i, so after
+    inverting acc[len - 1] we can walk back and peel off one z at a time, with
+    1/z_i = acc[i - 1] / acc[i]. Points at infinity get z = 1, like in
+    `ge_tobytes2`. The z's are converted to fe51 again in the second pass,
+    which is cheaper than keeping them around.
+    */
+    fe51 x, y, z, inverse, z_inverse, t;
+
+    if (len == 0) return;
+    for (size_t i = 0; i < len; i++) {
+        convert_fe12_to_fe51(&z, p[i][2]);
+        z.v[0] += fe51_zero_mask(&z) & 1;
+        if (i == 0) acc[0] = z;
+        else fe51_mul(&acc[i], &acc[i - 1], &z);
+    }
+
+    fe51_invert(&inverse, &acc[len - 1]);
+    for (size_t i = len; i-- > 0;) {
+        convert_fe12_to_fe51(&x, p[i][0]);
+        convert_fe12_to_fe51(&y, p[i][1]);
+        convert_fe12_to_fe51(&z, p[i][2]);
+        const uint64_t infinity = fe51_zero_mask(&z);
+        z.v[0] += infinity & 1;
+        if (i == 0) {
+            z_inverse = inverse;
+        } else {
+            fe51_mul(&z_inverse, &inverse, &acc[i - 1]);
+            fe51_mul(&inverse, &inverse, &z);
+        }
+
+        fe51_mul(&t, &x, &z_inverse);
+        fe51_pack(&s[i][ 0], &t);
+        fe51_mul(&t, &y, &z_inverse);
+        fe51_pack(&s[i][32], &t);
+        for (unsigned int j = 0; j < 64; j++) s[i][j] &= (uint8_t)~infinity;
+    }
+}
+
 void ge_add_c(ge p3, const ge p1, const ge p2)
 {
     fe12 x1, y1, z1, x2, y2, z2, x3, y3, z3, t0, t1, t2, t3, t4;
@@ -119,63 +209,70 @@ void ge_add_c(ge p3, const ge p1, const ge p2)
     We would manage this by multiplying 2^21 values with 2^24 values
     (because 21 + 24 ≤ 45), but for example 2^23 * 2^23 is *forbidden* as it
     may overflow (23 + 23 > 45).
+
+    Every `fe12_bound(v, c, e)` below states that |v| ≤ c * 2^e. In a
+    `CURVE13318_CHECK_BOUNDS` build, these claims are checked (see
+    `fe12_bounds.h`).
     */
 
     /*   #: Instruction number as mentioned in the paper */
               // Assume forall x in {x, y, z} : |x| ≤ 1.01 * 2^21
-              fe12_mul(t0, x1, x2); // |t0| ≤ 1.68 * 2^49
-              fe12_mul(t1, y1, y2); // |t1| ≤ 1.68 * 2^49
-              fe12_mul(t2, z1, z2); // |t2| ≤ 1.68 * 2^49
-              fe12_add(t3, x1, y1); // |t3| ≤ 1.01 * 2^22
-    /*  5 */  fe12_add(t4, x2, y2); // |t4| ≤ 1.01 * 2^22
-              fe12_mul(t3, t3, t4); // |t3| ≤ 1.68 * 2^51
-              fe12_add(t4, t0, t1); // |t4| ≤ 1.68 * 2^50
-              fe12_sub(t3, t3, t4); // |t3| ≤ 1.26 * 2^52
-              fe12_add(t4, y1, z1); // |t4| ≤ 1.01 * 2^22
-    /* 10 */  fe12_add(x3, y2, z2); // |x3| ≤ 1.01 * 2^22
-              fe12_mul(t4, t4, x3); // |t4| ≤ 1.01 * 2^23
-              fe12_add(x3, t1, t2); // |x3| ≤ 1.26 * 2^51
-              fe12_sub(t4, t4, x3); // |t4| ≤ 1.27 * 2^51
-              fe12_add(x3, x1, z1); // |x3| ≤ 1.01 * 2^22
-    /* 15 */  fe12_add(y3, x2, z2); // |y3| ≤ 1.01 * 2^22
-              fe12_mul(x3, x3, y3); // |x3| ≤ 1.68 * 2^51
-              fe12_add(y3, t0, t2); // |y3| ≤ 1.68 * 2^50
-              fe12_sub(y3, x3, y3); // |y3| ≤ 1.26 * 2^52
+              fe12_bound(x1, 1.01, 21); fe12_bound(y1, 1.01, 21);
+              fe12_bound(z1, 1.01, 21); fe12_bound(x2, 1.01, 21);
+              fe12_bound(y2, 1.01, 21); fe12_bound(z2, 1.01, 21);
+              fe12_mul(t0, x1, x2); fe12_bound(t0, 1.68, 49);
+              fe12_mul(t1, y1, y2); fe12_bound(t1, 1.68, 49);
+              fe12_mul(t2, z1, z2); fe12_bound(t2, 1.68, 49);
+              fe12_add(t3, x1, y1); fe12_bound(t3, 1.01, 22);
+    /*  5 */  fe12_add(t4, x2, y2); fe12_bound(t4, 1.01, 22);
+              fe12_mul(t3, t3, t4); fe12_bound(t3, 1.68, 51);
+              fe12_add(t4, t0, t1); fe12_bound(t4, 1.68, 50);
+              fe12_sub(t3, t3, t4); fe12_bound(t3, 1.26, 52);
+              fe12_add(t4, y1, z1); fe12_bound(t4, 1.01, 22);
+    /* 10 */  fe12_add(x3, y2, z2); fe12_bound(x3, 1.01, 22);
+              fe12_mul(t4, t4, x3); fe12_bound(t4, 1.68, 51);
+              fe12_add(x3, t1, t2); fe12_bound(x3, 1.26, 51);
+              fe12_sub(t4, t4, x3); fe12_bound(t4, 1.47, 52);
+              fe12_add(x3, x1, z1); fe12_bound(x3, 1.01, 22);
+    /* 15 */  fe12_add(y3, x2, z2); fe12_bound(y3, 1.01, 22);
+              fe12_mul(x3, x3, y3); fe12_bound(x3, 1.68, 51);
+              fe12_add(y3, t0, t2); fe12_bound(y3, 1.68, 50);
+              fe12_sub(y3, x3, y3); fe12_bound(y3, 1.26, 52);
     /* __ */  fe12_squeeze(y3);     // squeeze |y3| ≤ 1.01 * 2^21
-    /* __ */  fe12_squeeze(t0);     // squeeze |t1| ≤ 1.01 * 2^21
+    /* __ */  fe12_squeeze(t0);     // squeeze |t0| ≤ 1.01 * 2^21
     /* __ */  fe12_squeeze(t1);     // squeeze |t1| ≤ 1.01 * 2^21
     /* __ */  fe12_squeeze(t2);     // squeeze |t2| ≤ 1.01 * 2^21
-              fe12_mul_b(z3, t2);   // |z3| ≤ 1.65 * 2^34
-    /* 20 */  fe12_sub(x3, y3, z3); // |x3| ≤ 1.66 * 2^34
-              fe12_add(z3, x3, x3); // |z3| ≤ 1.66 * 2^35
-              fe12_add(x3, x3, z3); // |x3| ≤ 1.25 * 2^36
-              fe12_sub(z3, t1, x3); // |z3| ≤ 1.26 * 36
-              fe12_add(x3, t1, x3); // |x3| ≤ 1.26 * 36
-    /* 25 */  fe12_mul_b(y3, y3);   // |y3| ≤ 1.65 * 2^34
-              fe12_add(t1, t2, t2); // |t1| ≤ 1.01 * 2^22
-              fe12_add(t2, t1, t2); // |t2| ≤ 1.52 * 2^22
-              fe12_sub(y3, y3, t2); // |y3| ≤ 1.66 * 2^34
-              fe12_sub(y3, y3, t0); // |y3| ≤ 1.67 * 2^34
-    /* 30 */  fe12_add(t1, y3, y3); // |t1| ≤ 1.67 * 2^35
-              fe12_add(y3, t1, y3); // |y3| ≤ 1.26 * 2^36
-              fe12_add(t1, t0, t0); // |t1| ≤ 1.01 * 2^22
-              fe12_add(t0, t1, t0); // |t0| ≤ 1.52 * 2^22
-              fe12_sub(t0, t0, t2); // |t0| ≤ 1.52 * 2^23
+              fe12_mul_b(z3, t2);   fe12_bound(z3, 1.65, 34);
+    /* 20 */  fe12_sub(x3, y3, z3); fe12_bound(x3, 1.66, 34);
+              fe12_add(z3, x3, x3); fe12_bound(z3, 1.66, 35);
+              fe12_add(x3, x3, z3); fe12_bound(x3, 1.25, 36);
+              fe12_sub(z3, t1, x3); fe12_bound(z3, 1.26, 36);
+              fe12_add(x3, t1, x3); fe12_bound(x3, 1.26, 36);
+    /* 25 */  fe12_mul_b(y3, y3);   fe12_bound(y3, 1.65, 34);
+              fe12_add(t1, t2, t2); fe12_bound(t1, 1.01, 22);
+              fe12_add(t2, t1, t2); fe12_bound(t2, 1.52, 22);
+              fe12_sub(y3, y3, t2); fe12_bound(y3, 1.66, 34);
+              fe12_sub(y3, y3, t0); fe12_bound(y3, 1.67, 34);
+    /* 30 */  fe12_add(t1, y3, y3); fe12_bound(t1, 1.67, 35);
+              fe12_add(y3, t1, y3); fe12_bound(y3, 1.26, 36);
+              fe12_add(t1, t0, t0); fe12_bound(t1, 1.01, 22);
+              fe12_add(t0, t1, t0); fe12_bound(t0, 1.52, 22);
+              fe12_sub(t0, t0, t2); fe12_bound(t0, 1.52, 23);
     /* __ */  fe12_squeeze(t4);     // squeeze |t4| ≤ 1.01 * 2^21
     /* __ */  fe12_squeeze(x3);     // squeeze |x3| ≤ 1.01 * 2^21
     /* __ */  fe12_squeeze(y3);     // squeeze |y3| ≤ 1.01 * 2^21
     /* __ */  fe12_squeeze(z3);     // squeeze |z3| ≤ 1.01 * 2^21
-    /* __ */  fe12_squeeze(t0);     // squeeze |z3| ≤ 1.01 * 2^21
-    /* 35 */  fe12_mul(t1, t4, y3); // |t1| ≤ 1.68 * 2^49
-              fe12_mul(t2, t0, y3); // |t2| ≤ 1.26 * 2^52
-              fe12_mul(y3, x3, z3); // |y3| ≤ 1.68 * 2^49
+    /* __ */  fe12_squeeze(t0);     // squeeze |t0| ≤ 1.01 * 2^21
+    /* 35 */  fe12_mul(t1, t4, y3); fe12_bound(t1, 1.68, 49);
+              fe12_mul(t2, t0, y3); fe12_bound(t2, 1.26, 52);
+              fe12_mul(y3, x3, z3); fe12_bound(y3, 1.68, 49);
     /* __ */  fe12_squeeze(t3);     // squeeze |t3| ≤ 1.01 * 2^21
-              fe12_add(y3, y3, t2); // |y3| ≤ 1.47 * 2^52
-              fe12_mul(x3, x3, t3); // |x3| ≤ 1.68 * 2^49
-    /* 40 */  fe12_sub(x3, x3, t1); // |x3| ≤ 1.68 * 2^50
-              fe12_mul(z3, z3, t4); // |z3| ≤ 1.68 * 2^49
-              fe12_mul(t1, t3, t0); // |t1| ≤ 1.68 * 2^49
-              fe12_add(z3, z3, t1); // |z3| ≤ 1.68 * 2^50
+              fe12_add(y3, y3, t2); fe12_bound(y3, 1.47, 52);
+              fe12_mul(x3, x3, t3); fe12_bound(x3, 1.68, 49);
+    /* 40 */  fe12_sub(x3, x3, t1); fe12_bound(x3, 1.68, 50);
+              fe12_mul(z3, z3, t4); fe12_bound(z3, 1.68, 49);
+              fe12_mul(t1, t3, t0); fe12_bound(t1, 1.68, 49);
+              fe12_add(z3, z3, t1); fe12_bound(z3, 1.68, 50);
 
     // Squeeze x3..z3 for next time
     fe12_squeeze(x3);
@@ -201,51 +298,53 @@ void ge_double_c(ge p3, const ge p)
     0.98 * 2^53 * 2^k.
     */
     /*   #: Instruction number as mentioned in the paper */
-              // Assume forall x in {x1, z1, y1, y2, x2, z2} : |x| ≤ 1.01 * 2^21
-              fe12_square(t0, x);   // |t0| ≤ 1.68 * 2^49
-              fe12_square(t1, y);   // |t1| ≤ 1.68 * 2^49
-              fe12_square(t2, z);   // |t2| ≤ 1.68 * 2^49
-              fe12_mul(t3, x, y);   // |t3| ≤ 1.68 * 2^49
-    /*  5 */  fe12_add(t3, t3, t3); // |t3| ≤ 1.68 * 2^50
+              // Assume forall x in {x, y, z} : |x| ≤ 1.01 * 2^21
+              fe12_bound(x, 1.01, 21); fe12_bound(y, 1.01, 21);
+              fe12_bound(z, 1.01, 21);
+              fe12_square(t0, x);   fe12_bound(t0, 1.68, 49);
+              fe12_square(t1, y);   fe12_bound(t1, 1.68, 49);
+              fe12_square(t2, z);   fe12_bound(t2, 1.68, 49);
+              fe12_mul(t3, x, y);   fe12_bound(t3, 1.68, 49);
+    /*  5 */  fe12_add(t3, t3, t3); fe12_bound(t3, 1.68, 50);
     /* __ */  fe12_squeeze(t2);     // squeeze |t2| ≤ 1.01 * 2^21
-    /* __ */  fe12_squeeze(t3);     // squeeze |t2| ≤ 1.01 * 2^21
-              fe12_mul(z3, x, z);   // |z3| ≤ 1.68 * 2^49
-              fe12_add(z3, z3, z3); // |z3| ≤ 1.68 * 2^50
-              fe12_mul_b(y3, t2);   // |y3| ≤ 1.65 * 2^34
-              fe12_sub(y3, y3, z3); // |y3| ≤ 1.69 * 2^50
-    /* 10 */  fe12_add(x3, y3, y3); // |x3| ≤ 1.69 * 2^51
-              fe12_add(y3, x3, y3); // |y3| ≤ 1.27 * 2^52
-              fe12_sub(x3, t1, y3); // |x3| ≤ 1.48 * 2^52
-              fe12_add(y3, t1, y3); // |y3| ≤ 1.48 * 2^52
+    /* __ */  fe12_squeeze(t3);     // squeeze |t3| ≤ 1.01 * 2^21
+              fe12_mul(z3, x, z);   fe12_bound(z3, 1.68, 49);
+              fe12_add(z3, z3, z3); fe12_bound(z3, 1.68, 50);
+              fe12_mul_b(y3, t2);   fe12_bound(y3, 1.65, 34);
+              fe12_sub(y3, y3, z3); fe12_bound(y3, 1.69, 50);
+    /* 10 */  fe12_add(x3, y3, y3); fe12_bound(x3, 1.69, 51);
+              fe12_add(y3, x3, y3); fe12_bound(y3, 1.27, 52);
+              fe12_sub(x3, t1, y3); fe12_bound(x3, 1.48, 52);
+              fe12_add(y3, t1, y3); fe12_bound(y3, 1.48, 52);
     /* __ */  fe12_squeeze(x3);     // squeeze |x3| ≤ 1.01 * 2^21
     /* __ */  fe12_squeeze(y3);     // squeeze |y3| ≤ 1.01 * 2^21
     /* __ */  fe12_squeeze(z3);     // squeeze |z3| ≤ 1.01 * 2^21
-              fe12_mul(y3, x3, y3); // |y3| ≤ 1.01 * 2^21
-    /* 15 */  fe12_mul(x3, x3, t3); // |x3| ≤ 1.01 * 2^21
-              fe12_add(t3, t2, t2); // |t3| ≤ 1.01 * 2^22
-              fe12_add(t2, t2, t3); // |t3| ≤ 1.52 * 2^22
-              fe12_mul_b(z3, z3);   // |z3| ≤ 1.65 * 2^34
-              fe12_sub(z3, z3, t2); // |z3| ≤ 1.66 * 2^34
-    /* 20 */  fe12_sub(z3, z3, t0); // |z3| ≤ 1.69 * 2^49
-              fe12_add(t3, z3, z3); // |t3| ≤ 1.69 * 2^50
-              fe12_add(z3, z3, t3); // |z3| ≤ 1.27 * 2^51
-              fe12_add(t3, t0, t0); // |t3| ≤ 1.68 * 2^50
-              fe12_add(t0, t3, t0); // |t0| ≤ 1.26 * 2^51
-    /* 25 */  fe12_sub(t0, t0, t2); // |t0| ≤ 1.27 * 2^51
+              fe12_mul(y3, x3, y3); fe12_bound(y3, 1.68, 49);
+    /* 15 */  fe12_mul(x3, x3, t3); fe12_bound(x3, 1.68, 49);
+              fe12_add(t3, t2, t2); fe12_bound(t3, 1.01, 22);
+              fe12_add(t2, t2, t3); fe12_bound(t2, 1.52, 22);
+              fe12_mul_b(z3, z3);   fe12_bound(z3, 1.65, 34);
+              fe12_sub(z3, z3, t2); fe12_bound(z3, 1.66, 34);
+    /* 20 */  fe12_sub(z3, z3, t0); fe12_bound(z3, 1.69, 49);
+              fe12_add(t3, z3, z3); fe12_bound(t3, 1.69, 50);
+              fe12_add(z3, z3, t3); fe12_bound(z3, 1.27, 51);
+              fe12_add(t3, t0, t0); fe12_bound(t3, 1.68, 50);
+              fe12_add(t0, t3, t0); fe12_bound(t0, 1.26, 51);
+    /* 25 */  fe12_sub(t0, t0, t2); fe12_bound(t0, 1.27, 51);
     /* __ */  fe12_squeeze(t0);     // squeeze |t0| ≤ 1.01 * 2^21
     /* __ */  fe12_squeeze(z3);     // squeeze |z3| ≤ 1.01 * 2^21
-              fe12_mul(t0, t0, z3); // |t0| ≤ 1.68 * 2^49
-              fe12_add(y3, y3, t0); // |y3| ≤ 1.69 * 2^49
-              fe12_mul(t0, y, z);   // |t0| ≤ 1.68 * 2^49
-              fe12_add(t0, t0, t0); // |t0| ≤ 1.68 * 2^50
+              fe12_mul(t0, t0, z3); fe12_bound(t0, 1.68, 49);
+              fe12_add(y3, y3, t0); fe12_bound(y3, 1.68, 50);
+              fe12_mul(t0, y, z);   fe12_bound(t0, 1.68, 49);
+              fe12_add(t0, t0, t0); fe12_bound(t0, 1.68, 50);
     /* __ */  fe12_squeeze(t0);     // squeeze |t0| ≤ 1.01 * 2^21
-    /* 30 */  fe12_mul(z3, t0, z3); // |z3| ≤ 1.68 * 2^50
-              fe12_sub(x3, x3, z3); // |x3| ≤ 1.69 * 2^50
+    /* 30 */  fe12_mul(z3, t0, z3); fe12_bound(z3, 1.68, 49);
+              fe12_sub(x3, x3, z3); fe12_bound(x3, 1.68, 50);
     /* __ */  fe12_squeeze(t0);     // squeeze |t0| ≤ 1.01 * 2^21
     /* __ */  fe12_squeeze(t1);     // squeeze |t1| ≤ 1.01 * 2^21
-              fe12_mul(z3, t0, t1); // |z3| ≤ 1.68 * 2^49
-              fe12_add(z3, z3, z3); // |z3| ≤ 1.68 * 2^50
-              fe12_add(z3, z3, z3); // |z3| ≤ 1.68 * 2^51
+              fe12_mul(z3, t0, t1); fe12_bound(z3, 1.68, 49);
+              fe12_add(z3, z3, z3); fe12_bound(z3, 1.68, 50);
+              fe12_add(z3, z3, z3); fe12_bound(z3, 1.68, 51);
 
     // Squeeze x3 and z3, otherwise we will get into trouble during the next
     // Addition/doubling
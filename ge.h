@@ -9,19 +9,79 @@ point on E is represented by its projective coordinates, i.e. (X : Y : Z).
 #define CURVE13318_REF12_GE_H_
 
 #include "fe12.h"
+#include "fe12x4.h"
 #include "fe10.h"
+#include "fe51.h"
+#include <stddef.h>
 
 typedef fe12 ge[3];
 
+/*
+The interleaved layout of a group element, which is used throughout the
+intrinsics ladder (ladder_intrin.c)
+
+Every limb is stored in a single ymm word as [x + z, x, y, z]. In this layout
+the operands of the first multiplications of the addition and the doubling can
+be loaded straight into the fe12x4 lanes. Only the addition reads the x + z
+lane, so the ladder only keeps it up to date where it is needed. Values of this
+type must be aligned to 32 bytes.
+*/
+typedef double ge_interleaved[12][4];
+
+/*
+The packed version of the interleaved layout, for lookup tables
+
+Every ymm word holds the sum of two consecutive limbs, i.e. `p[i]` is
+`src[2*i] + src[2*i + 1]`. For squeezed limbs that sum is an integer of at
+most 45 bits times 2^k (k the offset of limb 2*i), so it is exact. A packed
+point is half as big as an interleaved one, so scanning a table of them for a
+constant time lookup needs half as many loads. Values of this type must be
+aligned to 32 bytes.
+*/
+typedef double ge_interleaved_packed[6][4];
+
+/*
+Four independent group elements, one per ymm lane
+
+Every coordinate is an fe12x4, so `p[c][i][lane]` is limb `i` of coordinate
+`c` (x, y or z) of the point in `lane`. In this layout every field operation
+of the addition formulas works on four points at once, so there is no need to
+find independent multiplications within a single formula. Values of this type
+must be aligned to 32 bytes.
+*/
+typedef fe12x4 ge_x4[3];
+
 #define ge_neutral crypto_scalarmult_curve13318_ref12_ge_neutral
 #define ge_copy crypto_scalarmult_curve13318_ref12_ge_copy
 #define ge_cneg crypto_scalarmult_curve13318_ref12_ge_cneg
 #define ge_frombytes crypto_scalarmult_curve13318_ref12_ge_frombytes
 #define ge_tobytes crypto_scalarmult_curve13318_ref12_ge_tobytes
+#define ge_tobytes2 crypto_scalarmult_curve13318_ref12_ge_tobytes2
 #define ge_add_c crypto_scalarmult_curve13318_ref12_ge_add_c
 #define ge_add crypto_scalarmult_curve13318_ref12_ge_add
 #define ge_double crypto_scalarmult_curve13318_ref12_ge_double
 #define ge_double_c crypto_scalarmult_curve13318_ref12_ge_double_c
+#define ge_add_sse2 crypto_scalarmult_curve13318_ref12_ge_add_sse2
+#define ge_double_sse2 crypto_scalarmult_curve13318_ref12_ge_double_sse2
+#define ge_select_sse2 crypto_scalarmult_curve13318_ref12_ge_select_sse2
+#define ge_add_intrin crypto_scalarmult_curve13318_ref12_ge_add_intrin
+#define ge_double_intrin crypto_scalarmult_curve13318_ref12_ge_double_intrin
+#define ge_add_gen crypto_scalarmult_curve13318_ref12_ge_add_gen
+#define ge_double_gen crypto_scalarmult_curve13318_ref12_ge_double_gen
+#define ge_interleave crypto_scalarmult_curve13318_ref12_ge_interleave
+#define ge_deinterleave crypto_scalarmult_curve13318_ref12_ge_deinterleave
+#define ge_interleaved_pack crypto_scalarmult_curve13318_ref12_ge_interleaved_pack
+#define select_intrin crypto_scalarmult_curve13318_ref12_select_intrin
+#define select_packed_intrin crypto_scalarmult_curve13318_ref12_select_packed_intrin
+#define ge_x4_load crypto_scalarmult_curve13318_ref12_ge_x4_load
+#define ge_x4_store crypto_scalarmult_curve13318_ref12_ge_x4_store
+#define ge_x4_load_interleaved crypto_scalarmult_curve13318_ref12_ge_x4_load_interleaved
+#define ge_x4_store_interleaved crypto_scalarmult_curve13318_ref12_ge_x4_store_interleaved
+#define ge_add_x4 crypto_scalarmult_curve13318_ref12_ge_add_x4
+#define ge_double_x4 crypto_scalarmult_curve13318_ref12_ge_double_x4
+#define ge_x4_select crypto_scalarmult_curve13318_ref12_ge_x4_select
+#define ge_x4_select_lanes crypto_scalarmult_curve13318_ref12_ge_x4_select_lanes
+#define ge_tobytes_batch crypto_scalarmult_curve13318_ref12_ge_tobytes_batch
 
 /*
 Write all zeros to p
@@ -62,7 +122,84 @@ static inline void ge_cneg(ge point, uint8_t c) {
 }
 
 /*
-Parse a bytestring into a point on the curve
+Convert a ge value to the interleaved layout
+*/
+static inline void ge_interleave(ge_interleaved dest, const ge src) {
+    for (unsigned int i = 0; i < 12; i++) {
+        dest[i][0] = src[0][i] + src[2][i];
+        dest[i][1] = src[0][i];
+        dest[i][2] = src[1][i];
+        dest[i][3] = src[2][i];
+    }
+}
+
+/*
+Convert a ge value from the interleaved layout back to a normal ge value
+*/
+static inline void ge_deinterleave(ge dest, const ge_interleaved src) {
+    for (unsigned int i = 0; i < 12; i++) {
+        dest[0][i] = src[i][1];
+        dest[1][i] = src[i][2];
+        dest[2][i] = src[i][3];
+    }
+}
+
+/*
+Convert a value in the interleaved layout to the packed layout
+*/
+static inline void ge_interleaved_pack(ge_interleaved_packed dest, const ge_interleaved src) {
+    for (unsigned int i = 0; i < 6; i++) {
+        for (unsigned int j = 0; j < 4; j++) dest[i][j] = src[2*i][j] + src[2*i + 1][j];
+    }
+}
+
+/*
+Transpose four ge values into the lanes of a ge_x4 value
+*/
+static inline void ge_x4_load(ge_x4 dest, const ge points[4]) {
+    for (unsigned int c = 0; c < 3; c++) {
+        fe12x4_load(dest[c], points[0][c], points[1][c], points[2][c], points[3][c]);
+    }
+}
+
+/*
+Transpose the lanes of a ge_x4 value back into four ge values
+*/
+static inline void ge_x4_store(ge points[4], const ge_x4 src) {
+    for (unsigned int c = 0; c < 3; c++) {
+        fe12x4_store(points[0][c], points[1][c], points[2][c], points[3][c], src[c]);
+    }
+}
+
+/*
+Transpose four interleaved values into the lanes of a ge_x4 value
+*/
+static inline void ge_x4_load_interleaved(ge_x4 dest, const ge_interleaved points[4]) {
+    for (unsigned int c = 0; c < 3; c++) {
+        for (unsigned int i = 0; i < 12; i++) {
+            for (unsigned int lane = 0; lane < 4; lane++) dest[c][i][lane] = points[lane][i][c + 1];
+        }
+    }
+}
+
+/*
+Transpose the lanes of a ge_x4 value back into four interleaved values
+*/
+static inline void ge_x4_store_interleaved(ge_interleaved points[4], const ge_x4 src) {
+    for (unsigned int lane = 0; lane < 4; lane++) {
+        for (unsigned int i = 0; i < 12; i++) {
+            points[lane][i][0] = src[0][i][lane] + src[2][i][lane];
+            points[lane][i][1] = src[0][i][lane];
+            points[lane][i][2] = src[1][i][lane];
+            points[lane][i][3] = src[2][i][lane];
+        }
+    }
+}
+
+/*
+Parse a bytestring into a point on the curve. Coordinates that are not
+reduced, including ones with the 255'th bit set, are reduced modulo p. The
+curve equation is checked in radix 2^51, straight from the bytes.
 
 Arguments:
   - point   Output point
@@ -83,6 +220,30 @@ Returns:
 */
 void ge_tobytes(uint8_t *bytes, ge point);
 
+/*
+Same as calling `ge_tobytes` on two points, but with only one field inversion
+for both of them
+
+Arguments:
+  - bytes_1   Output bytes for `point_1`
+  - bytes_2   Output bytes for `point_2`
+  - point_1   First input point
+  - point_2   Second input point
+*/
+void ge_tobytes2(uint8_t *bytes_1, uint8_t *bytes_2, ge point_1, ge point_2);
+
+/*
+Same as calling `ge_tobytes` on `len` points, but with only one field
+inversion for all of them (Montgomery's trick, like `ge_tobytes2`)
+
+Arguments:
+  - bytes     Output bytes, one 64-byte encoding per point
+  - points    Input points
+  - scratch   Space for `len` fe51 values (the running products of the z's)
+  - len       Number of points
+*/
+void ge_tobytes_batch(uint8_t (*bytes)[64], const ge *points, fe51 *scratch, size_t len);
+
 /*
 Add two `point_1` and `point_2` into `dest`.
 */
@@ -93,4 +254,78 @@ Double `point` into `dest`.
 */
 void ge_double(ge dest, const ge point);
 
+/*
+Same as `ge_add` and `ge_double`, but using the macros that `gen_ge.py`
+generated from `ge_add.formula` and `ge_double.formula`. These are the macros
+that the NASM ladder uses.
+*/
+void ge_add_gen(ge dest, const ge point_1, const ge point_2);
+void ge_double_gen(ge dest, const ge point);
+
+/*
+Same as `ge_add` and `ge_double`, but in plain C using the scalar fe12 ops.
+*/
+void ge_add_c(ge dest, const ge point_1, const ge point_2);
+void ge_double_c(ge dest, const ge point);
+
+/*
+Same as `ge_add_c` and `ge_double_c`, but doing two multiplications at a time
+with the SSE2 fe12x2 kernels. These do not need AVX.
+*/
+void ge_add_sse2(ge dest, const ge point_1, const ge point_2);
+void ge_double_sse2(ge dest, const ge point);
+
+/*
+Constant time table lookup with the same indexing as `select`: `dest` becomes
+`ptable[idx]` for idx < 16, and the neutral element otherwise.
+*/
+void ge_select_sse2(ge dest, uint8_t idx, const ge ptable[16]);
+
+/*
+Same as `ge_add` and `ge_double`, but with the AVX intrinsics version of the
+macros (ladder_intrin.c). These compute exactly the same values as the
+assembly. Only use these functions on CPUs that support AVX.
+*/
+void ge_add_intrin(ge dest, const ge point_1, const ge point_2);
+void ge_double_intrin(ge dest, const ge point);
+
+/*
+Constant time table lookups in the interleaved layout, like the `select`
+macro: `dest` becomes `ptable[idx]` for idx < 16, and the neutral element for
+idx == 31. `select_packed_intrin` scans a packed table, and unpacks only the
+selected point. Its limbs can differ from the ones that were packed, but they
+represent the same values (see `ladder_intrin.c`). Only use these functions
+on CPUs that support AVX.
+*/
+void select_intrin(ge_interleaved dest, uint8_t idx, const ge_interleaved ptable[16]);
+void select_packed_intrin(ge_interleaved dest, uint8_t idx,
+                          const ge_interleaved_packed ptable[16]);
+
+/*
+Add or double four independent points at once (ge_x4.c). Lane i of `dest` is
+the sum of lane i of `point_1` and `point_2`, or the double of lane i of
+`point`. They compute the same Renes-Costello-Batina formulas as `ge_add_c`
+and `ge_double_c`, and have the same preconditions per lane. The output is
+squeezed. `dest` may alias the inputs. Only use these functions on CPUs that
+support AVX.
+*/
+void ge_add_x4(ge_x4 dest, const ge_x4 point_1, const ge_x4 point_2);
+void ge_double_x4(ge_x4 dest, const ge_x4 point);
+
+/*
+Constant time table lookup with a different index per lane. Lane i of `dest`
+becomes `ptable[idx[i]]` (the neutral element if idx[i] >= 16), negated if
+sign[i] == 1, like `ge_select_sse2` followed by `ge_cneg`. Every lane reads
+the whole table. Only use this function on CPUs that support AVX.
+*/
+void ge_x4_select(ge_x4 dest, const uint8_t idx[4], const uint8_t sign[4],
+                  const ge ptable[16]);
+
+/*
+Same as `ge_x4_select`, but with a different table in every lane: lane i of
+`dest` becomes lane i of `ptable[idx[i]]`.
+*/
+void ge_x4_select_lanes(ge_x4 dest, const uint8_t idx[4], const uint8_t sign[4],
+                        const ge_x4 ptable[16]);
+
 #endif /* CURVE13318_REF12_GE_H_ */
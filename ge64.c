@@ -0,0 +1,179 @@
+#include "ge64.h"
+#include <stdbool.h>
+
+#define CURVE_B 13318
+
+static bool ge64_affine_point_on_curve(const ge64 p)
+{
+    // y^2 = x^3 - 3*x + 13318
+    fe64 lhs, rhs, t0;
+    fe64_square(lhs, p[1]);         // y^2
+    fe64_square(t0, p[0]);          // x^2
+    fe64_mul(rhs, t0, p[0]);        // x^3
+    fe64_mul_small(t0, p[0], 3);    // 3*x
+    fe64_sub(rhs, rhs, t0);         // x^3 - 3*x
+    fe64_zero(t0);
+    t0[0] = CURVE_B;
+    fe64_add(rhs, rhs, t0);         // x^3 - 3*x + 13318
+    fe64_sub(lhs, lhs, rhs);        // (==0) or (!=0) mod p
+    fe64_freeze(lhs);
+
+    uint64_t nonzero = 0;
+    for (unsigned int i = 0; i < 4; i++) nonzero |= lhs[i];
+    return nonzero == 0;
+}
+
+int ge64_frombytes(ge64 p, const uint8_t *s)
+{
+    fe64_frombytes(p[0], &s[0]);
+    fe64_frombytes(p[1], &s[32]);
+
+    // Handle point at infinity encoded by (0, 0)
+    uint64_t nonzero = 0;
+    for (unsigned int i = 0; i < 4; i++) nonzero |= p[0][i] | p[1][i];
+    const uint64_t infinity = nonzero == 0;
+
+    // Set y to 1 if we are at the point at infinity
+    p[1][0] |= infinity;
+    // Initialize z to 1 (or 0 if infinity)
+    fe64_zero(p[2]);
+    p[2][0] = !infinity;
+
+    // Check if this point is valid
+    if (!infinity & !ge64_affine_point_on_curve(p)) return -1;
+    return 0;
+}
+
+void ge64_tobytes(uint8_t *s, const ge64 p)
+{
+    // Like in `ge_tobytes`, the inverse of z = 0 is 0, so the neutral element
+    // is encoded as (0, 0)
+    fe64 x_affine, y_affine, z_inverse;
+    fe64_invert(z_inverse, p[2]);
+    fe64_mul(x_affine, p[0], z_inverse);
+    fe64_mul(y_affine, p[1], z_inverse);
+    fe64_tobytes(&s[ 0], x_affine);
+    fe64_tobytes(&s[32], y_affine);
+}
+
+void ge64_add(ge64 p3, const ge64 p1, const ge64 p2)
+{
+    fe64 x3, y3, z3, t0, t1, t2, t3, t4;
+    const uint64_t *x1 = p1[0], *y1 = p1[1], *z1 = p1[2];
+    const uint64_t *x2 = p2[0], *y2 = p2[1], *z2 = p2[2];
+
+    /*
+    This is *exactly* Algorithm 4 from the Renes-Costello-Batina addition
+    laws [Renes2016], in the same order as `ge_add_c`. Because every fe64
+    operation returns a value in [0, 2^256), there are no bounds to keep
+    track of.
+    */
+    /*   #: Instruction number as mentioned in the paper */
+              fe64_mul(t0, x1, x2);
+              fe64_mul(t1, y1, y2);
+              fe64_mul(t2, z1, z2);
+              fe64_add(t3, x1, y1);
+    /*  5 */  fe64_add(t4, x2, y2);
+              fe64_mul(t3, t3, t4);
+              fe64_add(t4, t0, t1);
+              fe64_sub(t3, t3, t4);
+              fe64_add(t4, y1, z1);
+    /* 10 */  fe64_add(x3, y2, z2);
+              fe64_mul(t4, t4, x3);
+              fe64_add(x3, t1, t2);
+              fe64_sub(t4, t4, x3);
+              fe64_add(x3, x1, z1);
+    /* 15 */  fe64_add(y3, x2, z2);
+              fe64_mul(x3, x3, y3);
+              fe64_add(y3, t0, t2);
+              fe64_sub(y3, x3, y3);
+              fe64_mul_small(z3, t2, CURVE_B);
+    /* 20 */  fe64_sub(x3, y3, z3);
+              fe64_add(z3, x3, x3);
+              fe64_add(x3, x3, z3);
+              fe64_sub(z3, t1, x3);
+              fe64_add(x3, t1, x3);
+    /* 25 */  fe64_mul_small(y3, y3, CURVE_B);
+              fe64_add(t1, t2, t2);
+              fe64_add(t2, t1, t2);
+              fe64_sub(y3, y3, t2);
+              fe64_sub(y3, y3, t0);
+    /* 30 */  fe64_add(t1, y3, y3);
+              fe64_add(y3, t1, y3);
+              fe64_add(t1, t0, t0);
+              fe64_add(t0, t1, t0);
+              fe64_sub(t0, t0, t2);
+    /* 35 */  fe64_mul(t1, t4, y3);
+              fe64_mul(t2, t0, y3);
+              fe64_mul(y3, x3, z3);
+              fe64_add(y3, y3, t2);
+              fe64_mul(x3, x3, t3);
+    /* 40 */  fe64_sub(x3, x3, t1);
+              fe64_mul(z3, z3, t4);
+              fe64_mul(t1, t3, t0);
+              fe64_add(z3, z3, t1);
+
+    fe64_copy(p3[0], x3);
+    fe64_copy(p3[1], y3);
+    fe64_copy(p3[2], z3);
+}
+
+void ge64_double(ge64 p3, const ge64 p)
+{
+    fe64 x3, y3, z3, t0, t1, t2, t3;
+    const uint64_t *x = p[0], *y = p[1], *z = p[2];
+
+    /*
+    Algorithm 6 from [Renes2016], in the same order as `ge_double_c`.
+    */
+    /*   #: Instruction number as mentioned in the paper */
+              fe64_square(t0, x);
+              fe64_square(t1, y);
+              fe64_square(t2, z);
+              fe64_mul(t3, x, y);
+    /*  5 */  fe64_add(t3, t3, t3);
+              fe64_mul(z3, x, z);
+              fe64_add(z3, z3, z3);
+              fe64_mul_small(y3, t2, CURVE_B);
+              fe64_sub(y3, y3, z3);
+    /* 10 */  fe64_add(x3, y3, y3);
+              fe64_add(y3, x3, y3);
+              fe64_sub(x3, t1, y3);
+              fe64_add(y3, t1, y3);
+              fe64_mul(y3, x3, y3);
+    /* 15 */  fe64_mul(x3, x3, t3);
+              fe64_add(t3, t2, t2);
+              fe64_add(t2, t2, t3);
+              fe64_mul_small(z3, z3, CURVE_B);
+              fe64_sub(z3, z3, t2);
+    /* 20 */  fe64_sub(z3, z3, t0);
+              fe64_add(t3, z3, z3);
+              fe64_add(z3, z3, t3);
+              fe64_add(t3, t0, t0);
+              fe64_add(t0, t3, t0);
+    /* 25 */  fe64_sub(t0, t0, t2);
+              fe64_mul(t0, t0, z3);
+              fe64_add(y3, y3, t0);
+              fe64_mul(t0, y, z);
+              fe64_add(t0, t0, t0);
+    /* 30 */  fe64_mul(z3, t0, z3);
+              fe64_sub(x3, x3, z3);
+              fe64_mul(z3, t0, t1);
+              fe64_add(z3, z3, z3);
+              fe64_add(z3, z3, z3);
+
+    fe64_copy(p3[0], x3);
+    fe64_copy(p3[1], y3);
+    fe64_copy(p3[2], z3);
+}
+
+void ge64_select(ge64 dest, uint8_t idx, const ge64 ptable[16])
+{
+    // Scan the whole table, so that the memory access pattern does not depend
+    // on `idx`
+    ge64_neutral(dest);
+    for (unsigned int i = 0; i < 16; i++) {
+        const uint64_t mask = -((((uint64_t)(idx ^ i)) - 1) >> 63);
+        ge64_cmov(dest, ptable[i], mask);
+    }
+}
@@ -0,0 +1,81 @@
+/*
+Group element in our curve E : y^2 = x^3 - 3*x + 13318, using fe64 coordinates
+
+This is the counterpart of `ge` for the mulx/adx backend. A point is again
+represented by its projective coordinates (X : Y : Z), so that the complete
+Renes-Costello-Batina formulas can be used.
+*/
+
+#ifndef CURVE13318_REF12_GE64_H_
+#define CURVE13318_REF12_GE64_H_
+
+#include "fe64.h"
+
+typedef fe64 ge64[3];
+
+#define ge64_frombytes crypto_scalarmult_curve13318_ref12_ge64_frombytes
+#define ge64_tobytes crypto_scalarmult_curve13318_ref12_ge64_tobytes
+#define ge64_add crypto_scalarmult_curve13318_ref12_ge64_add
+#define ge64_double crypto_scalarmult_curve13318_ref12_ge64_double
+#define ge64_select crypto_scalarmult_curve13318_ref12_ge64_select
+
+/*
+Write the neutral element (0 : 1 : 0) to point
+*/
+static inline void ge64_neutral(ge64 point) {
+    fe64_zero(point[0]);
+    fe64_one(point[1]);
+    fe64_zero(point[2]);
+}
+
+/*
+Copy a ge64 value to another ge64 value
+*/
+static inline void ge64_copy(ge64 dest, const ge64 src) {
+    fe64_copy(dest[0], src[0]);
+    fe64_copy(dest[1], src[1]);
+    fe64_copy(dest[2], src[2]);
+}
+
+/*
+Replace `dest` with `src` if `mask` is all ones, keep it if `mask` is zero
+*/
+static inline void ge64_cmov(ge64 dest, const ge64 src, uint64_t mask) {
+    fe64_cmov(dest[0], src[0], mask);
+    fe64_cmov(dest[1], src[1], mask);
+    fe64_cmov(dest[2], src[2], mask);
+}
+
+/*
+Parse a bytestring into a point on the curve
+
+Arguments:
+  - point   Output point
+  - bytes   Input bytes
+Returns:
+  0 on succes, nonzero on failure
+*/
+int ge64_frombytes(ge64 point, const uint8_t *bytes);
+
+/*
+Convert a projective point on the curve to its byte representation
+*/
+void ge64_tobytes(uint8_t *bytes, const ge64 point);
+
+/*
+Add two `point_1` and `point_2` into `dest`.
+*/
+void ge64_add(ge64 dest, const ge64 point_1, const ge64 point_2);
+
+/*
+Double `point` into `dest`.
+*/
+void ge64_double(ge64 dest, const ge64 point);
+
+/*
+Constant time table lookup with the same indexing as the fe12 `select`:
+`dest` becomes `ptable[idx]` for idx < 16, and the neutral element otherwise.
+*/
+void ge64_select(ge64 dest, uint8_t idx, const ge64 ptable[16]);
+
+#endif /* CURVE13318_REF12_GE64_H_ */
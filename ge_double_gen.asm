@@ -0,0 +1,30 @@
+; Doubling of group elements, using the generated `ge_double_gen` macro
+;
+; Author: Daan Sprenkels <hello@dsprenkels.com>
+
+%include "ge_double_gen.mac"
+
+global crypto_scalarmult_curve13318_ref12_ge_double_gen
+
+section .text
+crypto_scalarmult_curve13318_ref12_ge_double_gen:
+    ; Same API as `crypto_scalarmult_curve13318_ref12_ge_double`.
+    %xdefine stack_size ge_double_gen_scratch_size
+
+    ; build stack frame
+    push rbp
+    mov rbp, rsp
+    and rsp, -32
+    sub rsp, stack_size
+
+    ge_double_gen rdi, rsi, rsp
+
+    ; restore stack frame
+    mov rsp, rbp
+    pop rbp
+    ret
+
+section .rodata
+fe12x4_mul_consts
+fe12x4_squeeze_consts
+ge_double_gen_consts
@@ -0,0 +1,151 @@
+#include "fe12x2.h"
+#include "ge.h"
+#include <emmintrin.h>
+
+/*
+The group operations for the SSE2 backend. They do exactly the same as
+`ge_add_c` and `ge_double_c`, so all the bounds in those functions hold here
+too. The only difference is that independent multiplications and squeezes are
+done in pairs, with the two-lane fe12x2 kernels.
+*/
+
+void ge_add_sse2(ge p3, const ge p1, const ge p2)
+{
+    fe12 x1, y1, z1, x2, y2, z2, x3, y3, z3, t0, t1, t2, t3, t4, u0, u1;
+    fe12_copy(x1, p1[0]);
+    fe12_copy(y1, p1[1]);
+    fe12_copy(z1, p1[2]);
+    fe12_copy(x2, p2[0]);
+    fe12_copy(y2, p2[1]);
+    fe12_copy(z2, p2[2]);
+
+    /*   #: Instruction number as mentioned in the paper */
+    /*  4 */  fe12_add(t3, x1, y1);
+    /*  5 */  fe12_add(t4, x2, y2);
+    /*  9 */  fe12_add(u0, y1, z1);
+    /* 10 */  fe12_add(x3, y2, z2);
+    /* 14 */  fe12_add(u1, x1, z1);
+    /* 15 */  fe12_add(y3, x2, z2);
+    /* 1,2 */ fe12x2_mul(t0, x1, x2, t1, y1, y2);
+    /* 3,6 */ fe12x2_mul(t2, z1, z2, t3, t3, t4);
+    /* 11,16 */ fe12x2_mul(t4, u0, x3, x3, u1, y3);
+    /*  7 */  fe12_add(u0, t0, t1);
+    /*  8 */  fe12_sub(t3, t3, u0);
+    /* 12 */  fe12_add(u0, t1, t2);
+    /* 13 */  fe12_sub(t4, t4, u0);
+    /* 17 */  fe12_add(y3, t0, t2);
+    /* 18 */  fe12_sub(y3, x3, y3);
+    /* __ */  fe12x2_squeeze(y3, t0);
+    /* __ */  fe12x2_squeeze(t1, t2);
+    /* 19 */  fe12_mul_b(z3, t2);
+    /* 20 */  fe12_sub(x3, y3, z3);
+    /* 21 */  fe12_add(z3, x3, x3);
+    /* 22 */  fe12_add(x3, x3, z3);
+    /* 23 */  fe12_sub(z3, t1, x3);
+    /* 24 */  fe12_add(x3, t1, x3);
+    /* 25 */  fe12_mul_b(y3, y3);
+    /* 26 */  fe12_add(t1, t2, t2);
+    /* 27 */  fe12_add(t2, t1, t2);
+    /* 28 */  fe12_sub(y3, y3, t2);
+    /* 29 */  fe12_sub(y3, y3, t0);
+    /* 30 */  fe12_add(t1, y3, y3);
+    /* 31 */  fe12_add(y3, t1, y3);
+    /* 32 */  fe12_add(t1, t0, t0);
+    /* 33 */  fe12_add(t0, t1, t0);
+    /* 34 */  fe12_sub(t0, t0, t2);
+    /* __ */  fe12x2_squeeze(t4, x3);
+    /* __ */  fe12x2_squeeze(y3, z3);
+    /* __ */  fe12x2_squeeze(t0, t3);
+    /* 35,36 */ fe12x2_mul(t1, t4, y3, t2, t0, y3);
+    /* 37,39 */ fe12x2_mul(y3, x3, z3, x3, x3, t3);
+    /* 41,42 */ fe12x2_mul(z3, z3, t4, u0, t3, t0);
+    /* 38 */  fe12_add(y3, y3, t2);
+    /* 40 */  fe12_sub(x3, x3, t1);
+    /* 43 */  fe12_add(z3, z3, u0);
+
+    // Squeeze x3..z3 for next time
+    fe12x2_squeeze(x3, y3);
+    fe12_squeeze(z3);
+
+    fe12_copy(p3[0], x3);
+    fe12_copy(p3[1], y3);
+    fe12_copy(p3[2], z3);
+}
+
+void ge_double_sse2(ge p3, const ge p)
+{
+    fe12 x, y, z, x3, y3, z3, t0, t1, t2, t3, u0;
+    fe12_copy(x, p[0]);
+    fe12_copy(y, p[1]);
+    fe12_copy(z, p[2]);
+
+    /*   #: Instruction number as mentioned in the paper */
+    /* 1,2 */ fe12x2_mul(t0, x, x, t1, y, y);
+    /* 3,4 */ fe12x2_mul(t2, z, z, t3, x, y);
+    /* 6,28 */ fe12x2_mul(z3, x, z, u0, y, z);
+    /*  5 */  fe12_add(t3, t3, t3);
+    /* __ */  fe12x2_squeeze(t2, t3);
+    /*  7 */  fe12_add(z3, z3, z3);
+    /*  8 */  fe12_mul_b(y3, t2);
+    /*  9 */  fe12_sub(y3, y3, z3);
+    /* 10 */  fe12_add(x3, y3, y3);
+    /* 11 */  fe12_add(y3, x3, y3);
+    /* 12 */  fe12_sub(x3, t1, y3);
+    /* 13 */  fe12_add(y3, t1, y3);
+    /* 29 */  fe12_add(u0, u0, u0);
+    /* __ */  fe12x2_squeeze(x3, y3);
+    /* __ */  fe12x2_squeeze(z3, u0);
+    /* __ */  fe12_squeeze(t1);
+    /* 14,15 */ fe12x2_mul(y3, x3, y3, x3, x3, t3);
+    /* 16 */  fe12_add(t3, t2, t2);
+    /* 17 */  fe12_add(t2, t2, t3);
+    /* 18 */  fe12_mul_b(z3, z3);
+    /* 19 */  fe12_sub(z3, z3, t2);
+    /* 20 */  fe12_sub(z3, z3, t0);
+    /* 21 */  fe12_add(t3, z3, z3);
+    /* 22 */  fe12_add(z3, z3, t3);
+    /* 23 */  fe12_add(t3, t0, t0);
+    /* 24 */  fe12_add(t0, t3, t0);
+    /* 25 */  fe12_sub(t0, t0, t2);
+    /* __ */  fe12x2_squeeze(t0, z3);
+    /* 26,30 */ fe12x2_mul(t0, t0, z3, z3, u0, z3);
+    /* 32 */  fe12_mul(t1, u0, t1);
+    /* 27 */  fe12_add(y3, y3, t0);
+    /* 31 */  fe12_sub(x3, x3, z3);
+    /* 33 */  fe12_add(z3, t1, t1);
+    /* 34 */  fe12_add(z3, z3, z3);
+
+    // Squeeze x3..z3 for next time
+    fe12x2_squeeze(x3, y3);
+    fe12_squeeze(z3);
+
+    fe12_copy(p3[0], x3);
+    fe12_copy(p3[1], y3);
+    fe12_copy(p3[2], z3);
+}
+
+void ge_select_sse2(ge dest, uint8_t idx, const ge ptable[16])
+{
+    // Scan the whole table, so that the memory access pattern does not depend
+    // on `idx`. A ge value is 36 doubles, i.e. 18 xmm words.
+    __m128d acc[18];
+    for (unsigned int k = 0; k < 18; k++) acc[k] = _mm_setzero_pd();
+    for (unsigned int i = 0; i < 16; i++) {
+        const uint64_t mask = -((((uint64_t)(idx ^ i)) - 1) >> 63);
+        const __m128d maskv = _mm_castsi128_pd(_mm_set1_epi64x((int64_t)mask));
+        const double *src = &ptable[i][0][0];
+        for (unsigned int k = 0; k < 18; k++) {
+            acc[k] = _mm_or_pd(acc[k], _mm_and_pd(maskv, _mm_loadu_pd(&src[2*k])));
+        }
+    }
+    for (unsigned int k = 0; k < 18; k++) _mm_storeu_pd(&dest[0][0] + 2*k, acc[k]);
+
+    // Load the neutral element (0 : 1 : 0) if idx is not in the table
+    const uint64_t neutral = -(uint64_t)(idx >> 4);
+    union {
+        double d;
+        uint64_t u64;
+    } one = { .d = 1.0 }, y0 = { .d = dest[1][0] };
+    y0.u64 |= one.u64 & neutral;
+    dest[1][0] = y0.d;
+}
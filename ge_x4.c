@@ -0,0 +1,242 @@
+/*
+    Four independent point additions and doublings at once (see ge.h).
+
+    These are `ge_add_c` and `ge_double_c`, with every fe12 value replaced by
+    four of them in the lanes of a ymm word. Because the lanes hold different
+    points, every operation of the formulas is one fully used AVX operation,
+    regardless of how many independent multiplications the formulas have.
+
+    `fe12x4_mul_intrin` and `fe12x4_square_intrin` squeeze their products, so
+    every product is bounded by 1.01 * 2^21, which is a lot less than the
+    bounds in `ge_add_c` and `ge_double_c`. The squeezes of those functions
+    that only squeeze a product are left out; the others are kept, so all the
+    bounds that are annotated there hold here too. This file must be compiled
+    with AVX enabled.
+*/
+
+#include "fe12x4_intrin.h"
+#include "ge.h"
+
+typedef __m256d vec;
+
+static inline void load(vec dest[12], const fe12x4 src)
+{
+    for (unsigned int i = 0; i < 12; i++) dest[i] = _mm256_load_pd(src[i]);
+}
+
+static inline void store(fe12x4 dest, const vec src[12])
+{
+    for (unsigned int i = 0; i < 12; i++) _mm256_store_pd(dest[i], src[i]);
+}
+
+static inline void add(vec z[12], const vec lhs[12], const vec rhs[12])
+{
+    for (unsigned int i = 0; i < 12; i++) z[i] = _mm256_add_pd(lhs[i], rhs[i]);
+}
+
+static inline void sub(vec z[12], const vec lhs[12], const vec rhs[12])
+{
+    for (unsigned int i = 0; i < 12; i++) z[i] = _mm256_sub_pd(lhs[i], rhs[i]);
+}
+
+static inline void mul_b(vec h[12], const vec f[12])
+{
+    const vec b = _mm256_set1_pd(13318);
+    for (unsigned int i = 0; i < 12; i++) h[i] = _mm256_mul_pd(b, f[i]);
+}
+
+#define mul fe12x4_mul_intrin
+#define square fe12x4_square_intrin
+#define squeeze fe12x4_squeeze_intrin
+
+void ge_add_x4(ge_x4 p3, const ge_x4 p1, const ge_x4 p2)
+{
+    vec x1[12], y1[12], z1[12], x2[12], y2[12], z2[12];
+    vec x3[12], y3[12], z3[12], t0[12], t1[12], t2[12], t3[12], t4[12];
+    load(x1, p1[0]);
+    load(y1, p1[1]);
+    load(z1, p1[2]);
+    load(x2, p2[0]);
+    load(y2, p2[1]);
+    load(z2, p2[2]);
+
+    /*   #: Instruction number as mentioned in the paper */
+              mul(t0, x1, x2);
+              mul(t1, y1, y2);
+              mul(t2, z1, z2);
+              add(t3, x1, y1);
+    /*  5 */  add(t4, x2, y2);
+              mul(t3, t3, t4);
+              add(t4, t0, t1);
+              sub(t3, t3, t4);
+              add(t4, y1, z1);
+    /* 10 */  add(x3, y2, z2);
+              mul(t4, t4, x3);
+              add(x3, t1, t2);
+              sub(t4, t4, x3);
+              add(x3, x1, z1);
+    /* 15 */  add(y3, x2, z2);
+              mul(x3, x3, y3);
+              add(y3, t0, t2);
+              sub(y3, x3, y3);
+    /* __ */  squeeze(y3);
+              mul_b(z3, t2);
+    /* 20 */  sub(x3, y3, z3);
+              add(z3, x3, x3);
+              add(x3, x3, z3);
+              sub(z3, t1, x3);
+              add(x3, t1, x3);
+    /* 25 */  mul_b(y3, y3);
+              add(t1, t2, t2);
+              add(t2, t1, t2);
+              sub(y3, y3, t2);
+              sub(y3, y3, t0);
+    /* 30 */  add(t1, y3, y3);
+              add(y3, t1, y3);
+              add(t1, t0, t0);
+              add(t0, t1, t0);
+              sub(t0, t0, t2);
+    /* __ */  squeeze(t4);
+    /* __ */  squeeze(x3);
+    /* __ */  squeeze(y3);
+    /* __ */  squeeze(z3);
+    /* __ */  squeeze(t0);
+    /* 35 */  mul(t1, t4, y3);
+              mul(t2, t0, y3);
+              mul(y3, x3, z3);
+    /* __ */  squeeze(t3);
+              add(y3, y3, t2);
+              mul(x3, x3, t3);
+    /* 40 */  sub(x3, x3, t1);
+              mul(z3, z3, t4);
+              mul(t1, t3, t0);
+              add(z3, z3, t1);
+
+    // Squeeze x3..z3 for next time
+    squeeze(x3);
+    squeeze(y3);
+    squeeze(z3);
+
+    store(p3[0], x3);
+    store(p3[1], y3);
+    store(p3[2], z3);
+}
+
+void ge_double_x4(ge_x4 p3, const ge_x4 p)
+{
+    vec x[12], y[12], z[12], x3[12], y3[12], z3[12], t0[12], t1[12], t2[12], t3[12];
+    load(x, p[0]);
+    load(y, p[1]);
+    load(z, p[2]);
+
+    /*   #: Instruction number as mentioned in the paper */
+              square(t0, x);
+              square(t1, y);
+              square(t2, z);
+              mul(t3, x, y);
+    /*  5 */  add(t3, t3, t3);
+    /* __ */  squeeze(t3);
+              mul(z3, x, z);
+              add(z3, z3, z3);
+              mul_b(y3, t2);
+              sub(y3, y3, z3);
+    /* 10 */  add(x3, y3, y3);
+              add(y3, x3, y3);
+              sub(x3, t1, y3);
+              add(y3, t1, y3);
+    /* __ */  squeeze(x3);
+    /* __ */  squeeze(y3);
+    /* __ */  squeeze(z3);
+              mul(y3, x3, y3);
+    /* 15 */  mul(x3, x3, t3);
+              add(t3, t2, t2);
+              add(t2, t2, t3);
+              mul_b(z3, z3);
+              sub(z3, z3, t2);
+    /* 20 */  sub(z3, z3, t0);
+              add(t3, z3, z3);
+              add(z3, z3, t3);
+              add(t3, t0, t0);
+              add(t0, t3, t0);
+    /* 25 */  sub(t0, t0, t2);
+    /* __ */  squeeze(t0);
+    /* __ */  squeeze(z3);
+              mul(t0, t0, z3);
+              add(y3, y3, t0);
+              mul(t0, y, z);
+              add(t0, t0, t0);
+    /* __ */  squeeze(t0);
+    /* 30 */  mul(z3, t0, z3);
+              sub(x3, x3, z3);
+              mul(z3, t0, t1);
+              add(z3, z3, z3);
+              add(z3, z3, z3);
+
+    // Squeeze x3..z3 for next time
+    squeeze(x3);
+    squeeze(y3);
+    squeeze(z3);
+
+    store(p3[0], x3);
+    store(p3[1], y3);
+    store(p3[2], z3);
+}
+
+// Make the lanes with idx >= 16 (which are all zeros) the neutral element
+// (0 : 1 : 0), and negate y in the lanes with sign == 1, like `ge_cneg`
+static inline void finish_select(vec acc[3][12], const vec idx_v, const uint8_t sign[4])
+{
+    const vec neutral = _mm256_cmp_pd(idx_v, _mm256_set1_pd(16), _CMP_GE_OQ);
+    acc[1][0] = _mm256_or_pd(acc[1][0], _mm256_and_pd(neutral, _mm256_set1_pd(1)));
+
+    const vec factor = _mm256_set_pd(1 - 2 * (int)sign[3], 1 - 2 * (int)sign[2],
+                                     1 - 2 * (int)sign[1], 1 - 2 * (int)sign[0]);
+    for (unsigned int j = 0; j < 12; j++) acc[1][j] = _mm256_mul_pd(acc[1][j], factor);
+}
+
+void ge_x4_select(ge_x4 dest, const uint8_t idx[4], const uint8_t sign[4],
+                  const ge ptable[16])
+{
+    // The lanes have different indices, so every entry is broadcast to all
+    // lanes and masked with the lanes that want it. The comparisons are on
+    // small integers in doubles, so they are exact.
+    const vec idx_v = _mm256_set_pd(idx[3], idx[2], idx[1], idx[0]);
+    vec acc[3][12];
+    for (unsigned int c = 0; c < 3; c++) {
+        for (unsigned int j = 0; j < 12; j++) acc[c][j] = _mm256_setzero_pd();
+    }
+    for (unsigned int i = 0; i < 16; i++) {
+        const vec mask = _mm256_cmp_pd(idx_v, _mm256_set1_pd(i), _CMP_EQ_OQ);
+        for (unsigned int c = 0; c < 3; c++) {
+            for (unsigned int j = 0; j < 12; j++) {
+                const vec limb = _mm256_broadcast_sd(&ptable[i][c][j]);
+                acc[c][j] = _mm256_or_pd(acc[c][j], _mm256_and_pd(mask, limb));
+            }
+        }
+    }
+    finish_select(acc, idx_v, sign);
+    for (unsigned int c = 0; c < 3; c++) store(dest[c], acc[c]);
+}
+
+void ge_x4_select_lanes(ge_x4 dest, const uint8_t idx[4], const uint8_t sign[4],
+                        const ge_x4 ptable[16])
+{
+    // Same as `ge_x4_select`, but every lane has a table of its own, so the
+    // entries are loaded as they are
+    const vec idx_v = _mm256_set_pd(idx[3], idx[2], idx[1], idx[0]);
+    vec acc[3][12];
+    for (unsigned int c = 0; c < 3; c++) {
+        for (unsigned int j = 0; j < 12; j++) acc[c][j] = _mm256_setzero_pd();
+    }
+    for (unsigned int i = 0; i < 16; i++) {
+        const vec mask = _mm256_cmp_pd(idx_v, _mm256_set1_pd(i), _CMP_EQ_OQ);
+        for (unsigned int c = 0; c < 3; c++) {
+            for (unsigned int j = 0; j < 12; j++) {
+                const vec limb = _mm256_load_pd(ptable[i][c][j]);
+                acc[c][j] = _mm256_or_pd(acc[c][j], _mm256_and_pd(mask, limb));
+            }
+        }
+    }
+    finish_select(acc, idx_v, sign);
+    for (unsigned int c = 0; c < 3; c++) store(dest[c], acc[c]);
+}
@@ -0,0 +1,1374 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""
+Generate NASM macros for group operations from straight-line formulas.
+
+Author: Daan Sprenkels <hello@dsprenkels.com>
+
+Usage:
+    gen_ge.py FORMULA                 print the generated macro on stdout
+    gen_ge.py --bounds FORMULA        print the limb bound of every value
+    gen_ge.py --check N FORMULA       emulate the generated code on N inputs
+
+A formula file (see `ge_add.formula`) contains an explicit-formula sequence
+like the ones from [Renes2016]. From it, this script:
+
+  - tracks the bound of every limb of every intermediate value, and inserts
+    a reduction only when a multiplication (or the output) would otherwise be
+    out of bounds. That is a single round of carries on as few limbs as
+    possible (`fe12x4_carry`) if that is enough, and a full squeeze
+    otherwise;
+  - packs independent multiplications and reductions into the four lanes of
+    `fe12x4_mul`, `fe12x4_carry` and `fe12x4_squeeze`;
+  - rewrites the additions, subtractions and multiplications by constants as
+    linear combinations of the input coordinates and the kernel results, and
+    computes every kernel operand four lanes at a time, as a sum of blended,
+    broadcast or permuted words times constant vectors; and
+  - assigns the kernel operands and results to stack slots.
+
+Bounds are tracked exactly (as fractions) per limb, relative to the limb's
+offset `2^k`. The multiplication bounds follow the Karatsuba evaluation
+order of `fe12_mul` and the squeeze bounds follow the carry chains of
+`fe12x4_squeeze_body` (or the single round of `fe12x4_carry_body`). An
+intermediate value that could exceed 2^53 (i.e. that cannot be represented
+exactly by a double) is an error. Because every value is exact, the linear
+combinations compute the same values as the formula, and their bounds are
+never larger than those of the formula's own order of evaluation.
+
+All points are in the `ge` layout, i.e. the coordinates x, y and z are three
+consecutive fe12 values.
+"""
+
+from __future__ import division, print_function
+
+import argparse
+import collections
+import itertools
+import math
+import random
+import sys
+from fractions import Fraction
+
+P = 2**255 - 19
+OFFSETS = [0, 22, 43, 64, 85, 107, 128, 149, 170, 192, 213, 234, 255]
+WIDTHS = [OFFSETS[i+1] - OFFSETS[i] for i in range(12)]
+
+# Carry steps (from, to) of `fe12x4_squeeze_body`, grouped per round
+SQUEEZE_ROUNDS = [
+    [(0, 1), (4, 5), (8, 9)],
+    [(1, 2), (5, 6), (9, 10)],
+    [(2, 3), (6, 7), (10, 11)],
+    [(3, 4), (7, 8), (11, 0)],
+    [(4, 5), (8, 9), (0, 1)],
+]
+
+# Preconditions of `fe12x4_squeeze` and `fe12x4_mul`
+SQUEEZE_LIMIT = Fraction(99, 100) * 2**53
+MUL_LIMIT = Fraction(98, 100) * 2**53
+
+# Registers available to the code between the kernel calls
+NUM_REGS = 16
+
+LANES = 4
+
+
+class BoundError(Exception):
+    pass
+
+
+class FormulaError(Exception):
+    pass
+
+
+# ===== Bound tracking =====
+
+class Interval(object):
+    """A double that is divisible by 2^unit and bounded by ±mag"""
+
+    def __init__(self, mag, unit):
+        self.mag = Fraction(mag)
+        self.unit = unit
+        if self.mag > Fraction(2)**(53 + unit):
+            raise BoundError("intermediate value exceeds 2^53 * 2^{}".format(unit))
+
+    def __add__(self, other):
+        return Interval(self.mag + other.mag, min(self.unit, other.unit))
+
+    __sub__ = __add__
+
+    def __mul__(self, other):
+        return Interval(self.mag * other.mag, self.unit + other.unit)
+
+    def scale(self, k):
+        return Interval(self.mag * Fraction(2)**k, self.unit + k)
+
+    def times(self, c):
+        return Interval(self.mag * abs(c), self.unit)
+
+
+def convolve(xs, ys):
+    acc = [None] * (len(xs) + len(ys) - 1)
+    for i, x in enumerate(xs):
+        for j, y in enumerate(ys):
+            acc[i + j] = x * y if acc[i + j] is None else acc[i + j] + x * y
+    return acc
+
+
+def mul_bounds(a, b):
+    """Bounds of the (unsqueezed) product limbs, as computed by `fe12_mul`"""
+    A = [Interval(a[i] * Fraction(2)**OFFSETS[i], OFFSETS[i]) for i in range(12)]
+    B = [Interval(b[i] * Fraction(2)**OFFSETS[i], OFFSETS[i]) for i in range(12)]
+    A_shr = [x.scale(-128) for x in A[6:]]
+    B_shr = [x.scale(-128) for x in B[6:]]
+    l = convolve(A[:6], B[:6])
+    h = convolve(A_shr, B_shr)
+    m = convolve([A[i] - A_shr[i] for i in range(6)],
+                 [B_shr[i] - B[i] for i in range(6)])
+    def middle(j):
+        # m_j + l_j + h_j equals the sum of the cross products, so its value
+        # is divisible by a larger power of two than the terms are.
+        terms = [(A[i], B_shr[j-i]) for i in range(6) if 0 <= j - i < 6]
+        terms += [(A_shr[i], B[j-i]) for i in range(6) if 0 <= j - i < 6]
+        m[j] + l[j] + h[j]          # the partial sums must still be exact
+        return Interval(sum(x.mag * y.mag for x, y in terms),
+                        min(x.unit + y.unit for x, y in terms))
+
+    C = []
+    for j in range(5):
+        C.append(l[j] + (middle(j+6).scale(-128) + h[j]).times(19).scale(1))
+    C.append(l[5] + h[5].times(19).scale(1))
+    for j in range(6, 11):
+        C.append(l[j] + middle(j-6).scale(128) + h[j].times(19).scale(1))
+    C.append(middle(5).scale(128))
+    ret = [c.mag / Fraction(2)**OFFSETS[j] for j, c in enumerate(C)]
+    if max(ret) > MUL_LIMIT:
+        raise BoundError("product limb exceeds 0.98 * 2^53")
+    return ret
+
+
+def squeeze_bounds(z):
+    """Bounds of the limbs after `fe12x4_squeeze_body`"""
+    if max(z) > SQUEEZE_LIMIT:
+        raise BoundError("squeeze input exceeds 0.99 * 2^53")
+    z = list(z)
+    for steps in SQUEEZE_ROUNDS:
+        for src, dst in steps:
+            half = Fraction(2)**(WIDTHS[src] - 1)
+            if z[src] < half:
+                continue
+            carry = (z[src] + half) // 2**WIDTHS[src]
+            z[src] = half
+            z[dst] += 19 * carry if dst == 0 else carry
+    return z
+
+
+def carry_bounds(z, limbs):
+    """Bounds of the limbs after `fe12x4_carry_body` on `limbs`
+
+    All carries are computed from the limbs as they were before the call.
+    """
+    if max(z) > SQUEEZE_LIMIT:
+        raise BoundError("carry input exceeds 0.99 * 2^53")
+    ret = list(z)
+    for src in limbs:
+        dst = (src + 1) % 12
+        half = Fraction(2)**(WIDTHS[src] - 1)
+        if z[src] < half:
+            continue
+        carry = (z[src] + half) // 2**WIDTHS[src]
+        ret[src] += half - z[src]
+        ret[dst] += 19 * carry if dst == 0 else carry
+    return ret
+
+
+def mul_ok(a, b):
+    try:
+        mul_bounds(a, b)
+    except BoundError:
+        return False
+    return True
+
+
+def fmt_bound(bounds):
+    """Format the largest limb bound like the comments in `ge_add.mac`"""
+    m = max(bounds)
+    e = 0
+    while m >= 2**(e + 1):
+        e += 1
+    return "{:.2f} * 2^{}".format(float(m / 2**e), e)
+
+
+# ===== Formula representation =====
+
+class Op(object):
+    """A value in the (SSA-form) formula"""
+
+    def __init__(self, kind, args=(), const=None, var=None):
+        self.kind = kind            # input, add, sub, cmul, mul, squeeze, carry
+        self.args = list(args)
+        self.const = const          # (name, value) for cmul, (param, coordinate)
+                                    # for input, carried limbs for carry
+        self.var = var              # variable name in the formula
+        self.bounds = None
+        self.name = None
+        self.index = None
+
+    @property
+    def is_kernel(self):
+        return self.kind in ('mul', 'squeeze', 'carry')
+
+    def describe(self):
+        if self.kind in ('add', 'sub'):
+            sym = '+' if self.kind == 'add' else '-'
+            return "{} = {} {} {}".format(self.name, self.args[0].name, sym,
+                                          self.args[1].name)
+        if self.kind == 'cmul':
+            return "{} = {} * {}".format(self.name, self.const[0], self.args[0].name)
+        if self.kind == 'mul':
+            return "{} = {} * {}".format(self.name, self.args[0].name,
+                                         self.args[1].name)
+        if self.kind == 'squeeze':
+            return "{} = squeeze({})".format(self.name, self.args[0].name)
+        if self.kind == 'carry':
+            return "{} = carry({})".format(self.name, self.args[0].name)
+        return self.name
+
+
+class Formula(object):
+    def __init__(self):
+        self.macro = None
+        self.inputs = []            # [(param, [x, y, z])]
+        self.output = None          # (param, [x, y, z])
+        self.consts = collections.OrderedDict()
+        self.bound_factor = 2
+        self.ops = []
+        self.outputs = []
+        self.input_bounds = None
+
+    @property
+    def params(self):
+        """Macro parameters: output point, input points, scratch"""
+        return [self.output[0]] + [p for p, _ in self.inputs] + ['scratch']
+
+    def add_op(self, op):
+        op.index = len(self.ops)
+        op.name = 'v{}'.format(op.index)
+        self.ops.append(op)
+        return op
+
+
+def parse_formula(text):
+    f = Formula()
+    lines = []
+    for lineno, line in enumerate(text.splitlines(), 1):
+        line = line.split('#', 1)[0].strip()
+        if line:
+            lines.append((lineno, line.split()))
+
+    env = {}
+    for lineno, tok in lines:
+        if tok[0] == 'macro' and len(tok) == 2:
+            f.macro = tok[1]
+        elif tok[0] == 'input' and len(tok) == 5:
+            f.inputs.append((tok[1], tok[2:]))
+        elif tok[0] == 'output' and len(tok) == 5:
+            f.output = (tok[1], tok[2:])
+        elif tok[0] == 'const' and len(tok) == 3:
+            f.consts[tok[1]] = int(tok[2])
+        elif tok[0] == 'bound' and len(tok) == 2:
+            f.bound_factor = Fraction(tok[1])
+        elif len(tok) == 5 and tok[1] == '=' and tok[3] in '+-*':
+            pass
+        else:
+            raise FormulaError("line {}: cannot parse '{}'".format(lineno, ' '.join(tok)))
+    if f.macro is None or not f.inputs or f.output is None:
+        raise FormulaError("missing 'macro', 'input' or 'output' line")
+
+    # Inputs are bounded by `bound_factor` times a squeezed value, and
+    # outputs must satisfy the same bound.
+    f.input_bounds = [f.bound_factor * x for x in squeeze_bounds([SQUEEZE_LIMIT] * 12)]
+    for param, names in f.inputs:
+        for coord, var in enumerate(names):
+            op = f.add_op(Op('input', const=(param, coord), var=var))
+            op.bounds = list(f.input_bounds)
+            env[var] = op
+
+    def reduce(op, ok):
+        """Reduce `op` as cheaply as possible, such that `ok(bounds)` holds"""
+        # Carrying a limb that is already reduced does not change anything
+        limbs = [i for i in reversed(range(12)) if op.bounds[i] >= 2**(WIDTHS[i] - 1)]
+        if ok(carry_bounds(op.bounds, limbs)):
+            red = Op('carry', [op], const=tuple(limbs), var=op.var)
+            red.bounds = carry_bounds(op.bounds, limbs)
+        else:
+            red = Op('squeeze', [op], var=op.var)
+            red.bounds = squeeze_bounds(op.bounds)
+        red = f.add_op(red)
+        for var, val in env.items():
+            if val is op:
+                env[var] = red
+        return red
+
+    def lookup(lineno, var):
+        if var not in env:
+            raise FormulaError("line {}: '{}' is not defined".format(lineno, var))
+        return env[var]
+
+    for lineno, tok in lines:
+        if tok[1] != '=':
+            continue
+        dst, _, lhs, sym, rhs = tok
+        if sym == '*' and lhs in f.consts:
+            a = lookup(lineno, rhs)
+            op = Op('cmul', [a], const=(lhs, f.consts[lhs]), var=dst)
+            op.bounds = [f.consts[lhs] * x for x in a.bounds]
+        elif sym == '*':
+            a, b = lookup(lineno, lhs), lookup(lineno, rhs)
+            if not mul_ok(a.bounds, b.bounds):
+                # Reduce as few operands as possible, preferably the one
+                # with the largest bound.
+                a_first = max(a.bounds) >= max(b.bounds)
+                first, second = (a, b) if a_first else (b, a)
+                if a is b:
+                    a = b = reduce(a, lambda x: mul_ok(x, x))
+                elif mul_ok(squeeze_bounds(first.bounds), second.bounds):
+                    rest = second.bounds
+                    first = reduce(first, lambda x: mul_ok(x, rest))
+                    a, b = (first, second) if a_first else (second, first)
+                else:
+                    rest = squeeze_bounds(second.bounds)
+                    first = reduce(first, lambda x: mul_ok(x, rest))
+                    rest = first.bounds
+                    second = reduce(second, lambda x: mul_ok(rest, x))
+                    a, b = (first, second) if a_first else (second, first)
+            op = Op('mul', [a, b], var=dst)
+            op.bounds = squeeze_bounds(mul_bounds(a.bounds, b.bounds))
+        else:
+            a, b = lookup(lineno, lhs), lookup(lineno, rhs)
+            op = Op('add' if sym == '+' else 'sub', [a, b], var=dst)
+            op.bounds = [x + y for x, y in zip(a.bounds, b.bounds)]
+        if max(op.bounds) > 2**53:
+            raise BoundError("line {}: {} may exceed 2^53".format(lineno, dst))
+        env[dst] = f.add_op(op)
+
+    def fits(bounds):
+        return all(x <= y for x, y in zip(bounds, f.input_bounds))
+
+    for var in f.output[1]:
+        op = lookup(None, var)
+        if not fits(op.bounds):
+            op = reduce(op, fits)
+        f.outputs.append(op)
+    return f
+
+
+# ===== Linear combinations =====
+
+def is_atom(op):
+    return op.kind == 'input' or op.is_kernel
+
+
+def linear_form(op, memo):
+    """`op` as a linear combination {atom: coefficient} of inputs and kernel results"""
+    if op in memo:
+        return memo[op]
+    if is_atom(op):
+        form = {op: 1}
+    elif op.kind == 'cmul':
+        form = dict((a, op.const[1] * c) for a, c in linear_form(op.args[0], memo).items())
+    else:
+        sign = 1 if op.kind == 'add' else -1
+        form = dict(linear_form(op.args[0], memo))
+        for a, c in linear_form(op.args[1], memo).items():
+            form[a] = form.get(a, 0) + sign * c
+        form = dict((a, c) for a, c in form.items() if c != 0)
+    memo[op] = form
+    return form
+
+
+def form_key(form):
+    """Hashable version of a linear form"""
+    return tuple(sorted((a.index, c) for a, c in form.items()))
+
+
+def form_bounds(form):
+    ret = [Fraction(0)] * 12
+    for a, c in form.items():
+        ret = [x + abs(c) * y for x, y in zip(ret, a.bounds)]
+    return ret
+
+
+# ===== Scheduling =====
+
+class Slot(object):
+    """A 384-byte stack slot holding one vectorized field element"""
+
+    def __init__(self):
+        self.start = None
+        self.end = None
+        self.base = None            # physical slot number
+        self.atoms = [None] * LANES # kernel results, once the slot holds them
+
+    def touch(self, time):
+        self.start = time if self.start is None else min(self.start, time)
+        self.end = time if self.end is None else max(self.end, time)
+
+    def name(self):
+        return 't{}'.format(self.base)
+
+
+class Sink(object):
+    """A word that a phase computes for every limb
+
+    `forms` holds the linear form of every lane, or None for a lane whose value
+    does not matter.
+    """
+
+    def __init__(self, forms, names, slot=None):
+        self.forms = forms
+        self.names = names
+        self.slot = slot            # None for the output point
+
+
+class Phase(object):
+    """Linear code that runs (once per limb) before a kernel call"""
+
+    def __init__(self):
+        self.sinks = []
+        self.code = None
+
+
+class Kernel(object):
+    def __init__(self, kind, ops, limbs=None):
+        self.kind = kind
+        self.ops = ops              # per lane, None for an unused lane
+        self.limbs = limbs          # carried limbs for a carry kernel
+        self.result = None          # Slot
+        self.operands = []          # Slot per operand
+
+
+class Program(object):
+    def __init__(self, formula):
+        self.formula = formula
+        self.phases = []
+        self.kernels = []
+        self.slots = []
+        self.home = {}              # kernel result -> (Slot, lane)
+        self.forms = {}             # memo for `linear_form`
+        self.consts = collections.OrderedDict()
+        self.num_slots = 0
+
+    def form(self, op):
+        return linear_form(op, self.forms)
+
+
+def live_ops(formula):
+    seen = set()
+    stack = list(formula.outputs)
+    while stack:
+        op = stack.pop()
+        if op in seen:
+            continue
+        seen.add(op)
+        stack.extend(op.args)
+    return [op for op in formula.ops if op in seen]
+
+
+def in_place_lane(prog, op):
+    """The lane of the slot that already holds `op`, if any"""
+    form = prog.form(op)
+    if len(form) == 1:
+        atom, coef = list(form.items())[0]
+        if coef == 1 and atom in prog.home:
+            return prog.home[atom][1]
+    return None
+
+
+def schedule(formula):
+    prog = Program(formula)
+    ops = live_ops(formula)
+    order = dict((op, i) for i, op in enumerate(ops))
+    kernels = [op for op in ops if op.is_kernel]
+    deps = dict((k, set(a for arg in k.args for a in prog.form(arg) if a.is_kernel))
+                for k in kernels)
+
+    # Critical path length (in kernel calls) from every kernel op
+    height = {}
+    for k in reversed(kernels):
+        succ = [s for s in kernels if k in deps[s]]
+        height[k] = 1 + max([height[s] for s in succ] or [0])
+
+    done = set()
+    remaining = list(kernels)
+    while remaining:
+        ready = [k for k in remaining if deps[k] <= done]
+        ready.sort(key=lambda k: (-height[k], order[k]))
+        # Reductions unblock multiplications, so do them first
+        kind = ([k.kind for k in ready if k.kind != 'mul'] or ['mul'])[0]
+        ready = [k for k in ready if k.kind == kind]
+        group = ready[:LANES]
+        for k in group:
+            remaining.remove(k)
+
+        phase = Phase()
+        kernel = Kernel(kind, [None] * LANES)
+        if kind == 'carry':
+            # Carrying more limbs than an op needs is harmless, because those
+            # limbs are already reduced (see `reduce` in `parse_formula`).
+            limbs = set()
+            for k in group:
+                limbs |= set(k.const)
+            kernel.limbs = sorted(limbs, reverse=True)
+
+        # Put an op in the lane where its operands already are, if possible
+        for k in group:
+            lanes = set(in_place_lane(prog, a) for a in k.args)
+            if len(lanes) == 1:
+                lane = lanes.pop()
+                if lane is not None and kernel.ops[lane] is None:
+                    kernel.ops[lane] = k
+        for k in group:
+            if k not in kernel.ops:
+                kernel.ops[kernel.ops.index(None)] = k
+
+        time = 2 * len(prog.kernels)
+        nargs = 2 if kind == 'mul' else 1
+        for n in range(nargs):
+            kernel.operands.append(operand_slot(prog, phase, kernel, n, time))
+        if kind == 'mul':
+            kernel.result = Slot()
+            prog.slots.append(kernel.result)
+        else:
+            kernel.result = kernel.operands[0]
+        kernel.result.touch(time + 1)
+        kernel.result.atoms = list(kernel.ops)
+        for lane, k in enumerate(kernel.ops):
+            if k is not None:
+                prog.home[k] = (kernel.result, lane)
+        done |= set(group)
+        prog.phases.append(phase)
+        prog.kernels.append(kernel)
+
+    # The final phase computes the outputs
+    phase = Phase()
+    phase.sinks.append(Sink([prog.form(op) for op in formula.outputs],
+                            list(formula.output[1])))
+    prog.phases.append(phase)
+
+    # Kernel results stay in their slot as long as a phase reads them
+    for p, phase in enumerate(prog.phases):
+        for sink in phase.sinks:
+            for form in sink.forms:
+                for atom in form or ():
+                    if atom in prog.home:
+                        prog.home[atom][0].touch(2 * p)
+    allocate_slots(prog)
+    return prog
+
+
+def operand_slot(prog, phase, kernel, n, time):
+    """Decide where the `n`th operand of a kernel call comes from"""
+    values = [k.args[n] if k is not None else None for k in kernel.ops]
+    # A multiplication can read its operand where it is, if every lane of a
+    # single slot already holds it. Reductions are done in a new slot, because
+    # they overwrite their operand.
+    if kernel.kind == 'mul':
+        slots = set()
+        for lane, v in enumerate(values):
+            if v is None:
+                continue
+            if in_place_lane(prog, v) != lane:
+                break
+            slots.add(prog.home[list(prog.form(v))[0]][0])
+        else:
+            if len(slots) == 1:
+                slot = slots.pop()
+                slot.touch(time + 1)
+                return slot
+    slot = Slot()
+    prog.slots.append(slot)
+    slot.touch(time)
+    slot.touch(time + 1)
+    forms = [prog.form(v) if v is not None else None for v in values]
+    names = [v.name if v is not None else '??' for v in values]
+    phase.sinks.append(Sink(forms, names, slot))
+    return slot
+
+
+def allocate_slots(prog):
+    """Assign physical slots to the lifetimes by first-fit"""
+    busy = []                       # per physical slot: last time used
+    for slot in sorted(prog.slots, key=lambda s: s.start):
+        for base, end in enumerate(busy):
+            if end < slot.start:
+                break
+        else:
+            base = len(busy)
+            busy.append(None)
+        busy[base] = slot.end
+        slot.base = base
+    prog.num_slots = len(busy)
+
+
+# ===== Code generation =====
+#
+# Between two kernel calls, every limb is handled by the same straight-line
+# code, which computes the kernel operands as words of four lanes. A word is
+# built as a sum of "groups": a group is a blend of broadcast coordinates,
+# broadcast kernel results, or (permuted) words of kernel results, multiplied
+# by a constant vector unless all its coefficients are 1. Per word, a small
+# branch and bound search picks the groups that need the fewest instructions,
+# given the words that earlier code in the same limb already loaded.
+
+class Mem(object):
+    """A memory operand for limb i"""
+
+    def __init__(self, kind, base, offset=0):
+        self.kind = kind            # word, lane (of a Slot), coord (of a point), const
+        self.base = base
+        self.offset = offset
+
+    def key(self):
+        return (self.kind, id(self.base) if isinstance(self.base, Slot) else self.base,
+                self.offset)
+
+    def address(self, prog):
+        if self.kind == 'const':
+            return "rel .{}_const_{}".format(prog.formula.macro, prog.consts[self.base])
+        if self.kind == 'coord':
+            return "{} + 8*i + {}".format(self.base, self.offset)
+        if self.offset:
+            return "{} + 32*i + {}".format(self.base.name(), self.offset)
+        return "{} + 32*i".format(self.base.name())
+
+    def cells(self, limb, aliases):
+        """The memory cells (as keys of the emulator's memory) of this operand"""
+        if self.kind == 'coord':
+            base = aliases.get(self.base, self.base)
+            return [(base, self.offset // 96, limb)]
+        if self.kind == 'word':
+            return [(self.base.name(), limb, lane) for lane in range(LANES)]
+        return [(self.base.name(), limb, self.offset // 8)]
+
+
+class Reg(object):
+    """A virtual register"""
+
+    def __init__(self, content):
+        self.content = content      # per lane: form key, or None if unknown
+        self.phys = None
+        self.instr = None
+
+
+class Instr(object):
+    def __init__(self, op, dst=None, srcs=(), imm=None, comment=None):
+        self.op = op
+        self.dst = dst
+        self.srcs = list(srcs)      # Regs or Mems
+        self.imm = imm
+        self.comment = comment
+
+
+def scale_key(key, c):
+    if c == 0:
+        return ()
+    if key is None:
+        return None
+    return tuple((a, c * x) for a, x in key)
+
+
+def add_keys(x, y, sign):
+    if x is None or y is None:
+        return None
+    acc = collections.defaultdict(int)
+    for a, c in x:
+        acc[a] += c
+    for a, c in y:
+        acc[a] += sign * c
+    return tuple(sorted((a, c) for a, c in acc.items() if c != 0))
+
+
+class Code(object):
+    """The per-limb code of one phase, on virtual registers"""
+
+    def __init__(self, prog):
+        self.prog = prog
+        self.pre = []               # instructions before the loop over the limbs
+        self.body = []
+        self.stores = []
+        self.values = {}            # (op, srcs, imm) -> Reg
+        self.providers = {}         # provider -> Reg
+
+    def emit(self, op, srcs, imm=None):
+        key = (op, tuple(id(s) if isinstance(s, Reg) else s.key() for s in srcs), imm)
+        if key in self.values:
+            return self.values[key]
+        c = [s.content if isinstance(s, Reg) else None for s in srcs]
+        if op == 'perm1':
+            content = tuple(c[0][l ^ 1] for l in range(LANES))
+        elif op == 'perm2':
+            content = tuple(c[0][l ^ 2] for l in range(LANES))
+        elif op == 'blend':
+            content = tuple(c[1][l] if imm >> l & 1 else c[0][l] for l in range(LANES))
+        elif op == 'mul':
+            value = srcs[1].base
+            content = tuple(scale_key(c[0][l], value[l]) for l in range(LANES))
+        elif op in ('add', 'sub'):
+            sign = 1 if op == 'add' else -1
+            content = tuple(add_keys(c[0][l], c[1][l], sign) for l in range(LANES))
+        elif op == 'extract':
+            content = (c[0][2], c[0][3], None, None)
+        else:
+            raise ValueError(op)
+        reg = Reg(content)
+        self.append(Instr(op, reg, srcs, imm))
+        self.values[key] = reg
+        return reg
+
+    def append(self, instr):
+        if instr.dst is not None:
+            instr.dst.instr = instr
+        self.body.append(instr)
+
+    def const(self, values):
+        return Mem('const', tuple(values))
+
+    def atom_mem(self, atom):
+        if atom.kind == 'input':
+            param, coord = atom.const
+            return Mem('coord', param, 96 * coord)
+        slot, lane = self.prog.home[atom]
+        return Mem('lane', slot, 8 * lane)
+
+    def provide(self, p):
+        """Get the register of provider `p` (see `providers`)"""
+        if p in self.providers:
+            return self.providers[p]
+        if p == 'zero':
+            reg = Reg(((),) * LANES)
+            self.pre.append(Instr('zero', reg))
+        elif p[0] == 'bcast':
+            atom = p[1]
+            reg = Reg((form_key({atom: 1}),) * LANES)
+            self.append(Instr('bcast', reg, [self.atom_mem(atom)]))
+        else:
+            _, slot, d = p
+            if d == 0:
+                content = tuple(form_key({a: 1}) if a is not None else None
+                                for a in slot.atoms)
+                reg = Reg(content)
+                self.append(Instr('load', reg, [Mem('word', slot)]))
+            elif d == 3:
+                reg = self.emit('perm1', [self.provide(('word', slot, 2))])
+            else:
+                reg = self.emit('perm{}'.format(d), [self.provide(('word', slot, 0))])
+        self.providers[p] = reg
+        return reg
+
+
+def providers(prog, rem):
+    """For every provider of the atoms in `rem`: the lanes that it can serve
+
+    A provider is 'zero', ('bcast', atom), or ('word', slot, d): the word of the
+    kernel results in `slot`, with lane l holding lane l ^ d of the slot.
+    """
+    ret = collections.OrderedDict()
+    for lane, r in enumerate(rem):
+        for atom in sorted(r or (), key=lambda a: a.index):
+            ret.setdefault(('bcast', atom), {})[lane] = atom
+            if atom in prog.home:
+                slot, k = prog.home[atom]
+                ret.setdefault(('word', slot, k ^ lane), {})[lane] = atom
+    return ret
+
+
+def materialize_cost(provs, avail):
+    need = set(provs)
+    for p in provs:
+        if p != 'zero' and p[0] == 'word' and p[2] >= 2:
+            need.add(('word', p[1], 0))
+            if p[2] == 3:
+                need.add(('word', p[1], 2))
+    return sum(1 for p in need if p != 'zero' and p not in avail), need
+
+
+class Group(object):
+    def __init__(self, lanes, coefs, zero_lanes, mul, sign, cost, avail):
+        self.lanes = lanes          # lane -> (provider, atom)
+        self.coefs = coefs          # lane -> coefficient
+        self.zero_lanes = zero_lanes
+        self.mul = mul              # multiply by a constant vector
+        self.sign = sign            # add or subtract to the accumulator
+        self.cost = cost
+        self.avail = avail
+
+
+def group_candidates(prog, rem, avail, has_acc):
+    """All ways to take one term from some of the lanes in `rem`"""
+    provs = providers(prog, rem)
+    options = []
+    for lane, r in enumerate(rem):
+        opts = [None]
+        for p, served in provs.items():
+            if lane in served:
+                opts.append((p, served[lane]))
+        options.append(opts)
+
+    ret = []
+    seen = set()
+    for choice in itertools.product(*options):
+        lanes = dict((l, c) for l, c in enumerate(choice) if c is not None)
+        used = set(p for p, _ in lanes.values())
+        if not lanes or len(used) > 3:
+            continue
+        # Prefer a single provider for lanes that it can serve anyway
+        key = frozenset(lanes.items())
+        if key in seen:
+            continue
+        seen.add(key)
+        coefs = dict((l, rem[l][a]) for l, (_, a) in lanes.items())
+        zero_lanes = [l for l in range(LANES) if rem[l] is not None and l not in lanes]
+        values = set(coefs.values())
+        best = None
+        # Without a multiplication, the unused lanes must be zero
+        if len(values) == 1 and list(values)[0] in (1, -1) and (has_acc or 1 in values):
+            provs_z = used | (set(['zero']) if zero_lanes else set())
+            cost, need = materialize_cost(provs_z, avail)
+            cost += len(provs_z) - 1 + (1 if has_acc else 0)
+            best = Group(lanes, coefs, zero_lanes, False, list(values)[0], cost, need)
+        cost, need = materialize_cost(used, avail)
+        cost += len(used) - 1 + 1 + (1 if has_acc else 0)
+        if best is None or cost < best.cost:
+            best = Group(lanes, coefs, zero_lanes, True, 1, cost, need)
+        ret.append(best)
+    return ret
+
+
+def plan_word(prog, forms, avail, limit=3):
+    """Find a cheap sequence of groups that computes a word with `forms`"""
+    rem = [dict(f) if f is not None else None for f in forms]
+    best = [None, None]
+
+    def search(rem, avail, has_acc, cost, plan):
+        terms = max(len(r) for r in rem if r is not None)
+        if terms == 0:
+            if best[0] is None or cost < best[0]:
+                best[0], best[1] = cost, list(plan)
+            return
+        if best[0] is not None and cost + terms - (0 if has_acc else 1) >= best[0]:
+            return
+        cands = group_candidates(prog, rem, avail, has_acc)
+        cands.sort(key=lambda g: (Fraction(g.cost, len(g.lanes)), -len(g.lanes)))
+        for g in cands[:limit]:
+            new = [dict(r) if r is not None else None for r in rem]
+            for l, (_, atom) in g.lanes.items():
+                del new[l][atom]
+            plan.append(g)
+            search(new, avail | g.avail, True, cost + g.cost, plan)
+            plan.pop()
+
+    search(rem, frozenset(avail), False, 0, [])
+    return best[1]
+
+
+def build_word(code, forms):
+    """Emit the code for a word whose lanes hold `forms`, return its register"""
+    target = tuple(form_key(f) if f is not None else None for f in forms)
+    for reg in list(code.providers.values()) + list(code.values.values()):
+        if all(t is None or t == c for t, c in zip(target, reg.content)):
+            return reg
+
+    acc = None
+    for g in plan_word(code.prog, forms, code.providers):
+        used = []
+        for p, _ in g.lanes.values():
+            if p not in used:
+                used.append(p)
+        used.sort(key=lambda p: -sum(1 for q, _ in g.lanes.values() if q == p))
+        regs = dict((p, code.provide(p)) for p in used)
+        cur = regs[used[0]]
+        for p in used[1:]:
+            mask = sum(1 << l for l, (q, _) in g.lanes.items() if q == p)
+            cur = code.emit('blend', [cur, regs[p]], mask)
+        if g.zero_lanes and not g.mul:
+            cur = code.emit('blend', [cur, code.provide('zero')],
+                            sum(1 << l for l in g.zero_lanes))
+        if g.mul:
+            cur = code.emit('mul', [cur, code.const(g.coefs.get(l, 0) for l in range(LANES))])
+        if acc is None:
+            acc = cur
+        else:
+            acc = code.emit('add' if g.sign > 0 else 'sub', [acc, cur])
+    assert all(t is None or t == c for t, c in zip(target, acc.content))
+    return acc
+
+
+def codegen_phase(prog, phase):
+    """Generate the per-limb code of a phase"""
+    code = Code(prog)
+    for sink in phase.sinks:
+        if sink.slot is None:
+            return codegen_outputs(prog, sink)
+        reg = build_word(code, sink.forms)
+        comment = "{} = [{}]".format(sink.slot.name(), ", ".join(sink.names))
+        code.append(Instr('store', None, [reg, Mem('word', sink.slot)], comment=comment))
+    return finish(code)
+
+
+def codegen_outputs(prog, sink):
+    """Generate the code for the output point, as vectors or as scalars"""
+    param = prog.formula.output[0]
+    candidates = []
+    for lanes in itertools.permutations(range(LANES), 3):
+        code = Code(prog)
+        forms = [None] * LANES
+        for lane, form in zip(lanes, sink.forms):
+            forms[lane] = form
+        reg = build_word(code, forms)
+        for coord, (lane, name) in enumerate(zip(lanes, sink.names)):
+            src = reg if lane < 2 else code.emit('extract', [reg])
+            code.stores.append(Instr('sstore', None, [src, Mem('coord', param, 96 * coord)],
+                                     imm=lane % 2, comment="store {}".format(name)))
+        candidates.append(finish(code))
+
+    code = Code(prog)
+    for coord, (form, name) in enumerate(zip(sink.forms, sink.names)):
+        terms = sorted(form.items(), key=lambda t: (t[1] != 1, abs(t[1]) != 1, t[0].index))
+        acc = None
+        for atom, c in terms:
+            if acc is not None and abs(c) == 1:
+                acc = scalar(code, 'sadd' if c > 0 else 'ssub', [acc, code.atom_mem(atom)])
+                continue
+            reg = scalar(code, 'sload', [code.atom_mem(atom)])
+            if c != 1:
+                reg = scalar(code, 'smul', [reg, code.const([c] * LANES)])
+            acc = reg if acc is None else scalar(code, 'sadd', [acc, reg])
+        code.stores.append(Instr('sstore', None, [acc, Mem('coord', param, 96 * coord)],
+                                 imm=0, comment="store {}".format(name)))
+    candidates.append(finish(code))
+    return min(candidates, key=lambda c: len(c.body))
+
+
+def scalar(code, op, srcs):
+    reg = Reg(None)
+    code.append(Instr(op, reg, srcs))
+    return reg
+
+
+def finish(code):
+    """Store the outputs, fold loads into their users and allocate registers
+
+    The outputs are stored after all loads, so that the resulting point may be
+    the same as an input point.
+    """
+    for instr in code.stores:
+        code.append(instr)
+    fold_loads(code)
+    allocate_registers(code)
+    return code
+
+
+def fold_loads(code):
+    """Use a memory operand instead of a load that is only used once"""
+    uses = collections.defaultdict(int)
+    for instr in code.body:
+        for s in instr.srcs:
+            if isinstance(s, Reg):
+                uses[s] += 1
+    folded = set()
+    for instr in code.body:
+        for n, s in enumerate(instr.srcs):
+            if not isinstance(s, Reg) or s.instr is None or uses[s] != 1:
+                continue
+            if s.instr.op not in ('load', 'sload'):
+                continue
+            other = instr.srcs[1 - n] if len(instr.srcs) == 2 else None
+            if isinstance(other, Mem):
+                continue
+            if instr.op in ('add', 'mul', 'sadd', 'smul', 'blend') and n == 0:
+                # Only the last source operand can be in memory
+                instr.srcs.reverse()
+                if instr.op == 'blend':
+                    instr.imm ^= (1 << LANES) - 1
+            elif n == 0 and instr.op != 'perm1':
+                continue
+            elif n == 1 and instr.op not in ('add', 'sub', 'mul', 'blend',
+                                             'sadd', 'ssub', 'smul'):
+                continue
+            instr.srcs[instr.srcs.index(s)] = s.instr.srcs[0]
+            folded.add(s.instr)
+    code.body = [instr for instr in code.body if instr not in folded]
+
+
+def allocate_registers(code):
+    last = {}
+    for n, instr in enumerate(code.body):
+        for s in instr.srcs:
+            if isinstance(s, Reg):
+                last[s] = n
+    free = list(range(NUM_REGS))
+    for instr in code.pre:
+        instr.dst.phys = free.pop()
+    for n, instr in enumerate(code.body):
+        for s in instr.srcs:
+            if isinstance(s, Reg) and last[s] == n and s.phys not in free:
+                if all(s is not i.dst for i in code.pre):
+                    free.insert(0, s.phys)
+        if instr.dst is not None:
+            if not free:
+                raise FormulaError("out of registers")
+            instr.dst.phys = free.pop(0)
+            if instr.dst not in last:
+                free.insert(0, instr.dst.phys)
+
+
+def render_content(prog, content):
+    names = dict((op.index, op.var if op.kind == 'input' else op.name) for op in prog.formula.ops)
+
+    def lane(key):
+        if key is None:
+            return "??"
+        if not key:
+            return "0"
+        if len(key) > 2:
+            return ".."
+        s = ""
+        for a, c in key:
+            term = names[a] if abs(c) == 1 else "{}*{}".format(abs(c), names[a])
+            if not s:
+                s = term if c > 0 else "-" + term
+            else:
+                s += " + " + term if c > 0 else " - " + term
+        return s
+    return "[{}]".format(", ".join(lane(k) for k in content))
+
+
+def render_instr(prog, instr):
+    def operand(s, width='yword', reg='ymm'):
+        if isinstance(s, Reg):
+            return "{}{}".format(reg, s.phys)
+        return "{} [{}]".format(width, s.address(prog))
+    op = instr.op
+    d = instr.dst.phys if instr.dst is not None else None
+    srcs = instr.srcs
+    if op == 'zero':
+        s = "vxorpd ymm{0}, ymm{0}, ymm{0}".format(d)
+    elif op == 'bcast':
+        s = "vbroadcastsd ymm{}, {}".format(d, operand(srcs[0], 'qword'))
+    elif op == 'load':
+        s = "vmovapd ymm{}, {}".format(d, operand(srcs[0]))
+    elif op == 'perm1':
+        s = "vpermilpd ymm{}, {}, 0b0101".format(d, operand(srcs[0]))
+    elif op == 'perm2':
+        s = "vperm2f128 ymm{0}, {1}, {1}, 0x01".format(d, operand(srcs[0]))
+    elif op == 'blend':
+        s = "vblendpd ymm{}, {}, {}, 0b{:04b}".format(d, operand(srcs[0]), operand(srcs[1]),
+                                                      instr.imm)
+    elif op in ('add', 'sub', 'mul'):
+        s = "v{}pd ymm{}, {}, {}".format(op, d, operand(srcs[0]), operand(srcs[1]))
+    elif op == 'extract':
+        s = "vextractf128 xmm{}, {}, 0b1".format(d, operand(srcs[0]))
+    elif op == 'store':
+        s = "vmovapd {}, {}".format(operand(srcs[1]), operand(srcs[0]))
+    elif op == 'sstore':
+        s = "{} {}, {}".format('vmovhpd' if instr.imm else 'vmovsd',
+                               operand(srcs[1], 'qword'), operand(srcs[0], reg='xmm'))
+    elif op == 'sload':
+        s = "vmovsd xmm{}, {}".format(d, operand(srcs[0], 'qword'))
+    elif op in ('sadd', 'ssub', 'smul'):
+        s = "v{}sd xmm{}, {}, {}".format(op[1:], d, operand(srcs[0], 'qword', 'xmm'),
+                                         operand(srcs[1], 'qword', 'xmm'))
+    else:
+        raise ValueError(op)
+    comment = instr.comment
+    if comment is None and instr.dst is not None and instr.dst.content is not None:
+        comment = render_content(prog, instr.dst.content)
+    if comment:
+        s = "{:<47} ; {}".format(s, comment)
+    return s
+
+
+def render(prog, out):
+    formula = prog.formula
+    prefix = formula.macro
+    params = formula.params
+    w = out.write
+
+    w("; {} (generated by gen_ge.py, do not edit)\n".format(prefix))
+    w(";\n; Author: Daan Sprenkels <hello@dsprenkels.com>\n\n")
+    w('%include "fe12_mul.mac"\n\n')
+    w("; Number of bytes of scratch space that `{}` needs\n".format(prefix))
+    w("%define {}_scratch_size {}*384 + 768\n\n".format(prefix, prog.num_slots))
+    w("%macro {} {}\n".format(prefix, len(params)))
+    w("    ; Arguments:\n")
+    w("    ;   - %1: the resulting point\n")
+    for n, (param, _) in enumerate(formula.inputs, 2):
+        w("    ;   - %{}: an input point\n".format(n))
+    w("    ;   - %{}: {}_scratch_size bytes of 32-byte aligned scratch space\n".format(
+        len(params), prefix))
+    w("    ;\n")
+    w("    ; The resulting point may be the same as an input point.\n")
+    w("    ; assume forall v in input : |v| ≤ {}\n".format(fmt_bound(formula.input_bounds)))
+    w("    %push {}_ctx\n".format(prefix))
+    for n, param in enumerate(params[:-1], 1):
+        w("    %xdefine {:<11} %{}\n".format(param, n))
+    for n in range(prog.num_slots):
+        w("    %xdefine {:<11} %{} + {}*384\n".format('t{}'.format(n), len(params), n))
+    w("    %xdefine {:<11} %{} + {}*384\n".format('scratch', len(params), prog.num_slots))
+
+    for p, phase in enumerate(prog.phases):
+        code = phase.code
+        if code.body:
+            w("\n")
+            for instr in code.pre:
+                w("    {}\n".format(render_instr(prog, instr)))
+            w("    %assign i 0\n")
+            w("    %rep 12\n")
+            for instr in code.body:
+                w("        {}\n".format(render_instr(prog, instr)))
+            w("        %assign i i + 1\n")
+            w("    %endrep\n")
+        if p < len(prog.kernels):
+            kernel = prog.kernels[p]
+            names = "[{}]".format(", ".join(k.name if k else '??' for k in kernel.ops))
+            bound = fmt_bound([max(x) for x in zip(*[k.bounds for k in kernel.ops if k])])
+            if kernel.kind == 'mul':
+                call = "fe12x4_mul {}, {}, {}, scratch".format(
+                    kernel.result.name(), kernel.operands[0].name(), kernel.operands[1].name())
+            elif kernel.kind == 'carry':
+                call = "fe12x4_carry {}, {}".format(
+                    kernel.result.name(), ", ".join(str(x) for x in kernel.limbs))
+            else:
+                call = "fe12x4_squeeze {}".format(kernel.result.name())
+            w("\n    {:<47} ; computing {} ≤ {}\n".format(call, names, bound))
+    w("    %pop {}_ctx\n".format(prefix))
+    w("%endmacro\n\n")
+    w("%macro {}_consts 0\n".format(prefix))
+    for values, name in prog.consts.items():
+        w("    align 32, db 0\n")
+        w("    .{}_const_{}: dq {}\n".format(prefix, name,
+                                           ", ".join("{}.0".format(x) for x in values)))
+    w("%endmacro\n")
+
+
+def generate(formula):
+    prog = schedule(formula)
+    for phase in prog.phases:
+        phase.code = codegen_phase(prog, phase)
+    for phase in prog.phases:
+        for instr in phase.code.body:
+            for s in instr.srcs:
+                if isinstance(s, Mem) and s.kind == 'const' and s.base not in prog.consts:
+                    prog.consts[s.base] = len(prog.consts)
+    return prog
+
+
+# ===== Emulation =====
+
+def fe12_mul_emulate(a, b):
+    """Karatsuba multiplication as in `fe12_mul`, using doubles"""
+    a_shr = [x * 2.0**-128 for x in a[6:]]
+    b_shr = [x * 2.0**-128 for x in b[6:]]
+
+    def conv(xs, ys):
+        acc = [0.0] * 12
+        for i, x in enumerate(xs):
+            for j, y in enumerate(ys):
+                acc[i + j] += x * y
+        return acc
+    l = conv(a[:6], b[:6])
+    h = conv(a_shr, b_shr)
+    m = conv([a[i] - a_shr[i] for i in range(6)], [b_shr[i] - b[i] for i in range(6)])
+    c = [0.0] * 12
+    for j in range(5):
+        c[j] = l[j] + 38.0 * (2.0**-128 * (m[j+6] + l[j+6] + h[j+6]) + h[j])
+    c[5] = l[5] + 38.0 * h[5]
+    for j in range(6, 11):
+        c[j] = l[j] + 2.0**128 * (m[j-6] + l[j-6] + h[j-6]) + 38.0 * h[j]
+    c[11] = 2.0**128 * (m[5] + l[5] + h[5])
+    return c
+
+
+def fe12_squeeze_emulate(z):
+    z = list(z)
+    for steps in SQUEEZE_ROUNDS:
+        for src, dst in steps:
+            c = 3.0 * 2.0**(OFFSETS[src + 1] + 51)
+            t = (z[src] + c) - c
+            z[src] -= t
+            z[dst] += t * 19.0 * 2.0**-255 if dst == 0 else t
+    return z
+
+
+def fe12_carry_emulate(z, limbs):
+    ret = list(z)
+    for src in limbs:
+        dst = (src + 1) % 12
+        c = 3.0 * 2.0**(OFFSETS[src + 1] + 51)
+        t = (z[src] + c) - c
+        ret[src] -= t
+        ret[dst] += t * 19.0 * 2.0**-255 if dst == 0 else t
+    return ret
+
+
+ARITH = {
+    'add': lambda a, b: a + b,
+    'sub': lambda a, b: a - b,
+    'mul': lambda a, b: a * b,
+}
+
+
+def emulate(prog, memory, aliases):
+    """Run the generated program; `memory` maps (base, limb, lane) to doubles"""
+    for p, phase in enumerate(prog.phases):
+        code = phase.code
+        for limb in range(12):
+            regs = {}
+            for instr in code.pre:
+                regs[instr.dst] = [0.0] * LANES
+
+            def val(s):
+                if isinstance(s, Reg):
+                    return regs[s]
+                if s.kind == 'const':
+                    return [float(x) for x in s.base]
+                return [memory[c] for c in s.cells(limb, aliases)]
+            for instr in code.body:
+                op, srcs = instr.op, instr.srcs
+                if op == 'bcast':
+                    r = val(srcs[0]) * LANES
+                elif op == 'load':
+                    r = val(srcs[0])
+                elif op in ('perm1', 'perm2'):
+                    x = val(srcs[0])
+                    r = [x[l ^ int(op[-1])] for l in range(LANES)]
+                elif op == 'blend':
+                    x, y = val(srcs[0]), val(srcs[1])
+                    r = [y[l] if instr.imm >> l & 1 else x[l] for l in range(LANES)]
+                elif op in ('add', 'sub', 'mul', 'sadd', 'ssub', 'smul'):
+                    x, y = val(srcs[0]), val(srcs[1])
+                    f = ARITH[op[-3:]]
+                    r = [f(a, b) for a, b in zip(x, y)]
+                    if op in ('sadd', 'ssub', 'smul'):
+                        # Scalar instructions only compute the lowest lane
+                        r = r[:1] + x[1:]
+                elif op == 'sload':
+                    r = val(srcs[0]) + [0.0] * (LANES - 1)
+                elif op == 'extract':
+                    x = val(srcs[0])
+                    r = x[2:] + [0.0, 0.0]
+                elif op == 'store':
+                    for c, v in zip(srcs[1].cells(limb, aliases), val(srcs[0])):
+                        memory[c] = v
+                    continue
+                elif op == 'sstore':
+                    memory[srcs[1].cells(limb, aliases)[0]] = val(srcs[0])[instr.imm]
+                    continue
+                else:
+                    raise ValueError(op)
+                regs[instr.dst] = r
+        if p == len(prog.kernels):
+            break
+        kernel = prog.kernels[p]
+
+        def word(slot, lane):
+            limbs = [memory[(slot.name(), i, lane)] for i in range(12)]
+            if any(math.isnan(x) for x in limbs):
+                raise AssertionError("kernel {} reads uninitialized memory".format(p))
+            return limbs
+        for lane in range(LANES):
+            if kernel.kind == 'mul':
+                c = fe12_squeeze_emulate(fe12_mul_emulate(word(kernel.operands[0], lane),
+                                                          word(kernel.operands[1], lane)))
+            elif kernel.kind == 'carry':
+                c = fe12_carry_emulate(word(kernel.operands[0], lane), kernel.limbs)
+            else:
+                c = fe12_squeeze_emulate(word(kernel.operands[0], lane))
+            for i in range(12):
+                memory[(kernel.result.name(), i, lane)] = c[i]
+
+
+def evaluate(formula, values):
+    """Evaluate the formula modulo p"""
+    env = {}
+    for op in formula.ops:
+        if op.kind == 'input':
+            env[op] = values[op.const]
+        elif op.kind == 'add':
+            env[op] = (env[op.args[0]] + env[op.args[1]]) % P
+        elif op.kind == 'sub':
+            env[op] = (env[op.args[0]] - env[op.args[1]]) % P
+        elif op.kind == 'cmul':
+            env[op] = (op.const[1] * env[op.args[0]]) % P
+        elif op.kind == 'mul':
+            env[op] = (env[op.args[0]] * env[op.args[1]]) % P
+        elif op.kind in ('squeeze', 'carry'):
+            env[op] = env[op.args[0]]
+    return [env[op] for op in formula.outputs]
+
+
+def check(prog, count, rng):
+    formula = prog.formula
+    for n in range(count):
+        aliases = {}
+        if n % 2 == 1:
+            aliases[formula.output[0]] = formula.inputs[0][0]
+        memory = {}
+        values = {}
+        for slot in range(prog.num_slots):
+            for i in range(12):
+                for lane in range(LANES):
+                    memory[('t{}'.format(slot), i, lane)] = float('nan')
+        for param, _ in formula.inputs:
+            for coord in range(3):
+                limbs = []
+                for i in range(12):
+                    bound = int(formula.input_bounds[i])
+                    x = rng.choice([-bound, bound, rng.randint(-bound, bound)])
+                    limbs.append(float(x) * 2.0**OFFSETS[i])
+                    memory[(param, coord, i)] = limbs[-1]
+                values[(param, coord)] = sum(int(x) for x in limbs) % P
+        out = aliases.get(formula.output[0], formula.output[0])
+        if out == formula.output[0]:
+            for coord in range(3):
+                for i in range(12):
+                    memory[(out, coord, i)] = float('nan')
+        expected = evaluate(formula, values)
+        emulate(prog, memory, aliases)
+        for coord, want in enumerate(expected):
+            limbs = [memory[(out, coord, i)] for i in range(12)]
+            got = sum(int(x) for x in limbs) % P
+            if got != want:
+                raise AssertionError("coordinate {} differs in run {}".format(coord, n))
+            for i, x in enumerate(limbs):
+                if abs(x) > formula.input_bounds[i] * 2**OFFSETS[i]:
+                    raise AssertionError("limb {} out of bounds in run {}".format(i, n))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('formula')
+    parser.add_argument('--bounds', action='store_true',
+                        help="print the bound of every value")
+    parser.add_argument('--check', type=int, metavar='N',
+                        help="emulate the generated code on N random inputs")
+    args = parser.parse_args()
+
+    with open(args.formula) as fh:
+        formula = parse_formula(fh.read())
+    prog = generate(formula)
+    if args.bounds:
+        for op in live_ops(formula):
+            print("{:<24} ≤ {}".format(op.describe(), fmt_bound(op.bounds)))
+        print("{} kernel calls, {} scratch slots, {} instructions per limb "
+              "outside of the kernels".format(len(prog.kernels), prog.num_slots,
+                                              sum(len(p.code.body) for p in prog.phases)))
+    elif args.check:
+        check(prog, args.check, random.Random(1))
+        print("{}: {} runs OK".format(formula.macro, args.check))
+    else:
+        render(prog, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,212 @@
+/*
+    Hashing to the curve (see hash_to_curve.h).
+
+    The single map uses the fe51 arithmetic, because it is one long chain of
+    dependent operations, which the fe12 code cannot pair up. Only the output
+    is converted to fe12, for the group operations.
+*/
+
+#include "fe51.h"
+#include "hash_to_curve.h"
+#include "mxcsr.h"
+#include "sha512.h"
+#include <string.h>
+
+#define fe51_square(x, y) fe51_nsquare(x, y, 1)
+
+// sqrt(-1) = 2^((p - 1) / 4)
+static const fe51 sqrtm1 = {{
+    0x61b274a0ea0b0, 0xd5a5fc8f189d, 0x7ef5e9cbd0c60, 0x78595a6804c9e, 0x2b8324804fc1d
+}};
+// sqrt(sqrt(-1) * Z^3), which turns a root of -sqrt(-1) * U / V into a root of
+// g(x2) = Z^3 * u^6 * U / V (after multiplying by u^3)
+static const fe51 sqrt_i_z3 = {{
+    0x4364e941d4162, 0x1ab4bf91e313b, 0x7debd397a18c0, 0x70b2b4d00993d, 0x570649009f83b
+}};
+// Z * A = -6
+static const fe51 z_times_a = {{
+    0x7ffffffffffe7, 0x7ffffffffffff, 0x7ffffffffffff, 0x7ffffffffffff, 0x7ffffffffffff
+}};
+static const fe51 zero = {{0, 0, 0, 0, 0}};
+static const fe51 one = {{1, 0, 0, 0, 0}};
+
+/*
+expand_message_xmd from RFC 9380, with SHA-512, for 96 output bytes (two
+field elements of 48 bytes each)
+*/
+static int expand_message(uint8_t out[96], const uint8_t *msg, size_t msg_len,
+                          const uint8_t *dst, size_t dst_len)
+{
+    static const uint8_t z_pad[128] = {0};
+    // I2OSP(96, 2) || I2OSP(0, 1)
+    static const uint8_t l_i_b_str[3] = {0, 96, 0};
+    uint8_t b0[64], bi[64], t[64];
+    sha512_state st;
+
+    if (dst_len > 255) return -1;
+    const uint8_t dst_len_byte = (uint8_t)dst_len;
+
+    sha512_init(&st);
+    sha512_update(&st, z_pad, sizeof(z_pad));
+    sha512_update(&st, msg, msg_len);
+    sha512_update(&st, l_i_b_str, sizeof(l_i_b_str));
+    sha512_update(&st, dst, dst_len);
+    sha512_update(&st, &dst_len_byte, 1);
+    sha512_final(&st, b0);
+
+    memset(bi, 0, sizeof(bi));
+    for (uint8_t i = 1; i <= 2; i++) {
+        // b_1 = H(b_0 || 1 || DST'), b_i = H((b_0 ^ b_(i-1)) || i || DST')
+        for (unsigned int j = 0; j < 64; j++) t[j] = b0[j] ^ bi[j];
+        sha512_init(&st);
+        sha512_update(&st, t, sizeof(t));
+        sha512_update(&st, &i, 1);
+        sha512_update(&st, dst, dst_len);
+        sha512_update(&st, &dst_len_byte, 1);
+        sha512_final(&st, bi);
+        memcpy(&out[64 * (i - 1)], bi, i == 1 ? 64 : 32);
+    }
+    return 0;
+}
+
+int hash_to_field(uint8_t u[2][32], const uint8_t *msg, size_t msg_len,
+                  const uint8_t *dst, size_t dst_len)
+{
+    uint8_t uniform[96];
+    if (expand_message(uniform, msg, msg_len, dst, dst_len) != 0) return -1;
+
+    for (unsigned int k = 0; k < 2; k++) {
+        // The 48 bytes are a big endian integer v = lo + 2^255 * hi, and
+        // 2^255 = 19 (mod p)
+        uint8_t le[49] = {0}, hi_bytes[32] = {0};
+        fe51 lo, hi;
+        for (unsigned int i = 0; i < 48; i++) le[i] = uniform[48*k + 47 - i];
+        for (unsigned int i = 0; i < 17; i++) {
+            hi_bytes[i] = (uint8_t)((le[31 + i] >> 7) | (le[32 + i] << 1));
+        }
+        fe51_frombytes(&lo, le);
+        fe51_frombytes(&hi, hi_bytes);
+        fe51_mul_small(&hi, &hi, 19);
+        fe51_add(&lo, &lo, &hi);
+        fe51_pack(u[k], &lo);
+    }
+    return 0;
+}
+
+// Return 1 if f == g (mod p), and 0 otherwise
+static uint64_t equal(const fe51 *f, const fe51 *g)
+{
+    uint8_t f_bytes[32], g_bytes[32];
+    unsigned int diff = 0;
+    fe51_pack(f_bytes, f);
+    fe51_pack(g_bytes, g);
+    for (unsigned int i = 0; i < 32; i++) diff |= f_bytes[i] ^ g_bytes[i];
+    return ((diff - 1) >> 8) & 1;
+}
+
+// The parity of the canonical value of f
+static uint64_t sgn0(const fe51 *f)
+{
+    uint8_t bytes[32];
+    fe51_pack(bytes, f);
+    return bytes[0] & 1;
+}
+
+void ge_map_to_curve(ge point, const uint8_t *u_bytes)
+{
+    fe51 u, tv, tv2, n, d, d2, gx, v, t, r, e, neg_gx, i_gx, y, x;
+    uint8_t bytes[32];
+
+    fe51_frombytes(&u, u_bytes);
+
+    // tv = Z * u^2, with Z = 2
+    fe51_square(&tv, &u);
+    fe51_add(&tv, &tv, &tv);
+    // x1 = N / D, with N = B * (tv^2 + tv + 1) and D = -A * (tv^2 + tv), or
+    // D = Z * A if tv^2 + tv == 0
+    fe51_square(&tv2, &tv);
+    fe51_add(&tv2, &tv2, &tv);
+    fe51_add(&n, &tv2, &one);
+    fe51_mul_small(&n, &n, 13318);
+    fe51_mul_small(&d, &tv2, 3);
+    fe51_cmov(&d, &z_times_a, equal(&tv2, &zero));
+
+    // g(x1) = U / V, with U = N * (N^2 - 3 * D^2) + B * D^3 and V = D^3
+    fe51_square(&d2, &d);
+    fe51_square(&gx, &n);
+    fe51_mul_small(&t, &d2, 3);
+    fe51_sub(&gx, &gx, &t);
+    fe51_mul(&gx, &gx, &n);
+    fe51_mul(&v, &d2, &d);
+    fe51_mul_small(&t, &v, 13318);
+    fe51_add(&gx, &gx, &t);
+
+    // r = U * V^3 * (U * V^7)^((p - 5) / 8), and e = r^2 * V, which is U
+    // times a fourth root of unity
+    fe51_square(&t, &v);
+    fe51_mul(&t, &t, &v);           // V^3
+    fe51_mul(&r, &t, &gx);          // U * V^3
+    fe51_square(&t, &t);
+    fe51_mul(&t, &t, &v);           // V^7
+    fe51_mul(&t, &t, &gx);          // U * V^7
+    fe51_pow2523(&t, &t);
+    fe51_mul(&r, &r, &t);
+    fe51_square(&e, &r);
+    fe51_mul(&e, &e, &v);
+
+    // If e == U or e == -U, g(x1) is a square, and its root is r or
+    // r * sqrt(-1). Otherwise e == +-sqrt(-1) * U, and the root of
+    // g(x2) = tv^3 * g(x1) is r * u^3 * sqrt(sqrt(-1) * Z^3), times sqrt(-1)
+    // if e == sqrt(-1) * U.
+    fe51_sub(&neg_gx, &zero, &gx);
+    fe51_mul(&i_gx, &gx, &sqrtm1);
+    const uint64_t is_square = equal(&e, &gx) | equal(&e, &neg_gx);
+    const uint64_t times_i = equal(&e, &neg_gx) | equal(&e, &i_gx);
+
+    fe51_square(&t, &u);
+    fe51_mul(&t, &t, &u);
+    fe51_mul(&t, &t, &sqrt_i_z3);
+    fe51_mul(&t, &t, &r);
+    y = r;
+    fe51_cmov(&y, &t, is_square ^ 1);
+    fe51_mul(&t, &y, &sqrtm1);
+    fe51_cmov(&y, &t, times_i);
+    fe51_mul(&x, &tv, &n);
+    fe51_cmov(&x, &n, is_square);
+
+    // Make the sign of y match the sign of u
+    fe51_sub(&t, &zero, &y);
+    fe51_cmov(&y, &t, sgn0(&u) ^ sgn0(&y));
+
+    // The point is (x : y * D : D)
+    fe51_mul(&y, &y, &d);
+    fe51_pack(bytes, &x);
+    fe12_frombytes(point[0], bytes);
+    fe51_pack(bytes, &y);
+    fe12_frombytes(point[1], bytes);
+    fe51_pack(bytes, &d);
+    fe12_frombytes(point[2], bytes);
+}
+
+int ge_hash_to_curve(ge point, const uint8_t *msg, size_t msg_len,
+                     const uint8_t *dst, size_t dst_len)
+{
+    uint8_t u[2][32];
+    ge q0, q1;
+    if (hash_to_field(u, msg, msg_len, dst, dst_len) != 0) return -1;
+    ge_map_to_curve(q0, u[0]);
+    ge_map_to_curve(q1, u[1]);
+    ge_add_sse2(point, q0, q1);
+    return 0;
+}
+
+int hash_to_curve(uint8_t *out, const uint8_t *msg, size_t msg_len,
+                  const uint8_t *dst, size_t dst_len)
+{
+    ge point;
+    const unsigned int saved_mxcsr = replace_mxcsr();
+    int err = ge_hash_to_curve(point, msg, msg_len, dst, dst_len);
+    if (err == 0) ge_tobytes(out, point);
+    if (!restore_mxcsr(saved_mxcsr)) err = -1;
+    return err;
+}
@@ -0,0 +1,111 @@
+/*
+Hashing to E : y^2 = x^3 - 3*x + 13318
+
+This follows the hash_to_curve construction of RFC 9380, with:
+
+  - expand_message_xmd with SHA-512, which expands the message into two
+    48-byte strings, that are reduced modulo p into the field elements u0 and
+    u1 (hash_to_field);
+  - the simplified Shallue-van de Woestijne-Ulas (SSWU) map, with Z = 2 (the
+    value that the `find_z_sswu` procedure of the RFC finds for this curve);
+  - Q0 = map(u0) and Q1 = map(u1), and the output is Q0 + Q1. E has a prime
+    order, so there is no cofactor to clear.
+
+`dst` is the domain separation tag of the application, at most 255 bytes.
+
+The map works in projective coordinates, so it does not need an inversion:
+with x = N / D, the square root and the inversion of the RFC's `sqrt_ratio`
+are a single exponentiation (U*V^7)^((p - 5) / 8). Because p = 5 (mod 8), the
+outcome is a root of U / V times one of the fourth roots of unity, which tells
+which of the two candidate x coordinates to use. All functions in this file
+run in constant time, in the message as well as in the output.
+*/
+
+#ifndef CURVE13318_HASH_TO_CURVE_H_
+#define CURVE13318_HASH_TO_CURVE_H_
+
+#include "ge.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define hash_to_curve crypto_scalarmult_curve13318_hash_to_curve
+#define hash_to_curve_x4 crypto_scalarmult_curve13318_hash_to_curve_x4
+#define hash_to_field crypto_scalarmult_curve13318_ref12_hash_to_field
+#define ge_map_to_curve crypto_scalarmult_curve13318_ref12_ge_map_to_curve
+#define ge_map_to_curve_x4 crypto_scalarmult_curve13318_ref12_ge_map_to_curve_x4
+#define ge_hash_to_curve crypto_scalarmult_curve13318_ref12_ge_hash_to_curve
+#define ge_hash_to_curve_x4 crypto_scalarmult_curve13318_ref12_ge_hash_to_curve_x4
+
+/*
+Hash a message to a point on the curve
+
+Arguments:
+  - out      Output point (64 bytes, encoded like the input of `scalarmult`)
+  - msg      The message
+  - msg_len  The length of the message in bytes
+  - dst      The domain separation tag
+  - dst_len  The length of the tag in bytes (at most 255)
+Returns:
+  0 on succes, nonzero on failure
+*/
+int hash_to_curve(uint8_t *out, const uint8_t *msg, size_t msg_len,
+                  const uint8_t *dst, size_t dst_len);
+
+/*
+Hash four messages to the points `out[0]`..`out[3]`, with the same tag. On
+CPUs with AVX this is `ge_hash_to_curve_x4`, and otherwise it calls
+`hash_to_curve` four times.
+
+Returns:
+  0 on succes, nonzero on failure
+*/
+int hash_to_curve_x4(uint8_t out[4][64], const uint8_t *const msgs[4],
+                     const size_t msg_lens[4], const uint8_t *dst, size_t dst_len);
+
+/*
+Compute the two field elements u0 and u1 for a message, as 32-byte canonical
+encodings
+
+Returns:
+  0 on succes, nonzero if the tag is too long
+*/
+int hash_to_field(uint8_t u[2][32], const uint8_t *msg, size_t msg_len,
+                  const uint8_t *dst, size_t dst_len);
+
+/*
+Map the field element u (32 bytes, the 255'th bit is ignored) to a point with
+the SSWU map. The output is squeezed, so it can go straight into the group
+operations and the ladders.
+*/
+void ge_map_to_curve(ge point, const uint8_t *u);
+
+/*
+Same as `ge_map_to_curve`, for four field elements at once: lane i of `point`
+is the map of `u[i]`. All the field arithmetic, including the exponentiation,
+runs on the four lanes at once. Only use this function on CPUs that support
+AVX.
+*/
+void ge_map_to_curve_x4(ge_x4 point, const uint8_t u[4][32]);
+
+/*
+Hash a message to a projective point, like `hash_to_curve`. The MxCsr
+register must have been replaced (see mxcsr.h).
+
+Returns:
+  0 on succes, nonzero on failure
+*/
+int ge_hash_to_curve(ge point, const uint8_t *msg, size_t msg_len,
+                     const uint8_t *dst, size_t dst_len);
+
+/*
+Hash four messages to four projective points, with `ge_map_to_curve_x4` and
+`ge_add_x4`. The MxCsr register must have been replaced (see mxcsr.h). Only
+use this function on CPUs that support AVX.
+
+Returns:
+  0 on succes, nonzero on failure
+*/
+int ge_hash_to_curve_x4(ge point[4], const uint8_t *const msgs[4],
+                        const size_t msg_lens[4], const uint8_t *dst, size_t dst_len);
+
+#endif /* CURVE13318_HASH_TO_CURVE_H_ */
@@ -0,0 +1,222 @@
+/*
+    The 4-way hash to curve (see hash_to_curve.h).
+
+    This is the same map as `ge_map_to_curve`, step by step, with every fe51
+    value replaced by four fe12 values in the lanes of a fe12x4. So the four
+    exponentiations run at once, and so do all the other multiplications. The
+    only per-lane code is in the comparisons, which need the canonical
+    encodings, so every comparison is a single zero check of a difference.
+    This file must be compiled with AVX enabled.
+*/
+
+#include "fe12x4_intrin.h"
+#include "hash_to_curve.h"
+
+typedef __m256d vec;
+
+// sqrt(-1) and sqrt(sqrt(-1) * Z^3), see hash_to_curve.c
+static const fe12 sqrtm1 = {
+    958640, 826664 * 0x1p22, 1613251 * 0x1p43, 1041528 * 0x1p64,
+    13673 * 0x1p85, 387171 * 0x1p107, 1824679 * 0x1p128,
+    313839 * 0x1p149, 709440 * 0x1p170, 122635 * 0x1p192,
+    262782 * 0x1p213, 712905 * 0x1p234
+};
+static const fe12 sqrt_i_z3 = {
+    1917282, 1653328 * 0x1p22, 1129350 * 0x1p43, 2083057 * 0x1p64,
+    27346 * 0x1p85, 774342 * 0x1p107, 1552206 * 0x1p128,
+    627679 * 0x1p149, 1418880 * 0x1p170, 245270 * 0x1p192,
+    525564 * 0x1p213, 1425810 * 0x1p234
+};
+
+static inline void load(vec dest[12], const fe12x4 src)
+{
+    for (unsigned int i = 0; i < 12; i++) dest[i] = _mm256_load_pd(src[i]);
+}
+
+static inline void store(fe12x4 dest, const vec src[12])
+{
+    for (unsigned int i = 0; i < 12; i++) _mm256_store_pd(dest[i], src[i]);
+}
+
+static inline void broadcast(vec dest[12], const fe12 src)
+{
+    for (unsigned int i = 0; i < 12; i++) dest[i] = _mm256_set1_pd(src[i]);
+}
+
+static inline void add(vec z[12], const vec lhs[12], const vec rhs[12])
+{
+    for (unsigned int i = 0; i < 12; i++) z[i] = _mm256_add_pd(lhs[i], rhs[i]);
+}
+
+// z = lhs - rhs, squeezed
+static inline void sub(vec z[12], const vec lhs[12], const vec rhs[12])
+{
+    for (unsigned int i = 0; i < 12; i++) z[i] = _mm256_sub_pd(lhs[i], rhs[i]);
+    fe12x4_squeeze_intrin(z);
+}
+
+// z = n * f, squeezed
+static inline void mul_small(vec z[12], const vec f[12], double n)
+{
+    const vec nv = _mm256_set1_pd(n);
+    for (unsigned int i = 0; i < 12; i++) z[i] = _mm256_mul_pd(nv, f[i]);
+    fe12x4_squeeze_intrin(z);
+}
+
+static inline void neg(vec z[12], const vec f[12])
+{
+    for (unsigned int i = 0; i < 12; i++) z[i] = _mm256_sub_pd(_mm256_setzero_pd(), f[i]);
+}
+
+// Lane i of `dest` becomes lane i of `src` if c[i] == 1
+static void cmov(vec dest[12], const vec src[12], const uint8_t c[4])
+{
+    fe12x4 __attribute__((aligned(32))) f, g;
+    store(f, dest);
+    store(g, src);
+    fe12x4_select(f, f, g, c);
+    load(dest, f);
+}
+
+// Set c[lane] to 1 if lane `lane` of `f` is zero (mod p), and to 0 otherwise
+static void is_zero(uint8_t c[4], const vec f[12])
+{
+    fe12x4 __attribute__((aligned(32))) f_mem;
+    uint8_t bytes[4][32];
+    store(f_mem, f);
+    fe12x4_tobytes(bytes, f_mem);
+    for (unsigned int lane = 0; lane < 4; lane++) {
+        unsigned int nonzero = 0;
+        for (unsigned int i = 0; i < 32; i++) nonzero |= bytes[lane][i];
+        c[lane] = ((nonzero - 1) >> 8) & 1;
+    }
+}
+
+// The parity of the canonical value of every lane
+static void sgn0(uint8_t s[4], const vec f[12])
+{
+    fe12x4 __attribute__((aligned(32))) f_mem;
+    uint8_t bytes[4][32];
+    store(f_mem, f);
+    fe12x4_tobytes(bytes, f_mem);
+    for (unsigned int lane = 0; lane < 4; lane++) s[lane] = bytes[lane][0] & 1;
+}
+
+#define mul fe12x4_mul_intrin
+#define square fe12x4_square_intrin
+
+void ge_map_to_curve_x4(ge_x4 point, const uint8_t u_bytes[4][32])
+{
+    fe12x4 __attribute__((aligned(32))) mem;
+    vec u[12], tv[12], tv2[12], n[12], d[12], d2[12], gx[12], v[12], t[12];
+    vec r[12], e[12], i_gx[12], y[12], x[12], c[12];
+    uint8_t tv2_zero[4], is_square[4], is_neg[4], is_i[4], times_i[4];
+    uint8_t is_nonsquare[4], sgn_u[4], sgn_y[4], flip[4];
+
+    fe12x4_frombytes(mem, u_bytes);
+    load(u, mem);
+
+    // tv = Z * u^2, with Z = 2
+    square(tv, u);
+    add(tv, tv, tv);
+    fe12x4_squeeze_intrin(tv);
+    // N = B * (tv^2 + tv + 1), D = -A * (tv^2 + tv) or Z * A
+    square(tv2, tv);
+    add(tv2, tv2, tv);
+    fe12x4_squeeze_intrin(tv2);
+    for (unsigned int i = 0; i < 12; i++) n[i] = tv2[i];
+    n[0] = _mm256_add_pd(n[0], _mm256_set1_pd(1));
+    mul_small(n, n, 13318);
+    mul_small(d, tv2, 3);
+    for (unsigned int i = 0; i < 12; i++) c[i] = _mm256_setzero_pd();
+    c[0] = _mm256_set1_pd(-6);
+    is_zero(tv2_zero, tv2);
+    cmov(d, c, tv2_zero);
+
+    // U = N * (N^2 - 3 * D^2) + B * D^3, V = D^3
+    square(d2, d);
+    square(gx, n);
+    mul_small(t, d2, 3);
+    sub(gx, gx, t);
+    mul(gx, gx, n);
+    mul(v, d2, d);
+    mul_small(t, v, 13318);
+    add(gx, gx, t);
+    fe12x4_squeeze_intrin(gx);
+
+    // r = U * V^3 * (U * V^7)^((p - 5) / 8), e = r^2 * V
+    square(t, v);
+    mul(t, t, v);
+    mul(r, t, gx);
+    square(t, t);
+    mul(t, t, v);
+    mul(t, t, gx);
+    store(mem, t);
+    fe12x4_pow2523(mem, mem);
+    load(t, mem);
+    mul(r, r, t);
+    square(e, r);
+    mul(e, e, v);
+
+    // Pick the root like `ge_map_to_curve`
+    broadcast(c, sqrtm1);
+    mul(i_gx, gx, c);
+    sub(t, e, gx);
+    is_zero(is_square, t);
+    add(t, e, gx);
+    fe12x4_squeeze_intrin(t);
+    is_zero(is_neg, t);
+    sub(t, e, i_gx);
+    is_zero(is_i, t);
+    for (unsigned int lane = 0; lane < 4; lane++) {
+        is_square[lane] |= is_neg[lane];
+        is_nonsquare[lane] = is_square[lane] ^ 1;
+        times_i[lane] = is_neg[lane] | is_i[lane];
+    }
+
+    square(t, u);
+    mul(t, t, u);
+    broadcast(c, sqrt_i_z3);
+    mul(t, t, c);
+    mul(t, t, r);
+    for (unsigned int i = 0; i < 12; i++) y[i] = r[i];
+    cmov(y, t, is_nonsquare);
+    broadcast(c, sqrtm1);
+    mul(t, y, c);
+    cmov(y, t, times_i);
+    mul(x, tv, n);
+    cmov(x, n, is_square);
+
+    // Make the sign of y match the sign of u
+    sgn0(sgn_u, u);
+    sgn0(sgn_y, y);
+    for (unsigned int lane = 0; lane < 4; lane++) flip[lane] = sgn_u[lane] ^ sgn_y[lane];
+    neg(t, y);
+    cmov(y, t, flip);
+
+    // The points are (x : y * D : D)
+    mul(y, y, d);
+    store(point[0], x);
+    store(point[1], y);
+    store(point[2], d);
+}
+
+int ge_hash_to_curve_x4(ge point[4], const uint8_t *const msgs[4],
+                        const size_t msg_lens[4], const uint8_t *dst, size_t dst_len)
+{
+    ge_x4 __attribute__((aligned(32))) q0, q1;
+    uint8_t u[2][4][32];
+
+    for (unsigned int lane = 0; lane < 4; lane++) {
+        uint8_t u_lane[2][32];
+        if (hash_to_field(u_lane, msgs[lane], msg_lens[lane], dst, dst_len) != 0) return -1;
+        for (unsigned int k = 0; k < 2; k++) {
+            for (unsigned int i = 0; i < 32; i++) u[k][lane][i] = u_lane[k][i];
+        }
+    }
+    ge_map_to_curve_x4(q0, (const uint8_t (*)[32])u[0]);
+    ge_map_to_curve_x4(q1, (const uint8_t (*)[32])u[1]);
+    ge_add_x4(q0, q0, q1);
+    ge_x4_store(point, q0);
+    return 0;
+}
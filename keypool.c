@@ -0,0 +1,220 @@
+/*
+    The key pair pool (see keypool.h).
+
+    The queue is a bounded ring in the style of Dmitry Vyukov's MPMC queue:
+    every slot has a sequence number, which says whether the slot is ready to
+    be written (seq == pos) or to be read (seq == pos + 1) for the position
+    `pos` that maps to it. The refill thread is the only producer, but any
+    number of threads can pop.
+*/
+
+#define _DEFAULT_SOURCE
+#include "keypool.h"
+#include "scalarmult.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+
+struct slot {
+    uint64_t seq;
+    uint8_t secret_key[32];
+    uint8_t public_key[64];
+};
+
+struct keypool {
+    struct slot *slots;
+    uint64_t mask;              // The number of slots minus 1
+    uint64_t head;              // The next position to push to
+    uint64_t tail;              // The next position to pop from
+    unsigned int low, high;
+    uint8_t base[64];
+    pthread_t thread;
+    pthread_mutex_t lock;       // Only protects the wake up of the thread
+    pthread_cond_t wake;
+    bool stop;
+};
+
+// Wipe secret data, in a way that the compiler does not optimize away
+static void wipe(void *p, size_t len)
+{
+    volatile uint8_t *v = p;
+    for (size_t i = 0; i < len; i++) v[i] = 0;
+}
+
+// The number of key pairs that the refill thread makes with one call to
+// `scalarmult_many`, which shares the table of the base point between them
+#define REFILL_BATCH 16
+
+// Fill `len` bytes of secret keys with randomness
+static int random_keys(uint8_t (*secret_keys)[32], size_t len)
+{
+    uint8_t *p = (uint8_t *)secret_keys;
+    size_t filled = 0;
+    while (filled < 32 * len) {
+        const ssize_t ret = getrandom(p + filled, 32 * len - filled, 0);
+        if (ret < 0) {
+            wipe(p, 32 * len);
+            return -1;
+        }
+        filled += (size_t)ret;
+    }
+    // `scalarmult` does not use the 255'th bit
+    for (size_t i = 0; i < len; i++) secret_keys[i][31] &= 0x7F;
+    return 0;
+}
+
+int keypair(uint8_t *secret_key, uint8_t *public_key, const uint8_t *base)
+{
+    if (random_keys((uint8_t (*)[32])secret_key, 1) != 0) return -1;
+    return scalarmult(public_key, secret_key, base);
+}
+
+// Push a key pair, returns false if the pool is full
+static bool push(struct keypool *pool, const uint8_t *secret_key, const uint8_t *public_key)
+{
+    const uint64_t pos = __atomic_load_n(&pool->head, __ATOMIC_RELAXED);
+    struct slot *slot = &pool->slots[pos & pool->mask];
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos) return false;
+    memcpy(slot->secret_key, secret_key, 32);
+    memcpy(slot->public_key, public_key, 64);
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&pool->head, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Pop a key pair and wipe its slot, returns false if the pool is empty
+static bool pop(struct keypool *pool, uint8_t *secret_key, uint8_t *public_key)
+{
+    uint64_t pos = __atomic_load_n(&pool->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        struct slot *slot = &pool->slots[pos & pool->mask];
+        const uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        const int64_t diff = (int64_t)(seq - (pos + 1));
+        if (diff < 0) return false;
+        if (diff > 0) {
+            // Another thread took this slot, try again at the new tail
+            pos = __atomic_load_n(&pool->tail, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&pool->tail, &pos, pos + 1, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            memcpy(secret_key, slot->secret_key, 32);
+            memcpy(public_key, slot->public_key, 64);
+            wipe(slot->secret_key, 32);
+            wipe(slot->public_key, 64);
+            __atomic_store_n(&slot->seq, pos + pool->mask + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+        // On failure, `pos` now holds the current tail
+    }
+}
+
+unsigned int keypool_available(struct keypool *pool)
+{
+    const uint64_t tail = __atomic_load_n(&pool->tail, __ATOMIC_ACQUIRE);
+    const uint64_t head = __atomic_load_n(&pool->head, __ATOMIC_ACQUIRE);
+    return head > tail ? (unsigned int)(head - tail) : 0;
+}
+
+static void *refill(void *arg)
+{
+    struct keypool *pool = arg;
+    uint8_t secret_keys[REFILL_BATCH][32], public_keys[REFILL_BATCH][64];
+
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stop) {
+        if (keypool_available(pool) >= pool->high) {
+            // Full, so sleep until the pool drops to the low watermark
+            while (!pool->stop && keypool_available(pool) > pool->low) {
+                pthread_cond_wait(&pool->wake, &pool->lock);
+            }
+            continue;
+        }
+        unsigned int len = pool->high - keypool_available(pool);
+        if (len > REFILL_BATCH) len = REFILL_BATCH;
+        pthread_mutex_unlock(&pool->lock);
+        int err = random_keys(secret_keys, len);
+        if (err == 0) {
+            err = scalarmult_many(public_keys, (const uint8_t (*)[32])secret_keys,
+                                  pool->base, len);
+        }
+        if (err == 0) {
+            for (unsigned int i = 0; i < len; i++) {
+                if (!push(pool, secret_keys[i], public_keys[i])) break;
+            }
+        }
+        wipe(secret_keys, sizeof(secret_keys));
+        pthread_mutex_lock(&pool->lock);
+        // Without randomness we cannot do anything; `keypool_pop` will fail
+        // in the same way when it generates its key pairs inline
+        if (err != 0) break;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+struct keypool *keypool_new(const uint8_t *base, unsigned int low, unsigned int high)
+{
+    uint8_t secret_key[32], public_key[64];
+    if (low >= high) return NULL;
+
+    // Check the base point once, so that the refill thread cannot fail on it
+    const int err = keypair(secret_key, public_key, base);
+    wipe(secret_key, 32);
+    if (err != 0) return NULL;
+
+    struct keypool *pool = calloc(1, sizeof(*pool));
+    if (pool == NULL) return NULL;
+    uint64_t size = 1;
+    while (size < high) size <<= 1;
+    pool->slots = calloc(size, sizeof(*pool->slots));
+    if (pool->slots == NULL) {
+        free(pool);
+        return NULL;
+    }
+    for (uint64_t i = 0; i < size; i++) pool->slots[i].seq = i;
+    pool->mask = size - 1;
+    pool->low = low;
+    pool->high = high;
+    memcpy(pool->base, base, 64);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    if (pthread_create(&pool->thread, NULL, refill, pool) != 0) {
+        pthread_cond_destroy(&pool->wake);
+        pthread_mutex_destroy(&pool->lock);
+        free(pool->slots);
+        free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+int keypool_pop(struct keypool *pool, uint8_t *secret_key, uint8_t *public_key)
+{
+    const bool popped = pop(pool, secret_key, public_key);
+    if (keypool_available(pool) <= pool->low) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_signal(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    if (!popped) return keypair(secret_key, public_key, pool->base);
+    return 0;
+}
+
+void keypool_free(struct keypool *pool)
+{
+    if (pool == NULL) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    pthread_join(pool->thread, NULL);
+
+    wipe(pool->slots, (pool->mask + 1) * sizeof(*pool->slots));
+    free(pool->slots);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
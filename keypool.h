@@ -0,0 +1,74 @@
+/*
+A pool of precomputed ephemeral key pairs
+
+Generating an ephemeral key pair costs a full scalar multiplication. A pool
+moves that cost off the critical path of a handshake: a background thread
+keeps the pool filled with (secret, public) pairs, and `keypool_pop` only has
+to take one out. Every pair is handed out exactly once, and its slot is wiped
+as soon as it is taken. If the pool is empty, `keypool_pop` generates a pair
+inline, so it never waits for the refill thread.
+
+The pool refills up to `high` pairs, and then waits until `low` or fewer are
+left, so that the refill thread does not wake up for every single pop. The
+queue itself is lock-free; a mutex is only taken to wake up the refill
+thread. `keypool_pop` may be called from multiple threads at once.
+*/
+
+#ifndef CURVE13318_KEYPOOL_H_
+#define CURVE13318_KEYPOOL_H_
+
+#include <stdint.h>
+
+#define keypair crypto_scalarmult_curve13318_keypair
+#define keypool_new crypto_scalarmult_curve13318_keypool_new
+#define keypool_pop crypto_scalarmult_curve13318_keypool_pop
+#define keypool_available crypto_scalarmult_curve13318_keypool_available
+#define keypool_free crypto_scalarmult_curve13318_keypool_free
+
+struct keypool;
+
+/*
+Generate a fresh key pair: a random secret key (from the OS) and its public
+key `secret_key * base`, using `scalarmult`.
+
+Arguments:
+  - secret_key  Output secret key (32 bytes, the 255'th bit is cleared)
+  - public_key  Output public key (64 bytes)
+  - base        The base point (64 bytes)
+Returns:
+  0 on succes, nonzero on failure
+*/
+int keypair(uint8_t *secret_key, uint8_t *public_key, const uint8_t *base);
+
+/*
+Create a pool of key pairs for base point `base`, and start its refill
+thread. It must hold that 0 <= low < high.
+
+Returns:
+  The new pool, or NULL on failure (e.g. if `base` is not a valid point)
+*/
+struct keypool *keypool_new(const uint8_t *base, unsigned int low, unsigned int high);
+
+/*
+Take a key pair out of the pool, or generate one inline if the pool is empty
+
+Arguments:
+  - pool        The pool
+  - secret_key  Output secret key (32 bytes)
+  - public_key  Output public key (64 bytes)
+Returns:
+  0 on succes, nonzero on failure
+*/
+int keypool_pop(struct keypool *pool, uint8_t *secret_key, uint8_t *public_key);
+
+/*
+Return the number of key pairs that are currently in the pool
+*/
+unsigned int keypool_available(struct keypool *pool);
+
+/*
+Stop the refill thread, wipe all key pairs that are left, and free the pool
+*/
+void keypool_free(struct keypool *pool);
+
+#endif /* CURVE13318_KEYPOOL_H_ */
@@ -2,8 +2,8 @@
 ;
 ; Author: Daan Sprenkels <hello@dsprenkels.com>
 
-%include "ge_add.mac"
-%include "ge_double.mac"
+%include "ge_add_gen.mac"
+%include "ge_double_gen.mac"
 %include "select.mac"
 
 global crypto_scalarmult_curve13318_ref12_ladder
@@ -17,7 +17,15 @@ crypto_scalarmult_curve13318_ref12_ladder:
     ;   uint8_t *windows:   [rsi]
     ;   ge ptable[16]:      [rdx]
     ;
-    %xdefine stack_size 6*384 + 192 + 768
+    ; The scratch space is shared by both group operations, and the point from
+    ; `ptable` is stored right above it.
+    %if ge_add_gen_scratch_size > ge_double_gen_scratch_size
+        %xdefine scratch_size ge_add_gen_scratch_size
+    %else
+        %xdefine scratch_size ge_double_gen_scratch_size
+    %endif
+    %xdefine p          rsp + scratch_size
+    %xdefine stack_size scratch_size + 384
 
     ; prologue
     push rbp
@@ -35,7 +43,7 @@ crypto_scalarmult_curve13318_ref12_ladder:
 .ladderstep:
     xor rbx, rbx
 .ladderstep_double:
-    ge_double rdi, rdi, rsp
+    ge_double_gen rdi, rdi, rsp
     add rbx, 1
     cmp rbx, 5
     jl .ladderstep_double
@@ -75,19 +83,18 @@ crypto_scalarmult_curve13318_ref12_ladder:
     vxorpd ymm4, ymm4, ymm15
     vxorpd ymm5, ymm5, ymm15
     ; save the point to the stack
-    vmovapd [rsp + 5*384], ymm0
-    vmovapd [rsp + 5*384 + 1*32], ymm1
-    vmovapd [rsp + 5*384 + 2*32], ymm2
-    vmovapd [rsp + 5*384 + 3*32], ymm3
-    vmovapd [rsp + 5*384 + 4*32], ymm4
-    vmovapd [rsp + 5*384 + 5*32], ymm5
-    vmovapd [rsp + 5*384 + 6*32], ymm6
-    vmovapd [rsp + 5*384 + 7*32], ymm7
-    vmovapd [rsp + 5*384 + 8*32], ymm8
-    ; put p at [rsp + 5*384] = t5, will be overwritten but we don't care
+    vmovapd [p], ymm0
+    vmovapd [p + 1*32], ymm1
+    vmovapd [p + 2*32], ymm2
+    vmovapd [p + 3*32], ymm3
+    vmovapd [p + 4*32], ymm4
+    vmovapd [p + 5*32], ymm5
+    vmovapd [p + 6*32], ymm6
+    vmovapd [p + 7*32], ymm7
+    vmovapd [p + 8*32], ymm8
 
     ; add q and p into q
-    ge_add rdi, rdi, rsp + 5*384, rsp
+    ge_add_gen rdi, rdi, p, rsp
 
     ; loop repeat
     add rcx, 1
@@ -108,5 +115,5 @@ section .rodata
 select_consts
 fe12x4_mul_consts
 fe12x4_squeeze_consts
-ge_double_consts
-ge_add_consts
+ge_double_gen_consts
+ge_add_gen_consts
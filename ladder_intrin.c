@@ -0,0 +1,416 @@
+/*
+    The AVX ladder in C, with intrinsics instead of NASM macros.
+
+    This implements the `ge_add` (ge_add.mac), `ge_double` (ge_double.mac)
+    and `select` (select.mac) macros and ladder.asm on the interleaved
+    layout. The lanes and the floating point operations are the same as in
+    the assembly, so every intermediate value is exactly the one that the
+    assembly computes, and the bounds that are annotated in the macros hold
+    here too. The variable names (v1, v2, etc.) are the ones in the macros.
+
+    The only exception is the lookup table: the ladder packs it (see
+    `select_packed_il`), so the limbs of the selected point can differ from
+    the ones in the assembly. They represent the same value, though, and stay
+    within the same bounds, so the result is the same.
+
+    Because the group operations and the ladder are in one translation unit,
+    the compiler can inline them and schedule across them. This file must be
+    compiled with AVX enabled. Set INTRIN_CFLAGS (see the Makefile) to retune
+    it for another CPU, e.g. `make INTRIN_CFLAGS=-march=native`.
+*/
+
+#include "fe12x4_intrin.h"
+#include "ge.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef __m256d vec;
+
+#define lo128 _mm256_castpd256_pd128
+#define hi128(x) _mm256_extractf128_pd(x, 1)
+
+// Make a ymm word from two xmm words
+static inline vec combine(__m128d lo, __m128d hi)
+{
+    return _mm256_insertf128_pd(_mm256_castpd128_pd256(lo), hi, 1);
+}
+
+static inline void load(vec dest[12], const ge_interleaved src)
+{
+    for (unsigned int i = 0; i < 12; i++) dest[i] = _mm256_load_pd(src[i]);
+}
+
+static inline void store(ge_interleaved dest, const vec src[12])
+{
+    for (unsigned int i = 0; i < 12; i++) _mm256_store_pd(dest[i], src[i]);
+}
+
+/*
+Double `p` into `p3`, like the `ge_double` macro. The x + z lane of `p` is not
+read. The x + z lane of `p3` is only written if `write_xz` is set, otherwise it
+is left as it was. `p3` may alias `p`.
+*/
+static inline void ge_double_il(vec p3[12], const vec p[12], bool write_xz)
+{
+    // Values that are kept for later go in arrays that are dead at that point,
+    // which keeps the frame small (see `scalarmult_arena`): [y, y, y, 2*x] in
+    // t3, the operands of the second multiplication in t1 and t0, and [v11, v34]
+    // in t2
+    vec t0[12], t1[12], t2[12], t3[12];
+
+    for (unsigned int i = 0; i < 12; i++) {
+        const vec swapped = _mm256_permute2f128_pd(p[i], p[i], 0x01); // [y, z, ??, x]
+        t0[i] = _mm256_permute_pd(p[i], 0xF);                          // [x, x, z, z]
+        t1[i] = _mm256_blend_pd(_mm256_permute_pd(p[i], 0x5), swapped, 0x2); // [x, z, z, y]
+        const __m128d yz = lo128(swapped);
+        const __m128d ax = lo128(p[i]);
+        t3[i] = combine(_mm_movedup_pd(yz),                            // [y, y, y, 2*x]
+                        _mm_blend_pd(_mm_add_pd(ax, ax), yz, 0x1));
+    }
+    fe12x4_mul_intrin(t2, t0, t1);      // [v1, v6, v3, v28] ≤ 1.01 * 2^21
+
+    const vec mulsmall = _mm256_setr_pd(3, 26636, -6659, 3);
+    for (unsigned int i = 0; i < 12; i++) {
+        const vec r = _mm256_mul_pd(_mm256_permute_pd(t2[i], 0x2), mulsmall); // [v24, v18, v8, v17]
+        const __m128d v24v18 = lo128(r), v8v17 = hi128(r);
+        const __m128d v1v6 = lo128(t2[i]), v3v28 = hi128(t2[i]);
+        const __m128d v25v19 = _mm_sub_pd(v24v18, _mm_permute_pd(v8v17, 0x3));
+        const __m128d v20 = _mm_sub_sd(v1v6, _mm_permute_pd(v25v19, 0x1));
+        const __m128d v22 = _mm_mul_sd(v20, _mm_set_sd(-3));
+        const __m128d v9 = _mm_add_sd(v8v17, _mm_permute_pd(v1v6, 0x1));
+        const __m128d v9v28 = _mm_unpacklo_pd(v9, _mm_unpackhi_pd(v3v28, v3v28));
+        const __m128d v22v25 = _mm_unpacklo_pd(v22, v25v19);
+        t0[i] = combine(_mm_mul_pd(v9v28, _mm_setr_pd(-6, 8)), v22v25);
+    }
+    fe12x4_carry_intrin(t0);            // [v11, v34, v22, v25] ≤ 1.36 * 2^21
+
+    for (unsigned int i = 0; i < 12; i++) {
+        const __m128d v22v25 = hi128(t0[i]);
+        const __m128d v28 = _mm_unpackhi_pd(hi128(t2[i]), hi128(t2[i]));
+        const __m128d v29a = _mm_add_sd(v28, v28);
+        t2[i] = _mm256_castpd128_pd256(lo128(t0[i]));                  // [v11, v34, ??, ??]
+        t1[i] = combine(_mm_movedup_pd(v22v25), lo128(t3[i]));         // [v22, v22, y, y]
+        t0[i] = combine(_mm_blend_pd(v22v25, v29a, 0x1), hi128(t3[i])); // [v29a, v25, y, 2*x]
+    }
+    fe12x4_mul_intrin(t3, t1, t0);      // [v30, v26, v2, v5] ≤ 1.01 * 2^21
+
+    for (unsigned int i = 0; i < 12; i++) {
+        const __m128d v2v5 = hi128(t3[i]);
+        const __m128d v11v34 = lo128(t2[i]);
+        const __m128d v12 = _mm_sub_sd(v2v5, v11v34);
+        const __m128d v13 = _mm_add_sd(v2v5, v11v34);
+        t0[i] = combine(v2v5, v12);                                    // [v2, v5, v12, ??]
+        t1[i] = combine(_mm_shuffle_pd(v11v34, v12, 0x1), v13);        // [v34, v12, v13, ??]
+    }
+    fe12x4_mul_intrin(t2, t0, t1);      // [v32, v15, v14, ??] ≤ 1.01 * 2^21
+
+    for (unsigned int i = 0; i < 12; i++) {
+        const __m128d v32v15 = lo128(t2[i]);
+        const __m128d v30v26 = lo128(t3[i]);
+        const __m128d v31 = _mm_sub_sd(_mm_permute_pd(v32v15, 0x1), v30v26);
+        const __m128d v27 = _mm_add_sd(hi128(t2[i]), _mm_permute_pd(v30v26, 0x1));
+        const __m128d xz = _mm_add_sd(v31, v32v15);
+        const vec r = combine(_mm_unpacklo_pd(xz, v31), _mm_unpacklo_pd(v27, v32v15));
+        p3[i] = write_xz ? r : _mm256_blend_pd(p[i], r, 0xE);          // [x3 + z3, x3, y3, z3]
+    }
+}
+
+/*
+Add `p1` and `p2` into `p3`, like the `ge_add` macro. The x + z lanes of `p1`
+and `p2` must be up to date. The x + z lane of `p3` is left as it was in `p1`.
+`p3` may alias `p1` and `p2`.
+*/
+static inline void ge_add_il(vec p3[12], const vec p1[12], const vec p2[12])
+{
+    // Like in `ge_double_il`, values that are kept for later go in arrays that
+    // are dead at that point: [v4, v9, v5, v10] in t1, and the operands of the
+    // second multiplication in t1 and t2. The x + z lane is read from `p1` at
+    // the end.
+    vec t0[12], t1[12], t2[12];
+    __m128d v7v12[12], v38[12];
+
+    for (unsigned int i = 0; i < 12; i++) {
+        const vec s1 = _mm256_permute2f128_pd(p1[i], p1[i], 0x01);
+        const vec s2 = _mm256_permute2f128_pd(p2[i], p2[i], 0x01);
+        t1[i] = combine(hi128(_mm256_add_pd(_mm256_shuffle_pd(s1, p1[i], 0x4), p1[i])),
+                        hi128(_mm256_add_pd(_mm256_shuffle_pd(s2, p2[i], 0x4), p2[i])));
+    }
+    fe12x4_mul_intrin(t2, p1, p2);      // [v16, v1, v2, v3] ≤ 1.01 * 2^21
+
+    const __m128d b = _mm_set_sd(13318);
+    const __m128d three = _mm_set_sd(3);
+    for (unsigned int i = 0; i < 12; i++) {
+        const __m128d v16v1 = lo128(t2[i]), v2v3 = hi128(t2[i]);
+        const __m128d v1v3 = _mm_unpackhi_pd(v16v1, v2v3);
+        const __m128d v3v1 = _mm_permute_pd(v1v3, 0x1);
+        v7v12[i] = _mm_add_pd(_mm_movedup_pd(v2v3), v1v3);
+        const __m128d v17 = _mm_add_sd(v1v3, v3v1);
+        const __m128d v18 = _mm_sub_sd(v16v1, v17);
+        const __m128d v20 = _mm_sub_sd(v18, _mm_mul_sd(v3v1, b));
+        const __m128d v25 = _mm_mul_sd(v18, b);
+        const __m128d v28 = _mm_sub_sd(v25, _mm_mul_sd(v3v1, three));
+        const __m128d v29v34 = _mm_sub_pd(_mm_blend_pd(v3v1, v28, 0x1), v1v3);
+        t0[i] = _mm256_mul_pd(combine(v20, v29v34), _mm256_set1_pd(3));
+    }
+    fe12x4_carry_intrin(t0);            // [v22, ??, v31, v33] ≤ 1.54 * 2^21
+
+    for (unsigned int i = 0; i < 12; i++) {
+        const __m128d v2v3 = hi128(t2[i]);
+        const __m128d v31v33 = hi128(t0[i]);
+        const __m128d v23 = _mm_sub_sd(v2v3, lo128(t0[i]));
+        const __m128d v24 = _mm_add_sd(v2v3, lo128(t0[i]));
+        const __m128d v23v33 = _mm_blend_pd(v31v33, v23, 0x1);
+        const __m128d v24v31 = _mm_blend_pd(_mm_permute_pd(v31v33, 0x1), v24, 0x1);
+        const __m128d v4v9 = lo128(t1[i]), v5v10 = hi128(t1[i]);
+        t1[i] = combine(v23v33, v4v9);                                 // [v23, v33, v4, v9]
+        t2[i] = combine(v24v31, v5v10);                                // [v24, v31, v5, v10]
+        t0[i] = combine(_mm_blend_pd(v23v33, v24v31, 0x1),
+                        _mm_blend_pd(v23v33, v24v31, 0x2));            // [v24, v33, v23, v31]
+    }
+    fe12x4_mul_intrin(t2, t1, t2);      // [v37, v36, v6, v11] ≤ 1.01 * 2^21
+
+    for (unsigned int i = 0; i < 12; i++) {
+        const __m128d v37v36 = lo128(t2[i]);
+        const __m128d v8v13 = _mm_sub_pd(hi128(t2[i]), v7v12[i]);
+        v38[i] = _mm_add_sd(v37v36, _mm_permute_pd(v37v36, 0x1));
+        t1[i] = _mm256_permute_pd(combine(v8v13, v8v13), 0xC);         // [v8, v8, v13, v13]
+    }
+    fe12x4_mul_intrin(t2, t0, t1);      // [v39, v42, v41, v35] ≤ 1.01 * 2^21
+
+    for (unsigned int i = 0; i < 12; i++) {
+        const __m128d v39v42 = lo128(t2[i]), v41v35 = hi128(t2[i]);
+        const __m128d v43 = _mm_add_sd(v41v35, _mm_permute_pd(v39v42, 0x1));
+        const __m128d v40 = _mm_sub_sd(v39v42, _mm_permute_pd(v41v35, 0x1));
+        p3[i] = combine(_mm_unpacklo_pd(lo128(p1[i]), v40), _mm_unpacklo_pd(v38[i], v43));
+    }
+}
+
+/*
+Constant time table lookup, like the `select` macro: `dest` becomes
+`ptable[idx]` for idx < 16, and the neutral element for idx == 31.
+*/
+static inline void select_il(vec dest[12], uint8_t idx, const ge_interleaved ptable[16])
+{
+    for (unsigned int j = 0; j < 12; j++) dest[j] = _mm256_setzero_pd();
+    for (unsigned int i = 0; i < 16; i++) {
+        const uint64_t mask = -((((uint64_t)(idx ^ i)) - 1) >> 63);
+        const vec maskv = _mm256_castsi256_pd(_mm256_set1_epi64x((int64_t)mask));
+        for (unsigned int j = 0; j < 12; j++) {
+            dest[j] = _mm256_add_pd(dest[j], _mm256_and_pd(maskv, _mm256_load_pd(ptable[i][j])));
+        }
+    }
+    const uint64_t neutral = -((((uint64_t)(idx ^ 31)) - 1) >> 63);
+    const vec one = _mm256_setr_pd(0, 0, 1, 0);
+    const vec maskv = _mm256_castsi256_pd(_mm256_set1_epi64x((int64_t)neutral));
+    dest[0] = _mm256_or_pd(dest[0], _mm256_and_pd(maskv, one));
+}
+
+/*
+The same as `select_il`, but on a packed table. Only the selected point is
+unpacked: limb 2*i + 1 is the packed value rounded to a multiple of its
+offset, with the same precisionloss trick as the carry steps, and limb 2*i is
+the rest. Limb 2*i is then at most half its radix, and limb 2*i + 1 differs
+by at most one unit from the one that was packed, so the squeezed bounds
+still hold for every lane.
+
+This scans 16 * 6 instead of 16 * 12 ymm words, i.e. half the memory.
+*/
+static inline void select_packed_il(vec dest[12], uint8_t idx,
+                                    const ge_interleaved_packed ptable[16])
+{
+    static const double precisionloss[6] = {
+        0x3p73, 0x3p115, 0x3p158, 0x3p200, 0x3p243, 0x3p285
+    };
+    vec packed[6];
+    for (unsigned int j = 0; j < 6; j++) packed[j] = _mm256_setzero_pd();
+    for (unsigned int i = 0; i < 16; i++) {
+        const uint64_t mask = -((((uint64_t)(idx ^ i)) - 1) >> 63);
+        const vec maskv = _mm256_castsi256_pd(_mm256_set1_epi64x((int64_t)mask));
+        for (unsigned int j = 0; j < 6; j++) {
+            packed[j] = _mm256_add_pd(packed[j], _mm256_and_pd(maskv, _mm256_load_pd(ptable[i][j])));
+        }
+    }
+    for (unsigned int j = 0; j < 6; j++) {
+        const vec c = _mm256_set1_pd(precisionloss[j]);
+        dest[2*j + 1] = _mm256_sub_pd(_mm256_add_pd(packed[j], c), c);
+        dest[2*j] = _mm256_sub_pd(packed[j], dest[2*j + 1]);
+    }
+    const uint64_t neutral = -((((uint64_t)(idx ^ 31)) - 1) >> 63);
+    const vec one = _mm256_setr_pd(0, 0, 1, 0);
+    const vec maskv = _mm256_castsi256_pd(_mm256_set1_epi64x((int64_t)neutral));
+    dest[0] = _mm256_or_pd(dest[0], _mm256_and_pd(maskv, one));
+}
+
+/*
+Look up the point for window `bits` in the packed table, like ladder.asm:
+
+  |  0 <= bits < 16 : ptable[bits - 1], or the neutral element if bits == 0
+  | 16 <= bits < 32 : -ptable[~bits]
+*/
+static inline void lookup_il(vec p[12], uint8_t bits, const ge_interleaved_packed ptable[16])
+{
+    const uint8_t sign = (bits >> 4) & 1;
+    const uint8_t signmask = -sign;
+    const uint8_t idx = ((signmask & ~bits) | (~signmask & (bits - 1))) & 0x1F;
+
+    // Conditionally negate y by flipping its sign bit
+    select_packed_il(p, idx, ptable);
+    const vec negate = _mm256_castsi256_pd(
+        _mm256_setr_epi64x(0, 0, (int64_t)((uint64_t)sign << 63), 0));
+    for (unsigned int j = 0; j < 12; j++) p[j] = _mm256_xor_pd(p[j], negate);
+}
+
+// The windows of the ladder, on a table that is already packed
+static inline void ladder_packed_il(vec qv[12], const uint8_t *w,
+                                    const ge_interleaved_packed ptable_p[16])
+{
+    vec p[12];
+    for (unsigned int i = 0; i < 51; i++) {
+        // The x + z lane is only needed by the addition
+        for (unsigned int j = 0; j < 4; j++) ge_double_il(qv, qv, false);
+        ge_double_il(qv, qv, true);
+        lookup_il(p, w[i], ptable_p);
+        ge_add_il(qv, qv, p);
+    }
+}
+
+// The same as ladder.asm, and declared the same way in scalarmult.c
+void crypto_scalarmult_curve13318_ref12_ladder_intrin(ge_interleaved q, const uint8_t *w,
+                                                      const ge_interleaved ptable[16])
+{
+    ge_interleaved_packed __attribute__((aligned(32))) ptable_p[16];
+    vec qv[12];
+    for (unsigned int i = 0; i < 16; i++) ge_interleaved_pack(ptable_p[i], ptable[i]);
+    load(qv, q);
+    ladder_packed_il(qv, w, ptable_p);
+    store(q, qv);
+}
+
+/*
+The same ladder, on a table that the caller packed (see `precompute_packed_intrin`).
+Without the table, the frame of the ladder is small, see `scalarmult_arena`.
+*/
+void crypto_scalarmult_curve13318_ref12_ladder_packed_intrin(ge_interleaved q, const uint8_t *w,
+                                                             const ge_interleaved_packed ptable[16])
+{
+    vec qv[12];
+    load(qv, q);
+    ladder_packed_il(qv, w, ptable);
+    store(q, qv);
+}
+
+// Write the x + z lane of `p`
+static inline void update_xz(vec p[12])
+{
+    for (unsigned int i = 0; i < 12; i++) {
+        const vec sum = _mm256_add_pd(p[i], _mm256_permute2f128_pd(p[i], p[i], 0x01)); // [??, x + z, ??, ??]
+        p[i] = _mm256_blend_pd(p[i], _mm256_permute_pd(sum, 0x1), 0x1);
+    }
+}
+
+// Pack `p`, like `ge_interleaved_pack`
+static inline void pack(ge_interleaved_packed dest, const vec p[12])
+{
+    for (unsigned int i = 0; i < 6; i++) _mm256_store_pd(dest[i], _mm256_add_pd(p[2*i], p[2*i + 1]));
+}
+
+/*
+Compute the packed table of the ladder, i.e. ptable[i] = (i + 1) * P, one entry
+after the other: 2P with a doubling, and the others by adding P to the entry
+before them. Unlike `do_precomputation` (scalarmult.c), this does not need any
+unpacked tables or `ge_x4` temporaries, so it is the one that `scalarmult_arena`
+uses. The entries are outputs of the same group operations as in the ladder, so
+the same bounds hold for them.
+*/
+void crypto_scalarmult_curve13318_ref12_precompute_packed_intrin(ge_interleaved_packed ptable[16],
+                                                                 const ge p)
+{
+    vec pv[12], acc[12];
+    for (unsigned int i = 0; i < 12; i++) {
+        pv[i] = _mm256_setr_pd(p[0][i] + p[2][i], p[0][i], p[1][i], p[2][i]);
+    }
+    pack(ptable[0], pv);
+    ge_double_il(acc, pv, true);
+    pack(ptable[1], acc);
+    for (unsigned int i = 2; i < 16; i++) {
+        // The addition leaves the x + z lane of its first operand
+        ge_add_il(acc, acc, pv);
+        update_xz(acc);
+        pack(ptable[i], acc);
+    }
+}
+
+/*
+Two ladders with the same windows, e.g. for k * G and k * Q. Every group
+operation of the one ladder is directly followed by the same operation of the
+other one, so that the CPU can overlap the two independent dependency chains.
+*/
+void crypto_scalarmult_curve13318_ref12_ladder2_intrin(ge_interleaved q1, ge_interleaved q2,
+                                                       const uint8_t *w,
+                                                       const ge_interleaved ptable1[16],
+                                                       const ge_interleaved ptable2[16])
+{
+    ge_interleaved_packed __attribute__((aligned(32))) ptable1_p[16], ptable2_p[16];
+    vec q1v[12], q2v[12], p1[12], p2[12];
+    for (unsigned int i = 0; i < 16; i++) {
+        ge_interleaved_pack(ptable1_p[i], ptable1[i]);
+        ge_interleaved_pack(ptable2_p[i], ptable2[i]);
+    }
+    load(q1v, q1);
+    load(q2v, q2);
+
+    for (unsigned int i = 0; i < 51; i++) {
+        for (unsigned int j = 0; j < 4; j++) {
+            ge_double_il(q1v, q1v, false);
+            ge_double_il(q2v, q2v, false);
+        }
+        ge_double_il(q1v, q1v, true);
+        ge_double_il(q2v, q2v, true);
+        lookup_il(p1, w[i], ptable1_p);
+        lookup_il(p2, w[i], ptable2_p);
+        ge_add_il(q1v, q1v, p1);
+        ge_add_il(q2v, q2v, p2);
+    }
+
+    store(q1, q1v);
+    store(q2, q2v);
+}
+
+void ge_add_intrin(ge p3, const ge p1, const ge p2)
+{
+    ge_interleaved __attribute__((aligned(32))) p1_i, p2_i, p3_i;
+    vec a[12], b[12], r[12];
+    ge_interleave(p1_i, p1);
+    ge_interleave(p2_i, p2);
+    load(a, p1_i);
+    load(b, p2_i);
+    ge_add_il(r, a, b);
+    store(p3_i, r);
+    ge_deinterleave(p3, p3_i);
+}
+
+void select_intrin(ge_interleaved dest, uint8_t idx, const ge_interleaved ptable[16])
+{
+    vec r[12];
+    select_il(r, idx, ptable);
+    store(dest, r);
+}
+
+void select_packed_intrin(ge_interleaved dest, uint8_t idx,
+                          const ge_interleaved_packed ptable[16])
+{
+    vec r[12];
+    select_packed_il(r, idx, ptable);
+    store(dest, r);
+}
+
+void ge_double_intrin(ge p3, const ge p)
+{
+    ge_interleaved __attribute__((aligned(32))) p_i, p3_i;
+    vec a[12], r[12];
+    ge_interleave(p_i, p);
+    load(a, p_i);
+    ge_double_il(r, a, false);
+    store(p3_i, r);
+    ge_deinterleave(p3, p3_i);
+}
@@ -0,0 +1,140 @@
+#include "sc.h"
+
+typedef unsigned __int128 uint128_t;
+
+// The group order n
+static const sc order = {0xeb7d12dc4dc2cbe3, 0xf4f654f83deb8d16, 0, 0x8000000000000000};
+// -n^-1 mod 2^64
+static const uint64_t order_inv = 0x62ed854dc2232e35;
+// 2^512 mod n and 2^768 mod n, to get in and out of the Montgomery domain
+static const sc r2 = {0x92b0f01ab16399ef, 0x64dd34afa710b4bb, 0xd39604ff319863e0, 0x2999fc027d4f7c05};
+static const sc r3 = {0x860c8baf845c455f, 0x635f03dd04e841e4, 0xc1ea3181a1a1d76f, 0x147b0b5167bc4fff};
+static const sc one = {1, 0, 0, 0};
+
+static inline uint64_t load_8(const uint8_t *in)
+{
+    uint64_t ret = 0;
+    for (unsigned int i = 0; i < 8; i++) ret |= (uint64_t)in[i] << (8*i);
+    return ret;
+}
+
+static inline void store_8(uint8_t *out, uint64_t x)
+{
+    for (unsigned int i = 0; i < 8; i++) out[i] = (uint8_t)(x >> (8*i));
+}
+
+// Subtract n from the 257-bit value t if t >= n, where t < 2*n
+static void reduce_once(sc h, const uint64_t t[5])
+{
+    uint64_t d[4], borrow = 0;
+    for (unsigned int i = 0; i < 4; i++) {
+        const uint128_t x = (uint128_t)t[i] - order[i] - borrow;
+        d[i] = (uint64_t)x;
+        borrow = (uint64_t)(x >> 64) & 1;
+    }
+    // All ones if the subtraction borrowed out of the top limb, i.e. t < n
+    const uint64_t keep = (uint64_t)((int64_t)(t[4] - borrow) >> 63);
+    for (unsigned int i = 0; i < 4; i++) h[i] = (t[i] & keep) | (d[i] & ~keep);
+}
+
+// Montgomery multiplication: h = f * g / 2^256 (mod n), for f * g < n * 2^256
+static void montmul(sc h, const sc f, const sc g)
+{
+    uint64_t t[6] = {0};
+    for (unsigned int i = 0; i < 4; i++) {
+        uint128_t c = 0;
+        for (unsigned int j = 0; j < 4; j++) {
+            c += (uint128_t)f[j] * g[i] + t[j];
+            t[j] = (uint64_t)c;
+            c >>= 64;
+        }
+        c += t[4];
+        t[4] = (uint64_t)c;
+        t[5] = (uint64_t)(c >> 64);
+
+        const uint64_t m = t[0] * order_inv;
+        c = ((uint128_t)m * order[0] + t[0]) >> 64;
+        for (unsigned int j = 1; j < 4; j++) {
+            c += (uint128_t)m * order[j] + t[j];
+            t[j-1] = (uint64_t)c;
+            c >>= 64;
+        }
+        c += t[4];
+        t[3] = (uint64_t)c;
+        t[4] = t[5] + (uint64_t)(c >> 64);
+    }
+    reduce_once(h, t);
+}
+
+int sc_frombytes(sc z, const uint8_t *in)
+{
+    sc t;
+    uint64_t borrow = 0;
+    for (unsigned int i = 0; i < 4; i++) {
+        t[i] = load_8(&in[8*i]);
+        borrow = (uint64_t)(((uint128_t)t[i] - order[i] - borrow) >> 64) & 1;
+    }
+    // Any 256-bit value times 2^512 mod n is smaller than n * 2^256
+    montmul(z, t, r2);
+    montmul(z, z, one);
+    return (int)(borrow ^ 1);
+}
+
+void sc_reduce(sc z, const uint8_t *in)
+{
+    // With in = lo + 2^256 * hi, we have in * 2^256 = lo * 2^256 + hi * 2^512
+    sc lo, hi;
+    for (unsigned int i = 0; i < 4; i++) {
+        lo[i] = load_8(&in[8*i]);
+        hi[i] = load_8(&in[32 + 8*i]);
+    }
+    montmul(lo, lo, r2);
+    montmul(hi, hi, r3);
+    sc_add(z, lo, hi);
+    montmul(z, z, one);
+}
+
+void sc_tobytes(uint8_t *out, const sc z)
+{
+    for (unsigned int i = 0; i < 4; i++) store_8(&out[8*i], z[i]);
+}
+
+void sc_add(sc h, const sc f, const sc g)
+{
+    uint64_t t[5];
+    uint128_t c = 0;
+    for (unsigned int i = 0; i < 4; i++) {
+        c += (uint128_t)f[i] + g[i];
+        t[i] = (uint64_t)c;
+        c >>= 64;
+    }
+    t[4] = (uint64_t)c;
+    reduce_once(h, t);
+}
+
+void sc_neg(sc h, const sc f)
+{
+    // n - f is in [1, n], so one conditional subtraction maps n to 0
+    uint64_t t[5], borrow = 0;
+    for (unsigned int i = 0; i < 4; i++) {
+        const uint128_t x = (uint128_t)order[i] - f[i] - borrow;
+        t[i] = (uint64_t)x;
+        borrow = (uint64_t)(x >> 64) & 1;
+    }
+    t[4] = 0;
+    reduce_once(h, t);
+}
+
+void sc_mul(sc h, const sc f, const sc g)
+{
+    sc t;
+    montmul(t, f, g);
+    montmul(h, t, r2);
+}
+
+void sc_muladd(sc h, const sc f, const sc g, const sc a)
+{
+    sc t;
+    sc_mul(t, f, g);
+    sc_add(h, t, a);
+}
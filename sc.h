@@ -0,0 +1,71 @@
+/*
+Arithmetic modulo the order of the group of E : y^2 = x^3 - 3*x + 13318
+
+The group of E has prime order
+
+    n = 2^255 + 0xf4f654f83deb8d16eb7d12dc4dc2cbe3
+
+Note that n is larger than 2^255, while `scalarmult` ignores the 255'th bit of
+its key. So a scalar that is used as a key must be smaller than 2^255.
+
+Scalars are represented by 4 unsigned 64-bit limbs (least significant limb
+first), and between operations their value is always fully reduced, i.e.
+smaller than n. Internally, the multiplications use Montgomery reduction.
+Every function in this file runs in constant time.
+*/
+
+#ifndef CURVE13318_REF12_SC_H_
+#define CURVE13318_REF12_SC_H_
+
+#include <stdint.h>
+
+typedef uint64_t sc[4];
+
+#define sc_frombytes crypto_scalarmult_curve13318_ref12_sc_frombytes
+#define sc_reduce crypto_scalarmult_curve13318_ref12_sc_reduce
+#define sc_tobytes crypto_scalarmult_curve13318_ref12_sc_tobytes
+#define sc_add crypto_scalarmult_curve13318_ref12_sc_add
+#define sc_neg crypto_scalarmult_curve13318_ref12_sc_neg
+#define sc_mul crypto_scalarmult_curve13318_ref12_sc_mul
+#define sc_muladd crypto_scalarmult_curve13318_ref12_sc_muladd
+
+/*
+Parse a 32-byte little-endian integer into a scalar, reducing it modulo n
+
+Returns:
+  0 if the input was smaller than n, nonzero otherwise (the output is
+  reduced in both cases)
+*/
+int sc_frombytes(sc z, const uint8_t *in);
+
+/*
+Reduce a 64-byte little-endian integer (e.g. a SHA-512 digest) modulo n
+*/
+void sc_reduce(sc z, const uint8_t *in);
+
+/*
+Write a scalar as a 32-byte little-endian integer
+*/
+void sc_tobytes(uint8_t *out, const sc z);
+
+/*
+Compute h = f + g (mod n)
+*/
+void sc_add(sc h, const sc f, const sc g);
+
+/*
+Compute h = -f (mod n)
+*/
+void sc_neg(sc h, const sc f);
+
+/*
+Compute h = f * g (mod n)
+*/
+void sc_mul(sc h, const sc f, const sc g);
+
+/*
+Compute h = f * g + a (mod n)
+*/
+void sc_muladd(sc h, const sc f, const sc g, const sc a);
+
+#endif /* CURVE13318_REF12_SC_H_ */
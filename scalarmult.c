@@ -5,16 +5,44 @@
     `E : y^2 = x^3 - 3*x + 13318`.
 */
 
+#define _DEFAULT_SOURCE
 #include "ge.h"
 #include "mxcsr.h"
+#include "scalarmult.h"
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 
-#define scalarmult crypto_scalarmult_curve13318_scalarmult
 #define select crypto_scalarmult_curve13318_ref12_select
 #define ladder crypto_scalarmult_curve13318_ref12_ladder
+#define ladder_intrin crypto_scalarmult_curve13318_ref12_ladder_intrin
+#define ladder2_intrin crypto_scalarmult_curve13318_ref12_ladder2_intrin
+#define ladder_packed_intrin crypto_scalarmult_curve13318_ref12_ladder_packed_intrin
+#define precompute_packed_intrin crypto_scalarmult_curve13318_ref12_precompute_packed_intrin
 
 void crypto_scalarmult_curve13318_ref12_ladder(ge q, const uint8_t *w, const ge ptable[16]);
+void crypto_scalarmult_curve13318_ref12_ladder_intrin(ge_interleaved q, const uint8_t *w,
+                                                      const ge_interleaved ptable[16]);
+void crypto_scalarmult_curve13318_ref12_ladder2_intrin(ge_interleaved q1, ge_interleaved q2,
+                                                       const uint8_t *w,
+                                                       const ge_interleaved ptable1[16],
+                                                       const ge_interleaved ptable2[16]);
+void crypto_scalarmult_curve13318_ref12_ladder_packed_intrin(ge_interleaved q, const uint8_t *w,
+                                                             const ge_interleaved_packed ptable[16]);
+void crypto_scalarmult_curve13318_ref12_precompute_packed_intrin(ge_interleaved_packed ptable[16],
+                                                                 const ge p);
+
+/*
+The fe12 group operations and ladder, either the NASM or the intrinsics ones.
+Only one of the ladders is set: the NASM ladder works on `ge` values, the
+intrinsics ladder on the interleaved layout.
+*/
+struct fe12_backend {
+    void (*add)(ge, const ge, const ge);
+    void (*dbl)(ge, const ge);
+    void (*ladder)(ge, const uint8_t *, const ge[16]);
+    void (*ladder_i)(ge_interleaved, const uint8_t *, const ge_interleaved[16]);
+};
 
 // Conditionally add an element, assumes dest == {0}
 static void cmov(ge dest, const ge src, uint64_t mask)
@@ -46,29 +74,101 @@ static void cmov_neutral(ge dest, uint64_t mask)
     dest[1][0] = tmp2.d;
 }
 
-// Do the table precomputation
-static void do_precomputation(ge ptable[16], const ge p)
+// Add `lhs` to all four points in `rhs`, with one `ge_add_x4`
+static inline void add_x4(ge dest[4], const ge lhs, const ge rhs[4])
+{
+    ge_x4 __attribute__((aligned(32))) lhs4, rhs4;
+    for (unsigned int c = 0; c < 3; c++) fe12x4_load(lhs4[c], lhs[c], lhs[c], lhs[c], lhs[c]);
+    ge_x4_load(rhs4, rhs);
+    ge_add_x4(rhs4, lhs4, rhs4);
+    ge_x4_store(dest, rhs4);
+}
+
+// Like `add_x4`, but `rhs` and `dest` are in the interleaved layout
+static inline void add_x4_interleaved(ge_interleaved dest[4], const ge lhs,
+                                      const ge_interleaved rhs[4])
+{
+    ge_x4 __attribute__((aligned(32))) lhs4, rhs4;
+    for (unsigned int c = 0; c < 3; c++) fe12x4_load(lhs4[c], lhs[c], lhs[c], lhs[c], lhs[c]);
+    ge_x4_load_interleaved(rhs4, rhs);
+    ge_add_x4(rhs4, lhs4, rhs4);
+    ge_x4_store_interleaved(dest, rhs4);
+}
+
+/*
+Do the table precomputation, i.e. ptable[i] = (i + 1) * P
+
+The entries 2^(k-1) * P + {P, ..., 2^(k-1) * P} only depend on the entries
+before them, so each of those levels is computed at once, with `ge_add_x4` on
+four entries at a time:
+
+  - P -> 2P
+  - 2P + {P, 2P} -> {3P, 4P}
+  - 4P + {P, ..., 4P} -> {5P, ..., 8P}
+  - 8P + {P, ..., 8P} -> {9P, ..., 16P} (two independent `ge_add_x4`s)
+
+A `ge_add_x4` takes about three times as long as a single `ge_add`, so the
+level with only two entries uses the backend's own group operations. The
+addition formulas are complete, so e.g. 4P + 4P is a valid addition.
+*/
+static inline void do_precomputation(ge ptable[16], const ge p,
+                                     const struct fe12_backend *b)
 {
     ge_copy(ptable[0], p);
-    ge_double(ptable[1], ptable[0]);
-    ge_add(ptable[2], ptable[1], ptable[0]);
-    ge_double(ptable[3], ptable[1]);
-    ge_add(ptable[4], ptable[3], ptable[0]);
-    ge_double(ptable[5], ptable[2]);
-    ge_add(ptable[6], ptable[5], ptable[0]);
-    ge_double(ptable[7], ptable[3]);
-    ge_add(ptable[8], ptable[7], ptable[0]);
-    ge_double(ptable[9], ptable[4]);
-    ge_add(ptable[10], ptable[9], ptable[0]);
-    ge_double(ptable[11], ptable[5]);
-    ge_add(ptable[12], ptable[11], ptable[0]);
-    ge_double(ptable[13], ptable[6]);
-    ge_add(ptable[14], ptable[13], ptable[0]);
-    ge_double(ptable[15], ptable[7]);
+    b->dbl(ptable[1], ptable[0]);
+    b->add(ptable[2], ptable[1], ptable[0]);
+    b->dbl(ptable[3], ptable[1]);
+    add_x4(&ptable[4], ptable[3], &ptable[0]);
+    add_x4(&ptable[8], ptable[7], &ptable[0]);
+    add_x4(&ptable[12], ptable[7], &ptable[4]);
+}
+
+/*
+The same precomputation, for the interleaved table of the intrinsics ladder.
+The table is written in that layout directly, so no `ge` table is needed next
+to it. Only the left operands of the levels (2P, 4P and 8P) are kept as `ge`
+values.
+*/
+static inline void do_precomputation_interleaved(ge_interleaved ptable[16], const ge p,
+                                                 const struct fe12_backend *b)
+{
+    ge __attribute__((aligned(64))) low[4], p8;
+    ge_copy(low[0], p);
+    b->dbl(low[1], low[0]);
+    b->add(low[2], low[1], low[0]);
+    b->dbl(low[3], low[1]);
+    for (unsigned int i = 0; i < 4; i++) ge_interleave(ptable[i], low[i]);
+    add_x4_interleaved(&ptable[4], low[3], &ptable[0]);
+    ge_deinterleave(p8, ptable[7]);
+    add_x4_interleaved(&ptable[8], p8, &ptable[0]);
+    add_x4_interleaved(&ptable[12], p8, &ptable[4]);
+}
+
+/*
+The ladder of `scalarmult_sse2`, on four keys at once: lane i of `q` is
+multiplied by the windows in w[i]. All lanes share the same table, but every
+lane does its own constant time lookup (`ge_x4_select`).
+*/
+static void ladder_x4(ge_x4 q, const uint8_t w[4][51], const ge ptable[16])
+{
+    ge_x4 __attribute__((aligned(32))) p;
+    uint8_t idx[4], sign[4];
+
+    for (unsigned int i = 0; i < 51; i++) {
+        for (unsigned int j = 0; j < 5; j++) ge_double_x4(q, q);
+        for (unsigned int lane = 0; lane < 4; lane++) {
+            const uint8_t bits = w[lane][i];
+            sign[lane] = (bits >> 4) & 1;
+            const uint8_t signmask = -sign[lane];
+            idx[lane] = ((signmask & ~bits) | (~signmask & (bits - 1))) & 0x1F;
+        }
+        ge_x4_select(p, idx, sign, ptable);
+        ge_add_x4(q, q, p);
+    }
 }
 
 // Decode the key bytes into windows and ripple the subtraction carry
-static inline void compute_windows(uint8_t w[51], uint8_t *zeroth_window, const uint8_t *e)
+void compute_windows(uint8_t w[51], uint8_t *zeroth_window, const uint8_t *e)
 {
     w[50] = e[ 0] & 0x1F;
     w[49] = ((e[ 1] << 3) | (e[ 0] >> 5)) & 0x1F;
@@ -174,36 +274,268 @@ static inline void compute_windows(uint8_t w[51], uint8_t *zeroth_window, const
     *zeroth_window = ((w[0] >> 5) ^ (w[0] >> 4)) & 0x1;
 }
 
-// Main secret scalar multiplication
-int scalarmult(uint8_t *out, const uint8_t *key, const uint8_t *in)
+// The per-call state of `scalarmult_fe12`, see `scalarmult_ctx` (dispatch.c)
+struct fe12_scratch {
+    ge __attribute__((aligned(64))) p;
+    ge __attribute__((aligned(64))) q;
+    ge_interleaved __attribute__((aligned(64))) q_i;
+    // The table, in the layout of the backend's ladder
+    union {
+        ge __attribute__((aligned(64))) plain[16];
+        ge_interleaved __attribute__((aligned(64))) interleaved[16];
+    } ptable;
+};
+
+/*
+Main secret scalar multiplication, with its state in `s`. The caller must
+have replaced the MxCsr register.
+*/
+static inline int scalarmult_fe12_scratch(uint8_t *out, const uint8_t *key, const uint8_t *in,
+                                          const struct fe12_backend *b, struct fe12_scratch *s)
 {
-    ge __attribute__((aligned(64))) p, __attribute__((aligned(64))) q;
-    ge __attribute__((aligned(64))) ptable[16];
-    uint8_t e[32];
     uint8_t w[51], zeroth_window;
 
+    if (ge_frombytes(s->p, in) != 0) return -1;
+
+    // Prepare for ladder computation
+    compute_windows(w, &zeroth_window, key);
+    ge_zero(s->q);
+    cmov_neutral(s->q, -(int64_t)(zeroth_window == 0));
+    cmov(s->q, s->p, -(int64_t)(zeroth_window == 1));
+
+    // Do double and add scalar multiplication
+    if (b->ladder != NULL) {
+        do_precomputation(s->ptable.plain, s->p, b);
+        b->ladder(s->q, w, s->ptable.plain);
+    } else {
+        // The intrinsics ladder works on the interleaved layout, so we only
+        // convert q once before and once after the whole ladder
+        do_precomputation_interleaved(s->ptable.interleaved, s->p, b);
+        ge_interleave(s->q_i, s->q);
+        b->ladder_i(s->q_i, w, s->ptable.interleaved);
+        ge_deinterleave(s->q, s->q_i);
+    }
+    ge_tobytes(out, s->q);
+
+    return 0;
+}
+
+// Main secret scalar multiplication, in one call
+static inline int scalarmult_fe12(uint8_t *out, const uint8_t *key, const uint8_t *in,
+                                  const struct fe12_backend *b)
+{
+    struct fe12_scratch s;
+
     // Prologue: save the MxCsr register state
     const unsigned int saved_mxcsr = replace_mxcsr();
 
-    for (unsigned int i = 0; i < 32; i++) e[i] = key[i];
-    e[31] &= 0x7F; // We do not use the 255'th bit from the key
-
-    int err = ge_frombytes(p, in);
+    const int err = scalarmult_fe12_scratch(out, key, in, b, &s);
     if (err != 0) {
         restore_mxcsr(saved_mxcsr);
         return -1;
     }
 
-    // Prepare for ladder computation
-    do_precomputation(ptable, p);
+    // Epilogue: restore the MxCsr register to its original value
+    const bool mxcsr_ok = restore_mxcsr(saved_mxcsr);
+    if (!mxcsr_ok) return -1;
+
+    return 0;
+}
+
+static const struct fe12_backend nasm = { ge_add, ge_double, ladder, NULL };
+static const struct fe12_backend intrin = { ge_add_intrin, ge_double_intrin, NULL, ladder_intrin };
+
+int scalarmult_avx(uint8_t *out, const uint8_t *key, const uint8_t *in)
+{
+    return scalarmult_fe12(out, key, in, &nasm);
+}
+
+int scalarmult_avx_intrin(uint8_t *out, const uint8_t *key, const uint8_t *in)
+{
+    return scalarmult_fe12(out, key, in, &intrin);
+}
+
+struct fe12_scratch *fe12_scratch_new(void)
+{
+    struct fe12_scratch *s;
+    if (posix_memalign((void **)&s, 64, sizeof(*s)) != 0) return NULL;
+    return s;
+}
+
+void fe12_scratch_free(struct fe12_scratch *s)
+{
+    free(s);
+}
+
+int scalarmult_avx_scratch(uint8_t *out, const uint8_t *key, const uint8_t *in,
+                           struct fe12_scratch *s)
+{
+    return scalarmult_fe12_scratch(out, key, in, &nasm, s);
+}
+
+int scalarmult_avx_intrin_scratch(uint8_t *out, const uint8_t *key, const uint8_t *in,
+                                  struct fe12_scratch *s)
+{
+    return scalarmult_fe12_scratch(out, key, in, &intrin, s);
+}
+
+// The state of `scalarmult_avx_intrin_arena`, which lives in the caller's arena
+struct lowstack_arena {
+    ge __attribute__((aligned(64))) p;
+    ge __attribute__((aligned(64))) q;
+    ge_interleaved __attribute__((aligned(64))) q_i;
+    ge_interleaved_packed __attribute__((aligned(64))) ptable_p[16];
+};
+
+size_t scalarmult_avx_intrin_arena_size(void)
+{
+    // Room to align the arena ourselves
+    return sizeof(struct lowstack_arena) + 63;
+}
+
+int scalarmult_avx_intrin_arena(uint8_t *out, const uint8_t *key, const uint8_t *in,
+                                void *arena)
+{
+    struct lowstack_arena *a = (struct lowstack_arena *)(((uintptr_t)arena + 63) & ~(uintptr_t)63);
+    uint8_t w[51], zeroth_window;
+
+    // Prologue: save the MxCsr register state
+    const unsigned int saved_mxcsr = replace_mxcsr();
+
+    if (ge_frombytes(a->p, in) != 0) {
+        restore_mxcsr(saved_mxcsr);
+        return -1;
+    }
+
+    // Only the packed table is built, directly in the arena
+    precompute_packed_intrin(a->ptable_p, a->p);
     compute_windows(w, &zeroth_window, key);
 
-    // Do double and add scalar multiplication
-    ge_zero(q);
-    cmov_neutral(q, -(int64_t)(zeroth_window == 0));
-    cmov(q, ptable[0], -(int64_t)(zeroth_window == 1));
-    crypto_scalarmult_curve13318_ref12_ladder(q, w, ptable);
-    ge_tobytes(out, q);
+    ge_zero(a->q);
+    cmov_neutral(a->q, -(int64_t)(zeroth_window == 0));
+    cmov(a->q, a->p, -(int64_t)(zeroth_window == 1));
+    ge_interleave(a->q_i, a->q);
+    ladder_packed_intrin(a->q_i, w, a->ptable_p);
+    ge_deinterleave(a->q, a->q_i);
+    ge_tobytes(out, a->q);
+
+    // Epilogue: restore the MxCsr register to its original value
+    const bool mxcsr_ok = restore_mxcsr(saved_mxcsr);
+    if (!mxcsr_ok) return -1;
+
+    return 0;
+}
+
+int scalarmult_two_avx_intrin(uint8_t *out1, uint8_t *out2, const uint8_t *key,
+                              const uint8_t *in1, const uint8_t *in2)
+{
+    ge __attribute__((aligned(64))) p1, __attribute__((aligned(64))) p2;
+    ge __attribute__((aligned(64))) q1, __attribute__((aligned(64))) q2;
+    ge_interleaved __attribute__((aligned(64))) q1_i, __attribute__((aligned(64))) q2_i;
+    ge_interleaved __attribute__((aligned(64))) ptable1_i[16];
+    ge_interleaved __attribute__((aligned(64))) ptable2_i[16];
+    uint8_t w[51], zeroth_window;
+
+    // Prologue: save the MxCsr register state
+    const unsigned int saved_mxcsr = replace_mxcsr();
+
+    const int err1 = ge_frombytes(p1, in1);
+    const int err2 = ge_frombytes(p2, in2);
+    if (err1 != 0 || err2 != 0) {
+        restore_mxcsr(saved_mxcsr);
+        return -1;
+    }
+
+    // Both multiplications use the same windows, so recode the key only once
+    do_precomputation_interleaved(ptable1_i, p1, &intrin);
+    do_precomputation_interleaved(ptable2_i, p2, &intrin);
+    compute_windows(w, &zeroth_window, key);
+
+    ge_zero(q1);
+    cmov_neutral(q1, -(int64_t)(zeroth_window == 0));
+    cmov(q1, p1, -(int64_t)(zeroth_window == 1));
+    ge_zero(q2);
+    cmov_neutral(q2, -(int64_t)(zeroth_window == 0));
+    cmov(q2, p2, -(int64_t)(zeroth_window == 1));
+
+    ge_interleave(q1_i, q1);
+    ge_interleave(q2_i, q2);
+    ladder2_intrin(q1_i, q2_i, w, ptable1_i, ptable2_i);
+    ge_deinterleave(q1, q1_i);
+    ge_deinterleave(q2, q2_i);
+
+    // Share the inversion to affine coordinates between both outputs
+    ge_tobytes2(out1, out2, q1, q2);
+
+    // Epilogue: restore the MxCsr register to its original value
+    const bool mxcsr_ok = restore_mxcsr(saved_mxcsr);
+    if (!mxcsr_ok) return -1;
+
+    return 0;
+}
+
+int scalarmult_many_avx_intrin(uint8_t (*out)[64], const uint8_t (*keys)[32],
+                               const uint8_t *in, size_t len)
+{
+    ge __attribute__((aligned(64))) p;
+    ge __attribute__((aligned(64))) ptable[16];
+    ge_x4 __attribute__((aligned(32))) q;
+    ge_interleaved __attribute__((aligned(64))) q_i;
+    ge_interleaved __attribute__((aligned(64))) ptable_i[16];
+    ge q_lanes[4];
+    uint8_t w[4][51], zeroth_window[4];
+
+    if (len == 0) return 0;
+
+    // Prologue: save the MxCsr register state
+    const unsigned int saved_mxcsr = replace_mxcsr();
+
+    ge *results = malloc(len * sizeof(*results));
+    fe51 *scratch = malloc(len * sizeof(*scratch));
+    int err = (results == NULL || scratch == NULL) ? -1 : ge_frombytes(p, in);
+    if (err != 0) {
+        free(results);
+        free(scratch);
+        restore_mxcsr(saved_mxcsr);
+        return -1;
+    }
+
+    // The point is the same for every key, so build the table only once
+    do_precomputation(ptable, p, &intrin);
+
+    // Four keys at a time in the lanes of a ge_x4
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        for (unsigned int lane = 0; lane < 4; lane++) {
+            compute_windows(w[lane], &zeroth_window[lane], keys[i + lane]);
+            ge_zero(q_lanes[lane]);
+            cmov_neutral(q_lanes[lane], -(int64_t)(zeroth_window[lane] == 0));
+            cmov(q_lanes[lane], ptable[0], -(int64_t)(zeroth_window[lane] == 1));
+        }
+        ge_x4_load(q, (const ge *)q_lanes);
+        ladder_x4(q, (const uint8_t (*)[51])w, (const ge *)ptable);
+        ge_x4_store(&results[i], q);
+    }
+
+    // Padding a group would cost as much as a full one, so the last keys go
+    // through the single ladder instead, still with the same table
+    if (i < len) {
+        for (unsigned int j = 0; j < 16; j++) ge_interleave(ptable_i[j], ptable[j]);
+    }
+    for (; i < len; i++) {
+        compute_windows(w[0], &zeroth_window[0], keys[i]);
+        ge_zero(q_lanes[0]);
+        cmov_neutral(q_lanes[0], -(int64_t)(zeroth_window[0] == 0));
+        cmov(q_lanes[0], ptable[0], -(int64_t)(zeroth_window[0] == 1));
+        ge_interleave(q_i, q_lanes[0]);
+        ladder_intrin(q_i, w[0], ptable_i);
+        ge_deinterleave(results[i], q_i);
+    }
+
+    // One inversion for all outputs
+    ge_tobytes_batch(out, (const ge *)results, scratch, len);
+    free(results);
+    free(scratch);
 
     // Epilogue: restore the MxCsr register to its original value
     const bool mxcsr_ok = restore_mxcsr(saved_mxcsr);
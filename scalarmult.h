@@ -0,0 +1,325 @@
+/*
+Scalar multiplication backends
+
+Every backend follows the SUPERCOP crypto_scalarmult convention and computes
+the same function: `out` is the affine encoding (x, y) of `key * in`, with the
+neutral element encoded as (0, 0). They only differ in the arithmetic that is
+used underneath:
+
+  - `scalarmult_avx` uses the fe12 (radix 2^21.25 doubles) AVX ladder.
+  - `scalarmult_avx_intrin` is the same ladder, written with AVX intrinsics.
+  - `scalarmult_mulx` uses the fe64 (radix 2^64 integers) mulx/adx ladder.
+  - `scalarmult_sse2` uses the fe12x2 (radix 2^21.25 doubles) SSE2 ladder.
+
+`bench.out` (`make bench-backends`) compares these head to head. The public
+`scalarmult` calls the best one that the CPU supports (see dispatch.c).
+*/
+
+#ifndef CURVE13318_REF12_SCALARMULT_H_
+#define CURVE13318_REF12_SCALARMULT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define scalarmult crypto_scalarmult_curve13318_scalarmult
+#define scalarmult_variant crypto_scalarmult_curve13318_scalarmult_variant
+#define scalarmult_avx crypto_scalarmult_curve13318_scalarmult_avx
+#define scalarmult_avx_intrin crypto_scalarmult_curve13318_scalarmult_avx_intrin
+#define scalarmult_mulx crypto_scalarmult_curve13318_scalarmult_mulx
+#define scalarmult_sse2 crypto_scalarmult_curve13318_scalarmult_sse2
+#define scalarmult_two crypto_scalarmult_curve13318_scalarmult_two
+#define scalarmult_two_avx_intrin crypto_scalarmult_curve13318_scalarmult_two_avx_intrin
+#define scalarmult_many crypto_scalarmult_curve13318_scalarmult_many
+#define scalarmult_many_avx_intrin crypto_scalarmult_curve13318_scalarmult_many_avx_intrin
+#define scalarmult_ctx_new crypto_scalarmult_curve13318_scalarmult_ctx_new
+#define scalarmult_ctx_enter crypto_scalarmult_curve13318_scalarmult_ctx_enter
+#define scalarmult_ctx_run crypto_scalarmult_curve13318_scalarmult_ctx_run
+#define scalarmult_ctx_leave crypto_scalarmult_curve13318_scalarmult_ctx_leave
+#define scalarmult_ctx_free crypto_scalarmult_curve13318_scalarmult_ctx_free
+#define fe12_scratch_new crypto_scalarmult_curve13318_ref12_fe12_scratch_new
+#define fe12_scratch_free crypto_scalarmult_curve13318_ref12_fe12_scratch_free
+#define scalarmult_avx_scratch crypto_scalarmult_curve13318_ref12_scalarmult_avx_scratch
+#define scalarmult_avx_intrin_scratch crypto_scalarmult_curve13318_ref12_scalarmult_avx_intrin_scratch
+#define scalarmult_x4_enabled crypto_scalarmult_curve13318_ref12_scalarmult_x4_enabled
+#define scalarmult_arena_size crypto_scalarmult_curve13318_scalarmult_arena_size
+#define scalarmult_arena crypto_scalarmult_curve13318_scalarmult_arena
+#define scalarmult_lowstack crypto_scalarmult_curve13318_scalarmult_lowstack
+#define scalarmult_avx_intrin_arena_size crypto_scalarmult_curve13318_ref12_scalarmult_avx_intrin_arena_size
+#define scalarmult_avx_intrin_arena crypto_scalarmult_curve13318_ref12_scalarmult_avx_intrin_arena
+#define scalarmult_split_new crypto_scalarmult_curve13318_scalarmult_split_new
+#define scalarmult_split crypto_scalarmult_curve13318_scalarmult_split
+#define scalarmult_split_avx_intrin crypto_scalarmult_curve13318_scalarmult_split_avx_intrin
+#define scalarmult_split_free crypto_scalarmult_curve13318_scalarmult_split_free
+#define compute_windows crypto_scalarmult_curve13318_ref12_compute_windows
+
+/*
+Multiply the point `in` by `key`, using the backend that was chosen when the
+library was loaded. The environment variable CURVE13318_VARIANT can be set to
+"mulx", "avx", "avx_intrin" or "sse2" to force a backend, if the CPU supports it.
+
+Arguments:
+  - out     Output point (64 bytes)
+  - key     Scalar (32 bytes, the 255'th bit is ignored)
+  - in      Input point (64 bytes)
+Returns:
+  0 on succes, nonzero on failure
+*/
+int scalarmult(uint8_t *out, const uint8_t *key, const uint8_t *in);
+
+/*
+Return the name of the backend that `scalarmult` uses ("mulx", "avx",
+"avx_intrin" or "sse2")
+*/
+const char *scalarmult_variant(void);
+
+/*
+Same as `scalarmult`, but using the fe12 backend. Only use this function on
+CPUs that support AVX.
+*/
+int scalarmult_avx(uint8_t *out, const uint8_t *key, const uint8_t *in);
+
+/*
+Same as `scalarmult_avx`, and with exactly the same intermediate values, but
+with the group operations and the ladder written in C with AVX intrinsics
+instead of NASM. Only use this function on CPUs that support AVX.
+*/
+int scalarmult_avx_intrin(uint8_t *out, const uint8_t *key, const uint8_t *in);
+
+/*
+Same as `scalarmult`, but using the fe64 backend. Only use this function on
+CPUs that support BMI2 and ADX.
+*/
+int scalarmult_mulx(uint8_t *out, const uint8_t *key, const uint8_t *in);
+
+/*
+Same as `scalarmult`, but using the fe12x2 backend. This one only needs SSE2,
+so it runs on every x86-64 CPU.
+*/
+int scalarmult_sse2(uint8_t *out, const uint8_t *key, const uint8_t *in);
+
+/*
+Multiply two points by the same key, e.g. the base point and a peer's public
+key with an ephemeral key. `out1` is `key * in1` and `out2` is `key * in2`,
+encoded like in `scalarmult`. On CPUs with AVX this is
+`scalarmult_two_avx_intrin`, and otherwise it calls `scalarmult` twice.
+
+Returns:
+  0 on succes, nonzero on failure (e.g. if one of the points is invalid)
+*/
+int scalarmult_two(uint8_t *out1, uint8_t *out2, const uint8_t *key,
+                   const uint8_t *in1, const uint8_t *in2);
+
+/*
+Same as `scalarmult_two`, but fused: the key is recoded once, the two ladders
+(the intrinsics ones, see `scalarmult_avx_intrin`) run interleaved, and both
+outputs are converted to affine coordinates with a single inversion. Only use
+this function on CPUs that support AVX.
+*/
+int scalarmult_two_avx_intrin(uint8_t *out1, uint8_t *out2, const uint8_t *key,
+                              const uint8_t *in1, const uint8_t *in2);
+
+/*
+Multiply one point by `len` keys, e.g. for a server that does many key
+exchanges with the same point. `out[i]` is `keys[i] * in`, encoded like in
+`scalarmult`. On CPUs with AVX this is `scalarmult_many_avx_intrin`, and
+otherwise it calls `scalarmult` for every key.
+
+Returns:
+  0 on succes, nonzero on failure (e.g. if the point is invalid, or if there
+  is not enough memory)
+*/
+int scalarmult_many(uint8_t (*out)[64], const uint8_t (*keys)[32],
+                    const uint8_t *in, size_t len);
+
+/*
+Same as `scalarmult_many`, but batched: the point is decoded and its table is
+built only once, four ladders run at once in the lanes of a `ge_x4` (every
+lane with its own constant time lookup in the shared table), and all outputs
+are converted to affine coordinates with a single inversion
+(`ge_tobytes_batch`). If `len` is not a multiple of four, the last keys use
+the ladder of `scalarmult_avx_intrin`. Only use this function on CPUs that support AVX.
+*/
+int scalarmult_many_avx_intrin(uint8_t (*out)[64], const uint8_t (*keys)[32],
+                               const uint8_t *in, size_t len);
+
+/*
+An execution context for many scalar multiplications in a row (dispatch.c)
+
+A context owns the backend that `scalarmult` chose, aligned scratch memory
+for its per-call state, and an MxCsr session. Between one
+`scalarmult_ctx_enter` and one `scalarmult_ctx_leave`, any number of
+`scalarmult_ctx_run` calls can be made. With the avx and avx_intrin backends,
+these calls do not touch the MxCsr register and keep their state in the
+scratch memory of the context. The other backends are called as they are:
+mulx does not use the MxCsr register but keeps its state on the stack, and
+sse2 replaces the MxCsr register and restores it (to the value of the
+session) on every call. The caller must not change the MxCsr register (or do
+other floating point work that depends on it) in between. A context must only
+be used by one thread at a time.
+*/
+struct scalarmult_ctx;
+
+/*
+Create a context for the backend that `scalarmult` uses.
+
+Returns:
+  The new context, or NULL on failure
+*/
+struct scalarmult_ctx *scalarmult_ctx_new(void);
+
+/*
+Start an MxCsr session: save the MxCsr register, and replace it like
+`scalarmult` does.
+
+Returns:
+  0 on succes, nonzero if the context was already entered
+*/
+int scalarmult_ctx_enter(struct scalarmult_ctx *ctx);
+
+/*
+Same as `scalarmult(out, key, in)`, in an entered context
+
+Returns:
+  0 on succes, nonzero on failure (e.g. if the point is invalid, or if the
+  context was not entered)
+*/
+int scalarmult_ctx_run(struct scalarmult_ctx *ctx, uint8_t *out, const uint8_t *key,
+                       const uint8_t *in);
+
+/*
+End the MxCsr session: check that the MxCsr register was not changed since
+`scalarmult_ctx_enter` (like every `scalarmult` does at the end), and
+restore the saved value.
+
+Returns:
+  0 on succes, nonzero if the check failed (the outputs of this session should
+  then not be trusted) or if the context was not entered
+*/
+int scalarmult_ctx_leave(struct scalarmult_ctx *ctx);
+
+/*
+Free a context. It must not be entered.
+*/
+void scalarmult_ctx_free(struct scalarmult_ctx *ctx);
+
+/*
+The per-call state of the fe12 backends, for `scalarmult_ctx`
+*/
+struct fe12_scratch;
+
+struct fe12_scratch *fe12_scratch_new(void);
+void fe12_scratch_free(struct fe12_scratch *s);
+
+/*
+Same as `scalarmult_avx` and `scalarmult_avx_intrin`, but with their state in
+`s`, and without touching the MxCsr register, which the caller must have
+replaced (see mxcsr.h)
+*/
+int scalarmult_avx_scratch(uint8_t *out, const uint8_t *key, const uint8_t *in,
+                           struct fe12_scratch *s);
+int scalarmult_avx_intrin_scratch(uint8_t *out, const uint8_t *key, const uint8_t *in,
+                                  struct fe12_scratch *s);
+
+/*
+Low-stack mode, e.g. for many concurrent handshakes on small fiber stacks
+
+`scalarmult_avx_intrin` keeps its tables and ladder state on the stack, and
+needs about 18 KB of it in total. In this mode, that state lives in an arena
+instead, and the stack only holds the temporaries of the group operations: on
+CPUs with AVX, this is `scalarmult_avx_intrin_arena`, with an arena of about
+4 KB, and at most 4.5 KB of stack (including the caller's frames; measured
+with `make bench-fibers`). So it fits on 8 KB fiber stacks, but not on 4 KB
+ones. If another backend was forced, that backend is called as it is, and
+the arena is not used: `scalarmult_mulx` needs about 2.7 KB of stack,
+`scalarmult_sse2` about 8.6 KB and `scalarmult_avx` about 17 KB.
+*/
+
+/*
+Return the number of bytes that an arena for `scalarmult_arena` must have.
+The arena does not need to be aligned.
+*/
+size_t scalarmult_arena_size(void);
+
+/*
+Same as `scalarmult(out, key, in)`, in low-stack mode with the state in
+`arena`, which has (at least) `scalarmult_arena_size()` bytes. An arena can
+be reused, but must only be used by one call at a time.
+*/
+int scalarmult_arena(uint8_t *out, const uint8_t *key, const uint8_t *in, void *arena);
+
+/*
+Same as `scalarmult_arena`, with an arena of the calling thread, which is
+allocated on its first call and freed when the thread exits. All fibers that
+run on a thread share its arena, which is fine because a call does not yield.
+
+Returns:
+  0 on succes, nonzero on failure (e.g. if the point is invalid, or if the
+  arena could not be allocated)
+*/
+int scalarmult_lowstack(uint8_t *out, const uint8_t *key, const uint8_t *in);
+
+/*
+The AVX kernel of `scalarmult_arena`: the same ladder as
+`scalarmult_avx_intrin`, but the table is built directly in its packed form,
+one entry at a time, and all of the state is in `arena`. Only use these
+functions on CPUs that support AVX.
+*/
+size_t scalarmult_avx_intrin_arena_size(void);
+int scalarmult_avx_intrin_arena(uint8_t *out, const uint8_t *key, const uint8_t *in,
+                                void *arena);
+
+/*
+Return whether the batched AVX versions (`scalarmult_many_avx_intrin` and
+`scalarmult_split_avx_intrin`) and
+`scalarmult_avx_intrin_arena` may be used: the CPU supports AVX, and no
+other backend was forced (see dispatch.c)
+*/
+int scalarmult_x4_enabled(void);
+
+/*
+A registered point for `scalarmult_split` (scalarmult_split.c)
+
+It holds the tables of P, 2^64 * P, 2^128 * P and 2^192 * P, so that the four
+64-bit pieces of a key can be multiplied at once.
+*/
+struct split_point;
+
+/*
+Register the point `in`: decode it and build its tables. This costs about as
+much as a scalar multiplication, so it only pays off for points that are used
+more than once (e.g. a static peer key or a base point).
+
+Returns:
+  The registered point, or NULL on failure (e.g. if `in` is not a valid point)
+*/
+struct split_point *scalarmult_split_new(const uint8_t *in);
+
+/*
+Same as `scalarmult(out, key, in)`, with the point that was registered from
+`in`, but with lower latency. On CPUs with AVX this is
+`scalarmult_split_avx_intrin`, and otherwise it calls `scalarmult`.
+*/
+int scalarmult_split(uint8_t *out, const uint8_t *key, const struct split_point *point);
+
+/*
+Same as `scalarmult_split`, but always split: the key is cut into four 64-bit
+pieces, which are multiplied at once in the lanes of a `ge_x4`, with 13
+windows each instead of 51, and added up at the end. Fails if the point was
+registered on a CPU without AVX.
+*/
+int scalarmult_split_avx_intrin(uint8_t *out, const uint8_t *key,
+                                const struct split_point *point);
+
+/*
+Free a registered point
+*/
+void scalarmult_split_free(struct split_point *point);
+
+/*
+Decode the key bytes into 51 signed 5-bit windows (most significant first),
+which is the schedule that every ladder uses. The carry that ripples out of
+the top window is written to `zeroth_window`.
+*/
+void compute_windows(uint8_t w[51], uint8_t *zeroth_window, const uint8_t *e);
+
+#endif /* CURVE13318_REF12_SCALARMULT_H_ */
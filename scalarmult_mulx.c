@@ -0,0 +1,86 @@
+/*
+    Scalar multiplication using the fe64 (mulx/adx) backend.
+
+    This computes exactly the same function as `scalarmult_avx` (in
+    scalarmult.c), using the same table, window schedule and ladder. Because
+    it does not use floating point arithmetic at all, it does not touch the
+    MxCsr register.
+*/
+
+#include "ge64.h"
+#include "scalarmult.h"
+#include <stdint.h>
+
+// Do the table precomputation, one entry at a time (there are no 4-way group
+// operations for this backend, see `do_precomputation` in `scalarmult.c`)
+static void do_precomputation(ge64 ptable[16], const ge64 p)
+{
+    ge64_copy(ptable[0], p);
+    ge64_double(ptable[1], ptable[0]);
+    ge64_add(ptable[2], ptable[1], ptable[0]);
+    ge64_double(ptable[3], ptable[1]);
+    ge64_add(ptable[4], ptable[3], ptable[0]);
+    ge64_double(ptable[5], ptable[2]);
+    ge64_add(ptable[6], ptable[5], ptable[0]);
+    ge64_double(ptable[7], ptable[3]);
+    ge64_add(ptable[8], ptable[7], ptable[0]);
+    ge64_double(ptable[9], ptable[4]);
+    ge64_add(ptable[10], ptable[9], ptable[0]);
+    ge64_double(ptable[11], ptable[5]);
+    ge64_add(ptable[12], ptable[11], ptable[0]);
+    ge64_double(ptable[13], ptable[6]);
+    ge64_add(ptable[14], ptable[13], ptable[0]);
+    ge64_double(ptable[15], ptable[7]);
+}
+
+// Double-and-add ladder, the same as `ladder.asm`
+static void ladder(ge64 q, const uint8_t w[51], const ge64 ptable[16])
+{
+    ge64 p;
+    fe64 y_neg;
+
+    for (unsigned int i = 0; i < 51; i++) {
+        for (unsigned int j = 0; j < 5; j++) ge64_double(q, q);
+
+        // compute_idx bits
+        //   |  0 <= bits < 16 = x - 1  // sign is (+)
+        //   | 16 <= bits < 32 = ~x     // sign is (-)
+        const uint8_t bits = w[i];
+        const uint8_t sign = (bits >> 4) & 1;
+        const uint8_t signmask = -sign;
+        const uint8_t idx = ((signmask & ~bits) | (~signmask & (bits - 1))) & 0x1F;
+
+        ge64_select(p, idx, ptable);
+        fe64_zero(y_neg);
+        fe64_sub(y_neg, y_neg, p[1]);
+        fe64_cmov(p[1], y_neg, -(uint64_t)sign);
+        ge64_add(q, q, p);
+    }
+}
+
+// Main secret scalar multiplication
+int scalarmult_mulx(uint8_t *out, const uint8_t *key, const uint8_t *in)
+{
+    ge64 p, q;
+    ge64 ptable[16];
+    uint8_t e[32];
+    uint8_t w[51], zeroth_window;
+
+    for (unsigned int i = 0; i < 32; i++) e[i] = key[i];
+    e[31] &= 0x7F; // We do not use the 255'th bit from the key
+
+    int err = ge64_frombytes(p, in);
+    if (err != 0) return -1;
+
+    // Prepare for ladder computation
+    do_precomputation(ptable, p);
+    compute_windows(w, &zeroth_window, e);
+
+    // Do double and add scalar multiplication
+    ge64_neutral(q);
+    ge64_cmov(q, ptable[0], -(uint64_t)(zeroth_window == 1));
+    ladder(q, w, ptable);
+    ge64_tobytes(out, q);
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+    Split scalar multiplication for registered points (see scalarmult.h).
+
+    The ladder of `scalarmult` is one serial chain of 255 doublings. For a
+    point that is used many times, we precompute the tables of P, 2^64 * P,
+    2^128 * P and 2^192 * P, and put one of them in every lane of a `ge_x4`.
+    The key is split into four 64-bit pieces k_0..k_3, so
+
+        key * P = k_0 * P + k_1 * (2^64 * P) + k_2 * (2^128 * P) + k_3 * (2^192 * P)
+
+    and the four multiplications by a 64-bit piece run at once in the lanes,
+    with 13 windows (65 doublings) each. The four lanes are added up at the
+    end with the (complete) addition formulas, so nothing depends on the key
+    except for the constant time lookups.
+*/
+
+#define _DEFAULT_SOURCE
+#include "ge.h"
+#include "mxcsr.h"
+#include "scalarmult.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SPLIT_WINDOWS 13
+
+struct split_point {
+    // Lane i of ptable[j] is (j + 1) * 2^(64*i) * P
+    ge_x4 ptable[16];
+    uint8_t in[64];
+    // Whether `ptable` was built, i.e. whether the AVX code may be used
+    bool x4;
+};
+
+/*
+Decode a 64-bit piece of the key into 13 signed 5-bit windows, in the same
+format as `compute_windows`. The carry out of the top window has weight 2^65.
+*/
+static void compute_windows_64(uint8_t w[SPLIT_WINDOWS], uint8_t *zeroth_window,
+                               const uint8_t e[8])
+{
+    uint64_t v = 0;
+    for (unsigned int i = 0; i < 8; i++) v |= (uint64_t)e[i] << (8*i);
+
+    uint8_t carry = 0;
+    for (unsigned int i = 0; i < SPLIT_WINDOWS; i++) {
+        uint8_t *window = &w[SPLIT_WINDOWS - 1 - i];
+        *window = ((v >> (5*i)) & 0x1F) + carry;
+        carry = ((*window >> 5) ^ (*window >> 4)) & 0x1;
+    }
+    *zeroth_window = carry;
+}
+
+struct split_point *scalarmult_split_new(const uint8_t *in)
+{
+    struct split_point *point;
+    ge __attribute__((aligned(64))) p[4];
+    ge_x4 __attribute__((aligned(32))) base;
+
+    if (posix_memalign((void **)&point, 64, sizeof(*point)) != 0) return NULL;
+    memcpy(point->in, in, 64);
+    point->x4 = scalarmult_x4_enabled();
+
+    const unsigned int saved_mxcsr = replace_mxcsr();
+    int err = ge_frombytes(p[0], in);
+    if (err == 0 && point->x4) {
+        for (unsigned int i = 1; i < 4; i++) {
+            ge_copy(p[i], p[i - 1]);
+            for (unsigned int j = 0; j < 64; j++) ge_double_intrin(p[i], p[i]);
+        }
+        ge_x4_load(base, (const ge *)p);
+        memcpy(point->ptable[0], base, sizeof(base));
+        for (unsigned int i = 1; i < 16; i++) {
+            ge_add_x4(point->ptable[i], point->ptable[i - 1], base);
+        }
+    }
+    if (!restore_mxcsr(saved_mxcsr)) err = -1;
+
+    if (err != 0) {
+        free(point);
+        return NULL;
+    }
+    return point;
+}
+
+void scalarmult_split_free(struct split_point *point)
+{
+    free(point);
+}
+
+int scalarmult_split(uint8_t *out, const uint8_t *key, const struct split_point *point)
+{
+    if (!point->x4) return scalarmult(out, key, point->in);
+    return scalarmult_split_avx_intrin(out, key, point);
+}
+
+int scalarmult_split_avx_intrin(uint8_t *out, const uint8_t *key,
+                                const struct split_point *point)
+{
+    ge_x4 __attribute__((aligned(32))) q, t;
+    ge __attribute__((aligned(64))) q_lanes[4];
+    uint8_t e[32];
+    uint8_t w[4][SPLIT_WINDOWS], zeroth_window[4], idx[4], sign[4];
+
+    if (!point->x4) return -1;
+
+    // Prologue: save the MxCsr register state
+    const unsigned int saved_mxcsr = replace_mxcsr();
+
+    for (unsigned int i = 0; i < 32; i++) e[i] = key[i];
+    e[31] &= 0x7F; // We do not use the 255'th bit from the key
+    for (unsigned int lane = 0; lane < 4; lane++) {
+        compute_windows_64(w[lane], &zeroth_window[lane], &e[8*lane]);
+        // Start at the carry out of the piece, i.e. the first entry or the
+        // neutral element
+        idx[lane] = (zeroth_window[lane] ^ 1) << 4;
+        sign[lane] = 0;
+    }
+    ge_x4_select_lanes(q, idx, sign, point->ptable);
+
+    // The ladder of `scalarmult_many`, but on 13 windows and with a table per lane
+    for (unsigned int i = 0; i < SPLIT_WINDOWS; i++) {
+        for (unsigned int j = 0; j < 5; j++) ge_double_x4(q, q);
+        for (unsigned int lane = 0; lane < 4; lane++) {
+            const uint8_t bits = w[lane][i];
+            sign[lane] = (bits >> 4) & 1;
+            const uint8_t signmask = -sign[lane];
+            idx[lane] = ((signmask & ~bits) | (~signmask & (bits - 1))) & 0x1F;
+        }
+        ge_x4_select_lanes(t, idx, sign, point->ptable);
+        ge_add_x4(q, q, t);
+    }
+
+    // Add up the four lanes
+    ge_x4_store(q_lanes, q);
+    ge_add_intrin(q_lanes[0], q_lanes[0], q_lanes[1]);
+    ge_add_intrin(q_lanes[2], q_lanes[2], q_lanes[3]);
+    ge_add_intrin(q_lanes[0], q_lanes[0], q_lanes[2]);
+    ge_tobytes(out, q_lanes[0]);
+
+    // Epilogue: restore the MxCsr register to its original value
+    const bool mxcsr_ok = restore_mxcsr(saved_mxcsr);
+    if (!mxcsr_ok) return -1;
+
+    return 0;
+}
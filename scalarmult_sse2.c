@@ -0,0 +1,96 @@
+/*
+    Scalar multiplication using the fe12x2 (SSE2) backend.
+
+    This computes exactly the same function as `scalarmult_avx` (in
+    scalarmult.c), using the same fe12 representation, table, window schedule
+    and ladder, but only two lanes wide. It is the fallback for CPUs (mostly
+    virtual machines) that do not expose AVX. Like `scalarmult_avx`, it
+    replaces the MxCsr register during the computation.
+*/
+
+#include "ge.h"
+#include "mxcsr.h"
+#include "scalarmult.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Do the table precomputation, one entry at a time (there are no 4-way group
+// operations for this backend, see `do_precomputation` in `scalarmult.c`)
+static void do_precomputation(ge ptable[16], const ge p)
+{
+    ge_copy(ptable[0], p);
+    ge_double_sse2(ptable[1], ptable[0]);
+    ge_add_sse2(ptable[2], ptable[1], ptable[0]);
+    ge_double_sse2(ptable[3], ptable[1]);
+    ge_add_sse2(ptable[4], ptable[3], ptable[0]);
+    ge_double_sse2(ptable[5], ptable[2]);
+    ge_add_sse2(ptable[6], ptable[5], ptable[0]);
+    ge_double_sse2(ptable[7], ptable[3]);
+    ge_add_sse2(ptable[8], ptable[7], ptable[0]);
+    ge_double_sse2(ptable[9], ptable[4]);
+    ge_add_sse2(ptable[10], ptable[9], ptable[0]);
+    ge_double_sse2(ptable[11], ptable[5]);
+    ge_add_sse2(ptable[12], ptable[11], ptable[0]);
+    ge_double_sse2(ptable[13], ptable[6]);
+    ge_add_sse2(ptable[14], ptable[13], ptable[0]);
+    ge_double_sse2(ptable[15], ptable[7]);
+}
+
+// Double-and-add ladder, the same as `ladder.asm`
+static void ladder(ge q, const uint8_t w[51], const ge ptable[16])
+{
+    ge p;
+
+    for (unsigned int i = 0; i < 51; i++) {
+        for (unsigned int j = 0; j < 5; j++) ge_double_sse2(q, q);
+
+        // compute_idx bits
+        //   |  0 <= bits < 16 = x - 1  // sign is (+)
+        //   | 16 <= bits < 32 = ~x     // sign is (-)
+        const uint8_t bits = w[i];
+        const uint8_t sign = (bits >> 4) & 1;
+        const uint8_t signmask = -sign;
+        const uint8_t idx = ((signmask & ~bits) | (~signmask & (bits - 1))) & 0x1F;
+
+        ge_select_sse2(p, idx, ptable);
+        ge_cneg(p, sign);
+        ge_add_sse2(q, q, p);
+    }
+}
+
+// Main secret scalar multiplication
+int scalarmult_sse2(uint8_t *out, const uint8_t *key, const uint8_t *in)
+{
+    ge p, q;
+    ge ptable[16];
+    uint8_t e[32];
+    uint8_t w[51], zeroth_window;
+
+    // Prologue: save the MxCsr register state
+    const unsigned int saved_mxcsr = replace_mxcsr();
+
+    for (unsigned int i = 0; i < 32; i++) e[i] = key[i];
+    e[31] &= 0x7F; // We do not use the 255'th bit from the key
+
+    int err = ge_frombytes(p, in);
+    if (err != 0) {
+        restore_mxcsr(saved_mxcsr);
+        return -1;
+    }
+
+    // Prepare for ladder computation
+    do_precomputation(ptable, p);
+    compute_windows(w, &zeroth_window, e);
+
+    // Do double and add scalar multiplication
+    // q is P if zeroth_window == 1 (idx 0), otherwise neutral (idx 0x1F)
+    ge_select_sse2(q, (zeroth_window - 1) & 0x1F, ptable);
+    ladder(q, w, ptable);
+    ge_tobytes(out, q);
+
+    // Epilogue: restore the MxCsr register to its original value
+    const bool mxcsr_ok = restore_mxcsr(saved_mxcsr);
+    if (!mxcsr_ok) return -1;
+
+    return 0;
+}
@@ -0,0 +1,342 @@
+/*
+    Schnorr signatures (see schnorr.h).
+
+    Verification uses the fe12 group operations of the SSE2 backend, which run
+    on every x86-64 CPU. Because it only handles public data, it does not use
+    the constant-time windows of the ladders, but a width-5 NAF, for which
+    every point only needs a table of 8 odd multiples.
+*/
+
+#define _DEFAULT_SOURCE
+#include "ge.h"
+#include "mxcsr.h"
+#include "sc.h"
+#include "scalarmult.h"
+#include "schnorr.h"
+#include "sha512.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+
+// The generator G
+static const uint8_t generator[64] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3a, 0xd4, 0x95, 0x08, 0x31, 0x4f, 0x36, 0xb2, 0x76, 0x1f, 0x85, 0x4f, 0xb3, 0xa2, 0xe2, 0xba,
+    0x41, 0x76, 0xee, 0x98, 0x96, 0x53, 0x13, 0x53, 0x1e, 0xb7, 0x0c, 0xf8, 0xa1, 0x7f, 0x0f, 0x6e,
+};
+
+// Wipe secret data, in a way that the compiler does not optimize away
+static void wipe(void *p, size_t len)
+{
+    volatile uint8_t *v = p;
+    for (size_t i = 0; i < len; i++) v[i] = 0;
+}
+
+static int randombytes(uint8_t *buf, size_t len)
+{
+    size_t filled = 0;
+    while (filled < len) {
+        const ssize_t ret = getrandom(buf + filled, len - filled, 0);
+        if (ret < 0) return -1;
+        filled += (size_t)ret;
+    }
+    return 0;
+}
+
+// The challenge e = SHA-512(R || A || m) mod n
+static void challenge(sc e, const uint8_t *r, const uint8_t *public_key,
+                      const uint8_t *msg, size_t msg_len)
+{
+    sha512_state st;
+    uint8_t digest[64];
+    sha512_init(&st);
+    sha512_update(&st, r, 64);
+    sha512_update(&st, public_key, 64);
+    sha512_update(&st, msg, msg_len);
+    sha512_final(&st, digest);
+    sc_reduce(e, digest);
+}
+
+// Take the first 255 bits of a digest as a secret scalar. Because n > 2^255,
+// `key` is both the scalar in bytes and a valid key for `scalarmult`.
+static void secret_scalar(sc z, uint8_t key[32], const uint8_t digest[64])
+{
+    memcpy(key, digest, 32);
+    key[31] &= 0x7F;
+    sc_frombytes(z, key);
+}
+
+// h = SHA-512(seed), and the secret scalar a
+static void expand_seed(uint8_t h[64], sc a, uint8_t a_bytes[32], const uint8_t *seed)
+{
+    sha512_state st;
+    sha512_init(&st);
+    sha512_update(&st, seed, 32);
+    sha512_final(&st, h);
+    secret_scalar(a, a_bytes, h);
+}
+
+int schnorr_keypair(uint8_t *public_key, uint8_t *secret_key)
+{
+    uint8_t h[64], a_bytes[32];
+    sc a;
+
+    if (randombytes(secret_key, 32) != 0) return -1;
+    expand_seed(h, a, a_bytes, secret_key);
+    const int err = scalarmult(public_key, a_bytes, generator);
+    memcpy(&secret_key[32], public_key, 64);
+
+    wipe(h, sizeof(h));
+    wipe(a_bytes, sizeof(a_bytes));
+    wipe(a, sizeof(a));
+    return err;
+}
+
+int schnorr_sign(uint8_t *sig, const uint8_t *msg, size_t msg_len,
+                 const uint8_t *secret_key)
+{
+    uint8_t h[64], a_bytes[32], digest[64], r_bytes[32];
+    sha512_state st;
+    sc a, r, e, s;
+
+    expand_seed(h, a, a_bytes, secret_key);
+    sha512_init(&st);
+    sha512_update(&st, h, 64);
+    sha512_update(&st, msg, msg_len);
+    sha512_final(&st, digest);
+    secret_scalar(r, r_bytes, digest);
+
+    const int err = scalarmult(&sig[0], r_bytes, generator);
+    challenge(e, &sig[0], &secret_key[32], msg, msg_len);
+    sc_muladd(s, e, a, r);
+    sc_tobytes(&sig[64], s);
+
+    wipe(h, sizeof(h));
+    wipe(a_bytes, sizeof(a_bytes));
+    wipe(digest, sizeof(digest));
+    wipe(r_bytes, sizeof(r_bytes));
+    wipe(a, sizeof(a));
+    wipe(r, sizeof(r));
+    return err;
+}
+
+// Precompute the odd multiples ptable[i] = (2*i + 1)*P
+static void do_precomputation(ge ptable[8], const ge p)
+{
+    ge p2;
+    ge_copy(ptable[0], p);
+    ge_double_sse2(p2, p);
+    for (unsigned int i = 1; i < 8; i++) ge_add_sse2(ptable[i], ptable[i - 1], p2);
+}
+
+/*
+Recode a scalar (smaller than 2^255) into signed digits, such that
+scalar = sum_i naf[i] * 2^i, where every digit is zero or odd and in
+[-15, 15], and every nonzero digit is followed by at least four zeros (a
+width-5 NAF). This is the same recoding as `slide` in ref10.
+*/
+static void compute_naf(int8_t naf[256], const uint8_t *scalar)
+{
+    for (unsigned int i = 0; i < 256; i++) naf[i] = 1 & (scalar[i >> 3] >> (i & 7));
+    for (unsigned int i = 0; i < 256; i++) {
+        if (!naf[i]) continue;
+        for (unsigned int b = 1; b <= 6 && i + b < 256; b++) {
+            if (!naf[i + b]) continue;
+            if (naf[i] + (naf[i + b] << b) <= 15) {
+                naf[i] += naf[i + b] << b;
+                naf[i + b] = 0;
+            } else if (naf[i] - (naf[i + b] << b) >= -15) {
+                naf[i] -= naf[i + b] << b;
+                for (unsigned int k = i + b; k < 256; k++) {
+                    if (!naf[k]) {
+                        naf[k] = 1;
+                        break;
+                    }
+                    naf[k] = 0;
+                }
+            } else {
+                break;
+            }
+        }
+    }
+}
+
+/*
+Compute q = sum_i scalars[i] * points[i], in variable time, with Straus'
+method: all points share the doublings. Every scalar must be smaller than
+2^255. `tables` and `nafs` are scratch space for `len` points.
+*/
+static void multiscalarmult(ge q, const uint8_t (*scalars)[32], const ge *points,
+                            size_t len, ge (*tables)[8], int8_t (*nafs)[256])
+{
+    int top = -1;
+    ge p;
+
+    for (size_t i = 0; i < len; i++) {
+        do_precomputation(tables[i], points[i]);
+        compute_naf(nafs[i], scalars[i]);
+        for (int j = 255; j > top; j--) {
+            if (nafs[i][j]) top = j;
+        }
+    }
+    ge_neutral(q);
+    for (int j = top; j >= 0; j--) {
+        ge_double_sse2(q, q);
+        for (size_t i = 0; i < len; i++) {
+            const int8_t digit = nafs[i][j];
+            if (digit == 0) continue;
+            ge_copy(p, tables[i][(digit < 0 ? -digit : digit) / 2]);
+            ge_cneg(p, digit < 0);
+            ge_add_sse2(q, q, p);
+        }
+    }
+}
+
+/*
+Write the scalar z of `point` as bytes for `multiscalarmult`, which needs
+scalars smaller than 2^255. The scalar is public, so if z >= 2^255, we just
+branch, and use n - z (which is smaller than 2^128) and -point instead.
+*/
+static void encode_scalar(uint8_t *out, ge point, const sc z)
+{
+    sc t;
+    if (z[3] >> 63) {
+        sc_neg(t, z);
+        ge_cneg(point, 1);
+        sc_tobytes(out, t);
+    } else {
+        sc_tobytes(out, z);
+    }
+}
+
+/*
+Whether both coordinates of the point encoding `bytes` are smaller than
+p = 2^255 - 19. `ge_frombytes` reduces larger coordinates, but R and A are
+hashed as bytes, so both verifiers must only accept the canonical encoding.
+The encodings are public, so this may branch.
+*/
+static bool is_canonical(const uint8_t *bytes)
+{
+    for (unsigned int c = 0; c < 64; c += 32) {
+        const uint8_t *s = &bytes[c];
+        if (s[31] > 0x7F) return false;
+        if (s[31] < 0x7F) continue;
+        unsigned int i = 30;
+        while (i > 0 && s[i] == 0xFF) i--;
+        if (i == 0 && s[0] >= 0xED) return false;
+    }
+    return true;
+}
+
+// `ge_frombytes`, but also reject non-canonical encodings
+static int decode_point(ge point, const uint8_t *bytes)
+{
+    if (!is_canonical(bytes)) return -1;
+    return ge_frombytes(point, bytes);
+}
+
+static bool is_neutral(ge q)
+{
+    uint8_t bytes[64], acc = 0;
+    ge_tobytes(bytes, q);
+    for (unsigned int i = 0; i < 64; i++) acc |= bytes[i];
+    return acc == 0;
+}
+
+int schnorr_verify(const uint8_t *sig, const uint8_t *msg, size_t msg_len,
+                   const uint8_t *public_key)
+{
+    uint8_t scalars[2][32], r_check[64];
+    ge q, points[2], tables[2][8];
+    int8_t nafs[2][256];
+    sc s, e;
+
+    if (sc_frombytes(s, &sig[64]) != 0) return -1;
+    // R is compared with the canonical encoding of s*G - e*A below, but
+    // reject it up front, like `schnorr_verify_batch` does
+    if (!is_canonical(&sig[0])) return -1;
+    challenge(e, &sig[0], public_key, msg, msg_len);
+    sc_neg(e, e);
+
+    const unsigned int saved_mxcsr = replace_mxcsr();
+    int err = ge_frombytes(points[0], generator);
+    err |= decode_point(points[1], public_key);
+    if (err == 0) {
+        encode_scalar(scalars[0], points[0], s);
+        encode_scalar(scalars[1], points[1], e);
+        // s*G - e*A, which must be R
+        multiscalarmult(q, (const uint8_t (*)[32])scalars, points, 2, tables, nafs);
+        ge_tobytes(r_check, q);
+    }
+    const bool mxcsr_ok = restore_mxcsr(saved_mxcsr);
+    if (err != 0 || !mxcsr_ok) return -1;
+
+    return memcmp(r_check, &sig[0], 64) == 0 ? 0 : -1;
+}
+
+// Fill in the scalars and points of the batch equation, in the layout G, A_i,
+// -R_i. The MxCsr register must have been replaced.
+static int batch_equation(uint8_t (*scalars)[32], ge *points, const uint8_t (*sigs)[96],
+                          const uint8_t *const *msgs, const size_t *msg_lens,
+                          const uint8_t (*public_keys)[64], size_t len)
+{
+    sc s_sum = {0, 0, 0, 0};
+    int err = ge_frombytes(points[0], generator);
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t *z_bytes = scalars[1 + len + i];
+        sc s, e, z;
+
+        // The random multipliers are 128-bit, so -R_i only takes part in
+        // the last 129 doublings
+        memset(z_bytes, 0, 32);
+        err |= randombytes(z_bytes, 16);
+        sc_frombytes(z, z_bytes);
+        err |= sc_frombytes(s, &sigs[i][64]);
+        sc_muladd(s_sum, z, s, s_sum);
+        challenge(e, &sigs[i][0], public_keys[i], msgs[i], msg_lens[i]);
+        sc_mul(e, e, z);
+        sc_neg(e, e);
+
+        err |= decode_point(points[1 + i], public_keys[i]);
+        err |= decode_point(points[1 + len + i], sigs[i]);
+        encode_scalar(scalars[1 + i], points[1 + i], e);
+        ge_cneg(points[1 + len + i], 1);
+    }
+    encode_scalar(scalars[0], points[0], s_sum);
+    return err;
+}
+
+int schnorr_verify_batch(const uint8_t (*sigs)[96], const uint8_t *const *msgs,
+                         const size_t *msg_lens, const uint8_t (*public_keys)[64],
+                         size_t len)
+{
+    if (len == 0) return 0;
+
+    const size_t npoints = 2 * len + 1;
+    uint8_t (*scalars)[32] = malloc(npoints * sizeof(*scalars));
+    ge *points = malloc(npoints * sizeof(*points));
+    ge (*tables)[8] = malloc(npoints * sizeof(*tables));
+    int8_t (*nafs)[256] = malloc(npoints * sizeof(*nafs));
+    int err = -1;
+
+    if (scalars != NULL && points != NULL && tables != NULL && nafs != NULL) {
+        ge q;
+        const unsigned int saved_mxcsr = replace_mxcsr();
+        err = batch_equation(scalars, points, sigs, msgs, msg_lens, public_keys, len);
+        if (err == 0) {
+            multiscalarmult(q, (const uint8_t (*)[32])scalars, points, npoints,
+                            tables, nafs);
+            if (!is_neutral(q)) err = -1;
+        }
+        if (!restore_mxcsr(saved_mxcsr)) err = -1;
+    }
+
+    free(scalars);
+    free(points);
+    free(tables);
+    free(nafs);
+    return err;
+}
@@ -0,0 +1,96 @@
+/*
+Schnorr signatures on E : y^2 = x^3 - 3*x + 13318
+
+A secret key is a 32-byte random seed, followed by the public key. With
+h = SHA-512(seed), the secret scalar a is the first 255 bits of h and the
+public key is A = a*G, where the generator G is the point (0, y) with even y.
+Points are encoded like the input and output of `scalarmult`, and n is the
+order of G (see sc.h).
+
+To sign a message m, the signer computes the nonce r (the first 255 bits of
+SHA-512(h || m)), R = r*G, e = SHA-512(R || A || m) mod n and
+s = r + e*a mod n. The signature is R || s (96 bytes). Because n > 2^255, the
+255-bit a and r are already reduced, and they are valid keys for the
+constant-time `scalarmult`, which does the signing.
+
+Verification only handles public data, so it runs in variable time. A single
+signature is checked as s*G - e*A == R, with one double-scalar
+multiplication. `schnorr_verify_batch` checks a batch of signatures with one
+multi-scalar multiplication: with random 128-bit z_i, it checks that
+
+    (sum z_i*s_i)*G - sum (z_i*e_i)*A_i - sum z_i*R_i == 0,
+
+which holds for valid signatures, and fails with probability at least
+1 - 2^-128 if any of them is invalid. All the doublings are shared between
+the signatures. Both verifiers reject s >= n, and encodings of R and A with a
+coordinate >= p, so that they accept exactly the same signatures.
+*/
+
+#ifndef CURVE13318_SCHNORR_H_
+#define CURVE13318_SCHNORR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define schnorr_keypair crypto_scalarmult_curve13318_schnorr_keypair
+#define schnorr_sign crypto_scalarmult_curve13318_schnorr_sign
+#define schnorr_verify crypto_scalarmult_curve13318_schnorr_verify
+#define schnorr_verify_batch crypto_scalarmult_curve13318_schnorr_verify_batch
+
+/*
+Generate a new key pair, using a random seed from the OS
+
+Arguments:
+  - public_key  Output public key (64 bytes)
+  - secret_key  Output secret key (96 bytes: the seed and the public key)
+Returns:
+  0 on succes, nonzero on failure
+*/
+int schnorr_keypair(uint8_t *public_key, uint8_t *secret_key);
+
+/*
+Sign a message
+
+Arguments:
+  - sig         Output signature (96 bytes)
+  - msg         The message
+  - msg_len     The length of the message in bytes
+  - secret_key  The secret key (96 bytes)
+Returns:
+  0 on succes, nonzero on failure
+*/
+int schnorr_sign(uint8_t *sig, const uint8_t *msg, size_t msg_len,
+                 const uint8_t *secret_key);
+
+/*
+Verify a signature
+
+Arguments:
+  - sig         The signature (96 bytes)
+  - msg         The message
+  - msg_len     The length of the message in bytes
+  - public_key  The public key of the signer (64 bytes)
+Returns:
+  0 if the signature is valid, nonzero otherwise
+*/
+int schnorr_verify(const uint8_t *sig, const uint8_t *msg, size_t msg_len,
+                   const uint8_t *public_key);
+
+/*
+Verify `len` signatures at once
+
+Arguments:
+  - sigs         The signatures (96 bytes each)
+  - msgs         The messages
+  - msg_lens     The lengths of the messages in bytes
+  - public_keys  The public keys of the signers (64 bytes each)
+  - len          The number of signatures
+Returns:
+  0 if all signatures are valid, nonzero if any of them is invalid (or on
+  failure)
+*/
+int schnorr_verify_batch(const uint8_t (*sigs)[96], const uint8_t *const *msgs,
+                         const size_t *msg_lens, const uint8_t (*public_keys)[64],
+                         size_t len);
+
+#endif /* CURVE13318_SCHNORR_H_ */
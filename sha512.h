@@ -0,0 +1,39 @@
+/*
+SHA-512 (FIPS 180-4), for the Schnorr signatures in `schnorr.h`
+
+This is a plain, portable implementation. It is not optimized, because the
+hashing is a small part of the cost of signing and verifying.
+*/
+
+#ifndef CURVE13318_REF12_SHA512_H_
+#define CURVE13318_REF12_SHA512_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define sha512_init crypto_scalarmult_curve13318_ref12_sha512_init
+#define sha512_update crypto_scalarmult_curve13318_ref12_sha512_update
+#define sha512_final crypto_scalarmult_curve13318_ref12_sha512_final
+
+typedef struct {
+    uint64_t state[8];
+    uint64_t count;         // The number of bytes that have been absorbed
+    uint8_t buf[128];
+} sha512_state;
+
+/*
+Start a new hash computation
+*/
+void sha512_init(sha512_state *st);
+
+/*
+Absorb `len` bytes from `in`
+*/
+void sha512_update(sha512_state *st, const uint8_t *in, size_t len);
+
+/*
+Finish the hash computation, write the 64-byte digest to `out`, and wipe `st`
+*/
+void sha512_final(sha512_state *st, uint8_t out[64]);
+
+#endif /* CURVE13318_REF12_SHA512_H_ */
@@ -2,6 +2,7 @@
 # *-* encoding: utf-8 *-*
 
 import ctypes
+import hashlib
 import io
 import os
 import unittest
@@ -11,6 +12,11 @@ from sage.all import *
 P = 2**255 - 19
 F = FiniteField(P)
 E = EllipticCurve(F, [-3, 13318])
+# The order of E (see sc.h), and the generator of the signatures (schnorr.h)
+SC_ORDER = 2**255 + 0xf4f654f83deb8d16eb7d12dc4dc2cbe3
+SCHNORR_G = E.lift_x(F(0))
+if SCHNORR_G.xy()[1].lift() % 2 == 1:
+    SCHNORR_G = -SCHNORR_G
 
 from hypothesis import assume, example, given, HealthCheck, note, seed, settings, strategies as st, unlimited
 
@@ -29,6 +35,9 @@ fe10_type = ctypes.c_uint64 * 10
 fe51_type = ctypes.c_uint64 * 5
 ge_type = fe12_type * 3
 fe12x4_type = ctypes.c_double * 48
+ge_x4_type = ctypes.c_double * 144
+fe64_type = ctypes.c_uint64 * 4
+sc_type = ctypes.c_uint64 * 4
 
 # Define functions
 fe12_frombytes = ref12.crypto_scalarmult_curve13318_ref12_fe12_frombytes
@@ -41,6 +50,12 @@ fe12_mul_karatsuba = ref12.crypto_scalarmult_curve13318_ref12_fe12_mul_karatsuba
 fe12_mul_karatsuba.argtypes = [fe12_type, fe12_type, fe12_type]
 fe12_square_karatsuba = ref12.crypto_scalarmult_curve13318_ref12_fe12_square_karatsuba
 fe12_square_karatsuba.argtypes = [fe12_type, fe12_type]
+fe12_freeze = ref12.crypto_scalarmult_curve13318_ref12_fe12_freeze
+fe12_freeze.argtypes = [ctypes.c_double * 6, fe12_type]
+fe12_tobytes = ref12.crypto_scalarmult_curve13318_ref12_fe12_tobytes
+fe12_tobytes.argtypes = [ctypes.c_ubyte * 32, fe12_type]
+fe10_frombytes = ref12.crypto_scalarmult_curve13318_ref12_fe10_frombytes
+fe10_frombytes.argtypes = [fe10_type, ctypes.c_ubyte * 32]
 fe10_tobytes = ref12.crypto_scalarmult_curve13318_ref12_fe10_tobytes
 fe10_tobytes.argtypes = [ctypes.c_ubyte * 32, fe10_type]
 fe10_mul = ref12.crypto_scalarmult_curve13318_ref12_fe10_mul
@@ -69,14 +84,148 @@ ge_double = ref12.crypto_scalarmult_curve13318_ref12_ge_double
 ge_double.argtypes = [ge_type] * 2
 ge_double_c = ref12.crypto_scalarmult_curve13318_ref12_ge_double_c
 ge_double_c.argtypes = [ge_type] * 2
+ge_add_gen = ref12.crypto_scalarmult_curve13318_ref12_ge_add_gen
+ge_add_gen.argtypes = [ge_type] * 3
+ge_double_gen = ref12.crypto_scalarmult_curve13318_ref12_ge_double_gen
+ge_double_gen.argtypes = [ge_type] * 2
 scalarmult = ref12.crypto_scalarmult_curve13318_scalarmult
 scalarmult.argtypes = [ctypes.c_ubyte * 64, ctypes.c_ubyte * 32, ctypes.c_ubyte * 64]
+scalarmult_variant = ref12.crypto_scalarmult_curve13318_scalarmult_variant
+keypair = ref12.crypto_scalarmult_curve13318_keypair
+keypair.argtypes = [ctypes.c_ubyte * 32, ctypes.c_ubyte * 64, ctypes.c_ubyte * 64]
+keypool_new = ref12.crypto_scalarmult_curve13318_keypool_new
+keypool_new.argtypes = [ctypes.c_ubyte * 64, ctypes.c_uint, ctypes.c_uint]
+keypool_new.restype = ctypes.c_void_p
+keypool_pop = ref12.crypto_scalarmult_curve13318_keypool_pop
+keypool_pop.argtypes = [ctypes.c_void_p, ctypes.c_ubyte * 32, ctypes.c_ubyte * 64]
+keypool_available = ref12.crypto_scalarmult_curve13318_keypool_available
+keypool_available.argtypes = [ctypes.c_void_p]
+keypool_available.restype = ctypes.c_uint
+keypool_free = ref12.crypto_scalarmult_curve13318_keypool_free
+keypool_free.argtypes = [ctypes.c_void_p]
+scalarmult_two = ref12.crypto_scalarmult_curve13318_scalarmult_two
+scalarmult_two.argtypes = [ctypes.c_ubyte * 64, ctypes.c_ubyte * 64, ctypes.c_ubyte * 32,
+                           ctypes.c_ubyte * 64, ctypes.c_ubyte * 64]
+scalarmult_two_avx_intrin = ref12.crypto_scalarmult_curve13318_scalarmult_two_avx_intrin
+scalarmult_two_avx_intrin.argtypes = scalarmult_two.argtypes
+scalarmult_many = ref12.crypto_scalarmult_curve13318_scalarmult_many
+scalarmult_many_avx_intrin = ref12.crypto_scalarmult_curve13318_scalarmult_many_avx_intrin
+scalarmult_split_new = ref12.crypto_scalarmult_curve13318_scalarmult_split_new
+scalarmult_split_new.argtypes = [ctypes.c_ubyte * 64]
+scalarmult_split_new.restype = ctypes.c_void_p
+scalarmult_split = ref12.crypto_scalarmult_curve13318_scalarmult_split
+scalarmult_split.argtypes = [ctypes.c_ubyte * 64, ctypes.c_ubyte * 32, ctypes.c_void_p]
+scalarmult_split_avx_intrin = ref12.crypto_scalarmult_curve13318_scalarmult_split_avx_intrin
+scalarmult_split_avx_intrin.argtypes = scalarmult_split.argtypes
+scalarmult_split_free = ref12.crypto_scalarmult_curve13318_scalarmult_split_free
+scalarmult_split_free.argtypes = [ctypes.c_void_p]
+scalarmult_ctx_new = ref12.crypto_scalarmult_curve13318_scalarmult_ctx_new
+scalarmult_ctx_new.restype = ctypes.c_void_p
+scalarmult_ctx_enter = ref12.crypto_scalarmult_curve13318_scalarmult_ctx_enter
+scalarmult_ctx_enter.argtypes = [ctypes.c_void_p]
+scalarmult_ctx_run = ref12.crypto_scalarmult_curve13318_scalarmult_ctx_run
+scalarmult_ctx_run.argtypes = [ctypes.c_void_p, ctypes.c_ubyte * 64, ctypes.c_ubyte * 32,
+                               ctypes.c_ubyte * 64]
+scalarmult_ctx_leave = ref12.crypto_scalarmult_curve13318_scalarmult_ctx_leave
+scalarmult_ctx_leave.argtypes = [ctypes.c_void_p]
+scalarmult_ctx_free = ref12.crypto_scalarmult_curve13318_scalarmult_ctx_free
+scalarmult_ctx_free.argtypes = [ctypes.c_void_p]
+scalarmult_arena_size = ref12.crypto_scalarmult_curve13318_scalarmult_arena_size
+scalarmult_arena_size.restype = ctypes.c_size_t
+scalarmult_arena = ref12.crypto_scalarmult_curve13318_scalarmult_arena
+scalarmult_arena.argtypes = [ctypes.c_ubyte * 64, ctypes.c_ubyte * 32, ctypes.c_ubyte * 64,
+                             ctypes.c_void_p]
+scalarmult_lowstack = ref12.crypto_scalarmult_curve13318_scalarmult_lowstack
+scalarmult_lowstack.argtypes = [ctypes.c_ubyte * 64, ctypes.c_ubyte * 32, ctypes.c_ubyte * 64]
+scalarmult_variant.restype = ctypes.c_char_p
+scalarmult_avx = ref12.crypto_scalarmult_curve13318_scalarmult_avx
+scalarmult_avx.argtypes = [ctypes.c_ubyte * 64, ctypes.c_ubyte * 32, ctypes.c_ubyte * 64]
 select = ref12.crypto_scalarmult_curve13318_ref12_select
 select.argtypes = [ge_type, ctypes.c_ubyte, ge_type * 16]
 fe12x4_squeeze = ref12.crypto_scalarmult_curve13318_ref12_fe12x4_squeeze
 fe12x4_squeeze.argtypes = [fe12x4_type]
+fe12x4_carry = ref12.crypto_scalarmult_curve13318_ref12_fe12x4_carry
+fe12x4_carry.argtypes = [fe12x4_type]
 fe12x4_mul = ref12.crypto_scalarmult_curve13318_ref12_fe12x4_mul_nosqueeze
 fe12x4_mul.argtypes = [fe12x4_type, fe12x4_type, fe12x4_type]
+fe12x4_square = ref12.crypto_scalarmult_curve13318_ref12_fe12x4_square
+fe12x4_square.argtypes = [fe12x4_type, fe12x4_type]
+fe12x4_select = ref12.crypto_scalarmult_curve13318_ref12_fe12x4_select
+fe12x4_select.argtypes = [fe12x4_type, fe12x4_type, fe12x4_type, ctypes.c_ubyte * 4]
+fe12x4_frombytes = ref12.crypto_scalarmult_curve13318_ref12_fe12x4_frombytes
+fe12x4_frombytes.argtypes = [fe12x4_type, (ctypes.c_ubyte * 32) * 4]
+fe12x4_tobytes = ref12.crypto_scalarmult_curve13318_ref12_fe12x4_tobytes
+fe12x4_tobytes.argtypes = [(ctypes.c_ubyte * 32) * 4, fe12x4_type]
+fe12x4_invert = ref12.crypto_scalarmult_curve13318_ref12_fe12x4_invert
+fe12x4_invert.argtypes = [fe12x4_type, fe12x4_type]
+fe12x4_pow2523 = ref12.crypto_scalarmult_curve13318_ref12_fe12x4_pow2523
+fe12x4_pow2523.argtypes = [fe12x4_type, fe12x4_type]
+fe12x4_sqrt = ref12.crypto_scalarmult_curve13318_ref12_fe12x4_sqrt
+fe12x4_sqrt.argtypes = [fe12x4_type, ctypes.c_ubyte * 4, fe12x4_type]
+fe12x4_legendre = ref12.crypto_scalarmult_curve13318_ref12_fe12x4_legendre
+fe12x4_legendre.argtypes = [ctypes.c_byte * 4, fe12x4_type]
+fe64_tobytes = ref12.crypto_scalarmult_curve13318_ref12_fe64_tobytes
+fe64_tobytes.argtypes = [ctypes.c_ubyte * 32, fe64_type]
+fe64_add = ref12.crypto_scalarmult_curve13318_ref12_fe64_add
+fe64_add.argtypes = [fe64_type, fe64_type, fe64_type]
+fe64_sub = ref12.crypto_scalarmult_curve13318_ref12_fe64_sub
+fe64_sub.argtypes = [fe64_type, fe64_type, fe64_type]
+fe64_mul = ref12.crypto_scalarmult_curve13318_ref12_fe64_mul
+fe64_mul.argtypes = [fe64_type, fe64_type, fe64_type]
+fe64_square = ref12.crypto_scalarmult_curve13318_ref12_fe64_square
+fe64_square.argtypes = [fe64_type, fe64_type]
+fe64_invert = ref12.crypto_scalarmult_curve13318_ref12_fe64_invert
+fe64_invert.argtypes = [fe64_type, fe64_type]
+scalarmult_mulx = ref12.crypto_scalarmult_curve13318_scalarmult_mulx
+scalarmult_mulx.argtypes = [ctypes.c_ubyte * 64, ctypes.c_ubyte * 32, ctypes.c_ubyte * 64]
+fe12x2_mul = ref12.crypto_scalarmult_curve13318_ref12_fe12x2_mul
+fe12x2_mul.argtypes = [fe12_type] * 6
+fe12x2_squeeze = ref12.crypto_scalarmult_curve13318_ref12_fe12x2_squeeze
+fe12x2_squeeze.argtypes = [fe12_type] * 2
+ge_add_sse2 = ref12.crypto_scalarmult_curve13318_ref12_ge_add_sse2
+ge_add_sse2.argtypes = [ge_type] * 3
+ge_double_sse2 = ref12.crypto_scalarmult_curve13318_ref12_ge_double_sse2
+ge_double_sse2.argtypes = [ge_type] * 2
+scalarmult_sse2 = ref12.crypto_scalarmult_curve13318_scalarmult_sse2
+scalarmult_sse2.argtypes = [ctypes.c_ubyte * 64, ctypes.c_ubyte * 32, ctypes.c_ubyte * 64]
+ge_add_intrin = ref12.crypto_scalarmult_curve13318_ref12_ge_add_intrin
+ge_add_intrin.argtypes = [ge_type] * 3
+ge_double_intrin = ref12.crypto_scalarmult_curve13318_ref12_ge_double_intrin
+ge_double_intrin.argtypes = [ge_type] * 2
+ge_add_x4 = ref12.crypto_scalarmult_curve13318_ref12_ge_add_x4
+ge_add_x4.argtypes = [ge_x4_type] * 3
+ge_double_x4 = ref12.crypto_scalarmult_curve13318_ref12_ge_double_x4
+ge_double_x4.argtypes = [ge_x4_type] * 2
+scalarmult_avx_intrin = ref12.crypto_scalarmult_curve13318_scalarmult_avx_intrin
+scalarmult_avx_intrin.argtypes = [ctypes.c_ubyte * 64, ctypes.c_ubyte * 32, ctypes.c_ubyte * 64]
+sc_frombytes = ref12.crypto_scalarmult_curve13318_ref12_sc_frombytes
+sc_frombytes.argtypes = [sc_type, ctypes.c_ubyte * 32]
+sc_reduce = ref12.crypto_scalarmult_curve13318_ref12_sc_reduce
+sc_reduce.argtypes = [sc_type, ctypes.c_ubyte * 64]
+sc_add = ref12.crypto_scalarmult_curve13318_ref12_sc_add
+sc_add.argtypes = [sc_type] * 3
+sc_neg = ref12.crypto_scalarmult_curve13318_ref12_sc_neg
+sc_neg.argtypes = [sc_type] * 2
+sc_mul = ref12.crypto_scalarmult_curve13318_ref12_sc_mul
+sc_mul.argtypes = [sc_type] * 3
+sc_muladd = ref12.crypto_scalarmult_curve13318_ref12_sc_muladd
+sc_muladd.argtypes = [sc_type] * 4
+schnorr_keypair = ref12.crypto_scalarmult_curve13318_schnorr_keypair
+schnorr_keypair.argtypes = [ctypes.c_ubyte * 64, ctypes.c_ubyte * 96]
+schnorr_sign = ref12.crypto_scalarmult_curve13318_schnorr_sign
+schnorr_sign.argtypes = [ctypes.c_ubyte * 96, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_ubyte * 96]
+schnorr_verify = ref12.crypto_scalarmult_curve13318_schnorr_verify
+schnorr_verify.argtypes = [ctypes.c_ubyte * 96, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_ubyte * 64]
+schnorr_verify_batch = ref12.crypto_scalarmult_curve13318_schnorr_verify_batch
+hash_to_field = ref12.crypto_scalarmult_curve13318_ref12_hash_to_field
+hash_to_field.argtypes = [ctypes.c_ubyte * 64, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_char_p, ctypes.c_size_t]
+ge_map_to_curve = ref12.crypto_scalarmult_curve13318_ref12_ge_map_to_curve
+ge_map_to_curve.argtypes = [ge_type, ctypes.c_ubyte * 32]
+ge_map_to_curve_x4 = ref12.crypto_scalarmult_curve13318_ref12_ge_map_to_curve_x4
+ge_map_to_curve_x4.argtypes = [ge_x4_type, (ctypes.c_ubyte * 32) * 4]
+hash_to_curve = ref12.crypto_scalarmult_curve13318_hash_to_curve
+hash_to_curve.argtypes = [ctypes.c_ubyte * 64, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_char_p, ctypes.c_size_t]
+hash_to_curve_x4 = ref12.crypto_scalarmult_curve13318_hash_to_curve_x4
 
 
 # Custom testing strategies
@@ -125,6 +274,8 @@ st_fe10_carried_2 = st.tuples(st.integers(0, 2**28), st.integers(0, 2**27),
                               st.integers(0, 2**28), st.integers(0, 2**27),
                               st.integers(0, 2**28), st.integers(0, 2**27))
 st_fe10_uncarried = st.lists(st.integers(0, 2**63), min_size=10, max_size=10)
+st_fe64 = st.integers(0, 2**256 - 1)
+st_sc = st.integers(0, SC_ORDER - 1)
 
 
 class TestFE12(unittest.TestCase):
@@ -186,6 +337,22 @@ class TestFE12(unittest.TestCase):
         actual = F(fe12_val(h_c))
         self.assertEqual(actual, expected)
 
+    @given(st_fe12_squeezed_1)
+    @example([2**22 - 1] + [2**21 - 1] * 3 + [2**22 - 1] + [2**21 - 1] * 3 +
+             [2**22 - 1] + [2**21 - 1] * 3)
+    def test_freeze(self, limbs):
+        z, z_c = make_fe12(limbs)
+        frozen_c = (ctypes.c_double * 6)(0.0)
+        fe12_freeze(frozen_c, z_c)
+        offsets = [0, 43, 85, 128, 170, 213, 255]
+        for i, limb in enumerate(frozen_c):
+            self.assertEqual(int(limb) % 2**offsets[i], 0)
+            self.assertTrue(0 <= int(limb) < 2**offsets[i + 1])
+        self.assertEqual(sum(int(x) for x in frozen_c), z.lift())
+        bytes_c = (ctypes.c_ubyte * 32)(0)
+        fe12_tobytes(bytes_c, z_c)
+        self.assertEqual(sum(b << (8*i) for i, b in enumerate(bytes_c)), z.lift())
+
 class TestFE12x4(unittest.TestCase):
     @given(st_fe12_unsqueezed, st.integers(0, 3))
     def test_squeeze(self, limbs, lane):
@@ -203,6 +370,26 @@ class TestFE12x4(unittest.TestCase):
         actual = sum(F(int(x)) for x in vz_c[lane::4])
         self.assertEqual(actual, expected)
 
+    @given(st_fe12_unsqueezed, st.integers(0, 3))
+    def test_carry(self, limbs, lane):
+        expected, vz_c = make_fe12x4(limbs, lane)
+        fe12x4_carry(vz_c)
+
+        # Is every limb reduced, except for the carry from its predecessor?
+        widths = [22 if i % 4 == 0 else 21 for i in range(12)]
+        exponent = 0
+        for i, limb in enumerate(vz_c[lane::4]):
+            assert int(limb) % 2**exponent == 0, (i, hex(int(limb)), exponent)
+            carry = abs(limbs[i - 1]) // 2**widths[i - 1] + 1
+            if i == 0:
+                carry *= 19
+            bound = (2**(widths[i] - 1) + carry) * 2**exponent
+            assert abs(int(limb)) <= bound, (i, hex(int(limb)), hex(bound))
+            exponent += widths[i]
+        # Decode the value
+        actual = sum(F(int(x)) for x in vz_c[lane::4])
+        self.assertEqual(actual, expected)
+
     @given(st_fe12_squeezed_0, st_fe12_squeezed_1, st.integers(0,3), st.booleans())
     def test_mul(self, f_limbs, g_limbs, lane, swap):
         fhex = lambda x: [x.hex() for x in list(x)]
@@ -223,8 +410,122 @@ class TestFE12x4(unittest.TestCase):
         actual = F(fe12x4_val(h_c, lane))
         self.assertEqual(actual, expected)
 
+    @given(st_fe12_squeezed_0, st.integers(0,3))
+    def test_square(self, f_limbs, lane):
+        f, f_c = make_fe12x4(f_limbs, lane)
+        expected = f**2
+        fe12x4_square(f_c, f_c)
+        actual = F(fe12x4_val(f_c, lane))
+        self.assertEqual(actual, expected)
+
+    @given(st_fe12_squeezed_0, st_fe12_squeezed_1, st.integers(0,3),
+           st.lists(st.integers(0, 1), min_size=4, max_size=4))
+    def test_select(self, f_limbs, g_limbs, lane, c):
+        f, f_c = make_fe12x4(f_limbs, lane)
+        g, g_c = make_fe12x4(g_limbs, lane)
+        _, h_c = make_fe12x4([], lane)
+        fe12x4_select(h_c, f_c, g_c, (ctypes.c_ubyte * 4)(*c))
+        for i in range(4):
+            expected = g_c if c[i] else f_c
+            self.assertEqual(list(h_c[i::4]), list(expected[i::4]))
+
+    @given(st.lists(st.integers(0, 2**256 - 1), min_size=4, max_size=4))
+    @example([0, P - 1, P, 2**255 - 1])
+    def test_frombytes_tobytes(self, values):
+        bytes_c = ((ctypes.c_ubyte * 32) * 4)()
+        for i, x in enumerate(values):
+            bytes_c[i] = (ctypes.c_ubyte * 32)(*[(x >> (8*j)) & 0xFF for j in range(32)])
+        _, z_c = make_fe12x4([], 0)
+        fe12x4_frombytes(z_c, bytes_c)
+        for i, x in enumerate(values):
+            self.assertEqual(F(fe12x4_val(z_c, i)), F(x))
+        out_c = ((ctypes.c_ubyte * 32) * 4)()
+        fe12x4_squeeze(z_c)
+        fe12x4_tobytes(out_c, z_c)
+        for i, x in enumerate(values):
+            actual = sum(b << (8*j) for j, b in enumerate(out_c[i]))
+            self.assertEqual(actual, x % P)
+
+    @given(st.lists(st.integers(0, P - 1), min_size=4, max_size=4))
+    @example([0, 1, P - 1, 2])
+    def test_invert(self, values):
+        z_c = make_fe12x4_values(values)
+        _, h_c = make_fe12x4([], 0)
+        fe12x4_invert(h_c, z_c)
+        for i, x in enumerate(values):
+            expected = F(x)**(P - 2)
+            self.assertEqual(F(fe12x4_val(h_c, i)), expected)
+
+    @given(st.lists(st.integers(0, P - 1), min_size=4, max_size=4))
+    @example([0, 1, P - 1, 2])
+    def test_pow2523(self, values):
+        z_c = make_fe12x4_values(values)
+        _, h_c = make_fe12x4([], 0)
+        fe12x4_pow2523(h_c, z_c)
+        for i, x in enumerate(values):
+            expected = F(x)**((P - 5) // 8)
+            self.assertEqual(F(fe12x4_val(h_c, i)), expected)
+
+    @given(st.lists(st.integers(0, P - 1), min_size=4, max_size=4))
+    @example([0, 1, P - 1, 2])
+    def test_sqrt(self, values):
+        z_c = make_fe12x4_values(values)
+        _, h_c = make_fe12x4([], 0)
+        ok_c = (ctypes.c_ubyte * 4)()
+        fe12x4_sqrt(h_c, ok_c, z_c)
+        for i, x in enumerate(values):
+            self.assertEqual(ok_c[i], 1 if F(x).is_square() else 0)
+            if ok_c[i]:
+                self.assertEqual(F(fe12x4_val(h_c, i))**2, F(x))
+
+    @given(st.lists(st.integers(0, P - 1), min_size=4, max_size=4))
+    @example([0, 1, P - 1, 2])
+    def test_legendre(self, values):
+        z_c = make_fe12x4_values(values)
+        chi_c = (ctypes.c_byte * 4)()
+        fe12x4_legendre(chi_c, z_c)
+        for i, x in enumerate(values):
+            self.assertEqual(chi_c[i], kronecker(x, P))
+
+
+class TestFE12x2(unittest.TestCase):
+    @given(st_fe12_unsqueezed, st_fe12_unsqueezed)
+    def test_squeeze(self, limbs0, limbs1):
+        expected0, z0_c = make_fe12(limbs0)
+        expected1, z1_c = make_fe12(limbs1)
+        fe12x2_squeeze(z0_c, z1_c)
+
+        for expected, z_c in [(expected0, z0_c), (expected1, z1_c)]:
+            # Are all limbs reduced?
+            exponent = 0
+            for i, limb in enumerate(z_c):
+                assert int(limb) % 2**exponent == 0, (i, hex(int(limb)), exponent)
+                exponent += 22 if i % 4 == 0 else 21
+                assert abs(int(limb)) <= 2**(exponent-1), (i, hex(int(limb)), exponent)
+            self.assertEqual(sum(F(int(x)) for x in z_c), expected)
+
+    @given(st_fe12_squeezed_0, st_fe12_squeezed_1,
+           st_fe12_squeezed_1, st_fe12_squeezed_0)
+    def test_mul(self, f0_limbs, g0_limbs, f1_limbs, g1_limbs):
+        f0, f0_c = make_fe12(f0_limbs)
+        g0, g0_c = make_fe12(g0_limbs)
+        f1, f1_c = make_fe12(f1_limbs)
+        g1, g1_c = make_fe12(g1_limbs)
+        _, h0_c = make_fe12()
+        _, h1_c = make_fe12()
+        fe12x2_mul(h0_c, f0_c, g0_c, h1_c, f1_c, g1_c)
+        self.assertEqual(F(fe12_val(h0_c)), f0 * g0)
+        self.assertEqual(F(fe12_val(h1_c)), f1 * g1)
+
 
 class TestFE10(unittest.TestCase):
+    @given(st.integers(0, 2**256 - 1))
+    def test_frombytes(self, s):
+        s_c = (ctypes.c_ubyte * 32)(*[(s >> (8*i)) & 0xFF for i in range(32)])
+        _, z_c = make_fe10()
+        fe10_frombytes(z_c, s_c)
+        self.assertEqual(F(fe10_val(z_c)), F(s))
+
     @given(st_fe10_carried_0)
     def test_tobytes(self, limbs):
         expected, z_c = make_fe10(limbs)
@@ -287,6 +588,55 @@ class TestFE10(unittest.TestCase):
         assert(0 <= actual < 2**255 - 19)
 
 
+class TestFE64(unittest.TestCase):
+    @given(st_fe64)
+    @example(P)
+    @example(2**255 - 1)
+    @example(2**256 - 1)
+    def test_tobytes(self, f):
+        f_c = make_fe64(f)
+        c_bytes = (ctypes.c_ubyte * 32)(0)
+        fe64_tobytes(c_bytes, f_c)
+        actual = sum(x * 2**(8*i) for i,x in enumerate(c_bytes))
+        self.assertEqual(actual, f % P)
+
+    @given(st_fe64, st_fe64)
+    @example(2**256 - 1, 2**256 - 1)
+    def test_add(self, f, g):
+        h_c = make_fe64()
+        fe64_add(h_c, make_fe64(f), make_fe64(g))
+        self.assertEqual(F(fe64_val(h_c)), F(f + g))
+
+    @given(st_fe64, st_fe64)
+    @example(0, 2**256 - 1)
+    @example(37, 2**256 - 1)
+    def test_sub(self, f, g):
+        h_c = make_fe64()
+        fe64_sub(h_c, make_fe64(f), make_fe64(g))
+        self.assertEqual(F(fe64_val(h_c)), F(f - g))
+
+    @given(st_fe64, st_fe64)
+    @example(2**256 - 1, 2**256 - 1)
+    def test_mul(self, f, g):
+        h_c = make_fe64()
+        fe64_mul(h_c, make_fe64(f), make_fe64(g))
+        self.assertEqual(F(fe64_val(h_c)), F(f * g))
+
+    @given(st_fe64)
+    @example(2**256 - 1)
+    def test_square(self, f):
+        h_c = make_fe64()
+        fe64_square(h_c, make_fe64(f))
+        self.assertEqual(F(fe64_val(h_c)), F(f**2))
+
+    @given(st_fe64)
+    def test_invert(self, f):
+        expected = F(f)**-1 if F(f) != 0 else 0
+        h_c = make_fe64()
+        fe64_invert(h_c, make_fe64(f))
+        self.assertEqual(F(fe64_val(h_c)), expected)
+
+
 class TestConvert(unittest.TestCase):
     @given(st_fe12_squeezed_0)
     def test_convert_fe12_to_fe10(self, limbs):
@@ -389,6 +739,24 @@ class TestGE(unittest.TestCase):
         self.assertEqual(actual_y, y)
         self.assertEqual(actual_z, z)
 
+    @given(st.integers(0, P - 1), st.sampled_from([1, -1]), st.booleans(),
+           st.booleans())
+    def test_frombytes_noncanonical(self, x, sign, add_p_x, add_p_y):
+        # Coordinates in [p, 2^256) are reduced, also when the 255'th bit is set
+        try:
+            x, y = (sign * E.lift_x(F(x))).xy()
+        except ValueError:
+            assume(False)
+        x_in, y_in = x.lift() + add_p_x * P, y.lift() + add_p_y * P
+        c_bytes = self.point_to_bytes(x_in, y_in)
+        c_point = ge_type(fe12_type(0))
+        ret = ge_frombytes(c_point, c_bytes)
+        actual_x, actual_y, actual_z = self.decode_point(c_point)
+        self.assertEqual(ret, 0)
+        self.assertEqual(actual_x, x)
+        self.assertEqual(actual_y, y)
+        self.assertEqual(actual_z, 1)
+
     @given(st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1),
            st.sampled_from([1, -1]))
     @example(0, 0, 1) # a point at infinity
@@ -429,6 +797,46 @@ class TestGE(unittest.TestCase):
     def test_add_c(self, x1, z1, sign1, x2, z2, sign2):
         self.do_test_add(ge_add_c)(x1, z1, sign1, x2, z2, sign2)
 
+    @given(st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1),
+           st.sampled_from([1, -1]),   st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 0, 1, 0, 0, 1)
+    @example(0, 1, 1, 0, 0, 1)
+    @example(0, 1, -1, 0, 0, 1)
+    @settings(suppress_health_check=[HealthCheck.filter_too_much])
+    def test_add_gen(self, x1, z1, sign1, x2, z2, sign2):
+        self.do_test_add(ge_add_gen)(x1, z1, sign1, x2, z2, sign2)
+
+    @given(st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1),
+           st.sampled_from([1, -1]),   st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 0, 1, 0, 0, 1)
+    @example(0, 1, 1, 0, 0, 1)
+    @example(0, 1, -1, 0, 0, 1)
+    @settings(suppress_health_check=[HealthCheck.filter_too_much])
+    def test_add_sse2(self, x1, z1, sign1, x2, z2, sign2):
+        self.do_test_add(ge_add_sse2)(x1, z1, sign1, x2, z2, sign2)
+
+    @given(st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1),
+           st.sampled_from([1, -1]),   st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 0, 1, 0, 0, 1)
+    @example(0, 1, 1, 0, 0, 1)
+    @example(0, 1, -1, 0, 0, 1)
+    @settings(suppress_health_check=[HealthCheck.filter_too_much])
+    def test_add_intrin(self, x1, z1, sign1, x2, z2, sign2):
+        self.do_test_add(ge_add_intrin)(x1, z1, sign1, x2, z2, sign2)
+
+    @given(st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1),
+           st.sampled_from([1, -1]),   st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 0, 1, 0, 0, 1)
+    @example(0, 1, 1, 0, 0, 1)
+    @example(0, 1, -1, 0, 0, 1)
+    @settings(suppress_health_check=[HealthCheck.filter_too_much])
+    def test_add_x4(self, x1, z1, sign1, x2, z2, sign2):
+        self.do_test_add(ge_add_x4_lanes)(x1, z1, sign1, x2, z2, sign2)
+
     def do_test_add(self, fn):
         def do_test_add_inner(x1, z1, sign1, x2, z2, sign2):
             (x1, y1, z1), point1 = make_ge(x1, z1, sign1)
@@ -468,6 +876,44 @@ class TestGE(unittest.TestCase):
     def test_double_c(self, x, z, sign):
         self.do_test_double(ge_double_c)(x, z, sign)
 
+    @example(0, 0, 1)
+    @example(0, 1, 1)
+    @example(0, 1, -1)
+    @example(5, 26250914708855074711006248540861075732027942443063102939584266239L, 1)
+    @given(st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1),
+           st.sampled_from([1, -1]))
+    @settings(suppress_health_check=[HealthCheck.filter_too_much])
+    def test_double_gen(self, x, z, sign):
+        self.do_test_double(ge_double_gen)(x, z, sign)
+
+    @example(0, 0, 1)
+    @example(0, 1, 1)
+    @example(0, 1, -1)
+    @example(5, 26250914708855074711006248540861075732027942443063102939584266239L, 1)
+    @given(st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1),
+           st.sampled_from([1, -1]))
+    @settings(suppress_health_check=[HealthCheck.filter_too_much])
+    def test_double_sse2(self, x, z, sign):
+        self.do_test_double(ge_double_sse2)(x, z, sign)
+
+    @example(0, 0, 1)
+    @example(0, 1, 1)
+    @example(0, 1, -1)
+    @given(st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1),
+           st.sampled_from([1, -1]))
+    @settings(suppress_health_check=[HealthCheck.filter_too_much])
+    def test_double_intrin(self, x, z, sign):
+        self.do_test_double(ge_double_intrin)(x, z, sign)
+
+    @example(0, 0, 1)
+    @example(0, 1, 1)
+    @example(0, 1, -1)
+    @given(st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1),
+           st.sampled_from([1, -1]))
+    @settings(suppress_health_check=[HealthCheck.filter_too_much])
+    def test_double_x4(self, x, z, sign):
+        self.do_test_double(ge_double_x4_lanes)(x, z, sign)
+
     def do_test_double(self, fn):
         def do_test_double_inner(x, z, sign):
             (x, y, z), point = make_ge(x, z, sign)
@@ -661,10 +1107,7 @@ class TestScalarmult(unittest.TestCase):
             k_bytes[i] = (k >> (8*i)) & 0xFF
         return k_bytes
 
-    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
-           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
-    @example(0, 1, 0, 1)
-    def test_scalarmult(self, k, x, z, sign):
+    def check_scalarmult(self, fn, k, x, z, sign):
         _, point = make_ge(x, z, sign)
         note('Initial point: ' + str(point))
         if point.is_zero():
@@ -675,7 +1118,7 @@ class TestScalarmult(unittest.TestCase):
         k_bytes = self.encode_k(k)
         c_bytes_out = (ctypes.c_ubyte * 64)(0)
 
-        ret = scalarmult(c_bytes_out, k_bytes, c_bytes_in)
+        ret = fn(c_bytes_out, k_bytes, c_bytes_in)
         actual = [int(x) for x in c_bytes_out]
 
         expected_point = k * point
@@ -690,10 +1133,7 @@ class TestScalarmult(unittest.TestCase):
         self.assertEqual(ret, 0)
         self.assertEqual(actual, expected)
 
-    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
-           st.integers(0, 2**256 - 1))
-    @example(0, 0, 0)
-    def test_scalarmult_invalid_point(self, k, x, y):
+    def check_scalarmult_invalid_point(self, fn, k, x, y):
         if (x, y) in E or (x, y) == (0, 0):
             expected = 0
         else:
@@ -701,9 +1141,276 @@ class TestScalarmult(unittest.TestCase):
         c_bytes_in = TestGE.point_to_bytes(x, y)
         k_bytes = self.encode_k(k)
         c_bytes_out = (ctypes.c_ubyte * 64)(0)
-        ret = scalarmult(c_bytes_out, k_bytes, c_bytes_in)
+        ret = fn(c_bytes_out, k_bytes, c_bytes_in)
         self.assertEqual(ret, expected)
 
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 1, 0, 1)
+    def test_scalarmult(self, k, x, z, sign):
+        self.check_scalarmult(scalarmult, k, x, z, sign)
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1))
+    @example(0, 0, 0)
+    def test_scalarmult_invalid_point(self, k, x, y):
+        self.check_scalarmult_invalid_point(scalarmult, k, x, y)
+
+    def check_scalarmult_two(self, fn, k, x1, z1, sign1, x2, z2, sign2):
+        def point_to_bytes(point):
+            if point.is_zero():
+                return TestGE.point_to_bytes(0, 0)
+            (x, y) = point.xy()
+            return TestGE.point_to_bytes(x.lift(), y.lift())
+
+        _, point1 = make_ge(x1, z1, sign1)
+        _, point2 = make_ge(x2, z2, sign2)
+        k_bytes = self.encode_k(k)
+        c_bytes_out1 = (ctypes.c_ubyte * 64)(0)
+        c_bytes_out2 = (ctypes.c_ubyte * 64)(0)
+        ret = fn(c_bytes_out1, c_bytes_out2, k_bytes,
+                 point_to_bytes(point1), point_to_bytes(point2))
+        self.assertEqual(ret, 0)
+        self.assertEqual(list(c_bytes_out1), list(point_to_bytes(k * point1)))
+        self.assertEqual(list(c_bytes_out2), list(point_to_bytes(k * point2)))
+
+    @given(st.integers(0, 2**255 - 1),
+           st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1), st.sampled_from([1, -1]),
+           st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 0, 1, 1, 0, 1, -1)
+    @example(5, 0, 1, 1, 0, 0, 1)
+    def test_scalarmult_two(self, k, x1, z1, sign1, x2, z2, sign2):
+        self.check_scalarmult_two(scalarmult_two, k, x1, z1, sign1, x2, z2, sign2)
+
+    @given(st.integers(0, 2**255 - 1),
+           st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1), st.sampled_from([1, -1]),
+           st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 0, 1, 1, 0, 1, -1)
+    @example(5, 0, 1, 1, 0, 0, 1)
+    def test_scalarmult_two_avx_intrin(self, k, x1, z1, sign1, x2, z2, sign2):
+        self.check_scalarmult_two(scalarmult_two_avx_intrin, k, x1, z1, sign1, x2, z2, sign2)
+
+    def check_scalarmult_many(self, fn, ks, x, z, sign):
+        def point_to_bytes(point):
+            if point.is_zero():
+                return TestGE.point_to_bytes(0, 0)
+            (x, y) = point.xy()
+            return TestGE.point_to_bytes(x.lift(), y.lift())
+
+        _, point = make_ge(x, z, sign)
+        keys_c = ((ctypes.c_ubyte * 32) * len(ks))()
+        for i, k in enumerate(ks):
+            keys_c[i][:] = list(self.encode_k(k))
+        out_c = ((ctypes.c_ubyte * 64) * len(ks))()
+        ret = fn(out_c, keys_c, point_to_bytes(point), ctypes.c_size_t(len(ks)))
+        self.assertEqual(ret, 0)
+        for i, k in enumerate(ks):
+            self.assertEqual(list(out_c[i]), list(point_to_bytes(k * point)))
+
+    @settings(max_examples=20)
+    @given(st.lists(st.integers(0, 2**255 - 1), max_size=10),
+           st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example([0, 1, 2**255 - 1, 5, 0], 0, 1, 1)
+    @example([3, 4], 0, 0, 1)
+    def test_scalarmult_many(self, ks, x, z, sign):
+        self.check_scalarmult_many(scalarmult_many, ks, x, z, sign)
+
+    @settings(max_examples=20)
+    @given(st.lists(st.integers(0, 2**255 - 1), max_size=10),
+           st.integers(0, 2**256 - 1), st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example([0, 1, 2**255 - 1, 5, 0], 0, 1, 1)
+    def test_scalarmult_many_avx_intrin(self, ks, x, z, sign):
+        self.check_scalarmult_many(scalarmult_many_avx_intrin, ks, x, z, sign)
+
+    def check_scalarmult_split(self, fn, k, x, z, sign):
+        _, point = make_ge(x, z, sign)
+        if point.is_zero():
+            point_c = TestGE.point_to_bytes(0, 0)
+        else:
+            point_c = TestGE.point_to_bytes(*[c.lift() for c in point.xy()])
+        expected_c = (ctypes.c_ubyte * 64)(0)
+        self.assertEqual(scalarmult(expected_c, self.encode_k(k), point_c), 0)
+
+        registered = scalarmult_split_new(point_c)
+        self.assertIsNotNone(registered)
+        actual_c = (ctypes.c_ubyte * 64)(0)
+        ret = fn(actual_c, self.encode_k(k), registered)
+        scalarmult_split_free(registered)
+        self.assertEqual(ret, 0)
+        self.assertEqual(list(actual_c), list(expected_c))
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 1, 0, 1)
+    @example(2**255 - 1, 0, 1, 1)
+    @example(2**64 - 1, 0, 1, -1)
+    def test_scalarmult_split(self, k, x, z, sign):
+        self.check_scalarmult_split(scalarmult_split, k, x, z, sign)
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 1, 0, 1)
+    @example(2**255 - 1, 0, 1, 1)
+    def test_scalarmult_split_avx_intrin(self, k, x, z, sign):
+        self.check_scalarmult_split(scalarmult_split_avx_intrin, k, x, z, sign)
+
+    def test_scalarmult_split_invalid_point(self):
+        self.assertIsNone(scalarmult_split_new(TestGE.point_to_bytes(1, 1)))
+
+    @settings(max_examples=20)
+    @given(st.lists(st.tuples(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+                              st.integers(0, 2**256 - 1), st.sampled_from([1, -1])),
+                    min_size=1, max_size=6))
+    @example([(0, 0, 1, 1), (5, 0, 0, 1)])
+    def test_scalarmult_ctx(self, requests):
+        ctx = scalarmult_ctx_new()
+        self.assertIsNotNone(ctx)
+        self.assertEqual(scalarmult_ctx_enter(ctx), 0)
+        self.assertNotEqual(scalarmult_ctx_enter(ctx), 0)
+        for (k, x, z, sign) in requests:
+            _, point = make_ge(x, z, sign)
+            if point.is_zero():
+                in_c = TestGE.point_to_bytes(0, 0)
+            else:
+                in_c = TestGE.point_to_bytes(*[c.lift() for c in point.xy()])
+            expected_c = (ctypes.c_ubyte * 64)(0)
+            self.assertEqual(scalarmult(expected_c, self.encode_k(k), in_c), 0)
+            actual_c = (ctypes.c_ubyte * 64)(0)
+            self.assertEqual(scalarmult_ctx_run(ctx, actual_c, self.encode_k(k), in_c), 0)
+            self.assertEqual(list(actual_c), list(expected_c))
+        self.assertNotEqual(scalarmult_ctx_run(ctx, actual_c, self.encode_k(1),
+                                               TestGE.point_to_bytes(1, 1)), 0)
+        self.assertEqual(scalarmult_ctx_leave(ctx), 0)
+        self.assertNotEqual(scalarmult_ctx_leave(ctx), 0)
+        self.assertNotEqual(scalarmult_ctx_run(ctx, actual_c, self.encode_k(1), in_c), 0)
+        scalarmult_ctx_free(ctx)
+
+    def check_scalarmult_lowstack(self, fn, k, x, z, sign):
+        _, point = make_ge(x, z, sign)
+        if point.is_zero():
+            in_c = TestGE.point_to_bytes(0, 0)
+        else:
+            in_c = TestGE.point_to_bytes(*[c.lift() for c in point.xy()])
+        expected_c = (ctypes.c_ubyte * 64)(0)
+        self.assertEqual(scalarmult(expected_c, self.encode_k(k), in_c), 0)
+        actual_c = (ctypes.c_ubyte * 64)(0)
+        self.assertEqual(fn(actual_c, self.encode_k(k), in_c), 0)
+        self.assertEqual(list(actual_c), list(expected_c))
+        self.assertNotEqual(fn(actual_c, self.encode_k(k), TestGE.point_to_bytes(1, 1)), 0)
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 1, 0, 1)
+    @example(2**255 - 1, 0, 1, 1)
+    def test_scalarmult_arena(self, k, x, z, sign):
+        # The arena does not need to be aligned
+        arena = ctypes.create_string_buffer(scalarmult_arena_size() + 1)
+        arena_p = ctypes.c_void_p(ctypes.addressof(arena) + 1)
+        fn = lambda out, key, in_c: scalarmult_arena(out, key, in_c, arena_p)
+        self.check_scalarmult_lowstack(fn, k, x, z, sign)
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 1, 0, 1)
+    @example(2**255 - 1, 0, 1, 1)
+    def test_scalarmult_lowstack(self, k, x, z, sign):
+        self.check_scalarmult_lowstack(scalarmult_lowstack, k, x, z, sign)
+
+    def check_keypair(self, secret_c, public_c, point):
+        k = sum(int(b) << (8*i) for i, b in enumerate(secret_c))
+        self.assertLess(k, 2**255)
+        expected = k * point
+        if expected.is_zero():
+            expected_x, expected_y = 0, 0
+        else:
+            expected_x, expected_y = [c.lift() for c in expected.xy()]
+        expected = TestGE.point_to_bytes(expected_x, expected_y)
+        self.assertEqual(list(public_c), list(expected))
+
+    @given(st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 1)
+    def test_keypair(self, x, sign):
+        _, point = make_ge(x, 1, sign)
+        (x, y) = point.xy()
+        secret_c = (ctypes.c_ubyte * 32)(0)
+        public_c = (ctypes.c_ubyte * 64)(0)
+        ret = keypair(secret_c, public_c, TestGE.point_to_bytes(x.lift(), y.lift()))
+        self.assertEqual(ret, 0)
+        self.check_keypair(secret_c, public_c, point)
+
+    def test_keypool(self):
+        _, point = make_ge(0, 1, 1)
+        (x, y) = point.xy()
+        base_c = TestGE.point_to_bytes(x.lift(), y.lift())
+        self.assertIsNone(keypool_new(base_c, 4, 4))
+        self.assertIsNone(keypool_new(TestGE.point_to_bytes(1, 1), 2, 4))
+
+        pool = keypool_new(base_c, 2, 4)
+        self.assertIsNotNone(pool)
+        secrets = set()
+        # Pop more than the pool holds, so that some pairs are made inline
+        for _ in range(10):
+            secret_c = (ctypes.c_ubyte * 32)(0)
+            public_c = (ctypes.c_ubyte * 64)(0)
+            self.assertEqual(keypool_pop(pool, secret_c, public_c), 0)
+            self.check_keypair(secret_c, public_c, point)
+            secrets.add(tuple(secret_c))
+            self.assertLessEqual(keypool_available(pool), 4)
+        self.assertEqual(len(secrets), 10)
+        keypool_free(pool)
+
+    def test_scalarmult_variant(self):
+        self.assertIn(scalarmult_variant(), ["mulx", "avx", "avx_intrin", "sse2"])
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 1, 0, 1)
+    def test_scalarmult_avx(self, k, x, z, sign):
+        self.check_scalarmult(scalarmult_avx, k, x, z, sign)
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1))
+    @example(0, 0, 0)
+    def test_scalarmult_avx_invalid_point(self, k, x, y):
+        self.check_scalarmult_invalid_point(scalarmult_avx, k, x, y)
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 1, 0, 1)
+    def test_scalarmult_avx_intrin(self, k, x, z, sign):
+        self.check_scalarmult(scalarmult_avx_intrin, k, x, z, sign)
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1))
+    @example(0, 0, 0)
+    def test_scalarmult_avx_intrin_invalid_point(self, k, x, y):
+        self.check_scalarmult_invalid_point(scalarmult_avx_intrin, k, x, y)
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 1, 0, 1)
+    def test_scalarmult_mulx(self, k, x, z, sign):
+        self.check_scalarmult(scalarmult_mulx, k, x, z, sign)
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1))
+    @example(0, 0, 0)
+    @example(0, P, 0)
+    def test_scalarmult_mulx_invalid_point(self, k, x, y):
+        self.check_scalarmult_invalid_point(scalarmult_mulx, k, x, y)
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1), st.sampled_from([1, -1]))
+    @example(0, 1, 0, 1)
+    def test_scalarmult_sse2(self, k, x, z, sign):
+        self.check_scalarmult(scalarmult_sse2, k, x, z, sign)
+
+    @given(st.integers(0, 2**255 - 1), st.integers(0, 2**256 - 1),
+           st.integers(0, 2**256 - 1))
+    @example(0, 0, 0)
+    def test_scalarmult_sse2_invalid_point(self, k, x, y):
+        self.check_scalarmult_invalid_point(scalarmult_sse2, k, x, y)
+
     @given(st.integers(-1, 15), st.one_of(st.none(), st.data()))
     def test_select(self, idx, random_numbers):
         dest_c = allocate_aligned(ge_type, 32)
@@ -732,6 +1439,282 @@ class TestScalarmult(unittest.TestCase):
         self.assertEqual(actual, expected)
 
 
+class TestSc(unittest.TestCase):
+    def test_order(self):
+        self.assertTrue(is_prime(SC_ORDER))
+        self.assertEqual(E.order(), SC_ORDER)
+
+    @given(st.integers(0, 2**256 - 1))
+    @example(SC_ORDER - 1)
+    @example(SC_ORDER)
+    @example(2**256 - 1)
+    def test_frombytes(self, x):
+        z_c = make_sc()
+        ret = sc_frombytes(z_c, TestSchnorr.int_to_bytes(x, 32))
+        self.assertEqual(ret == 0, x < SC_ORDER)
+        self.assertEqual(sc_val(z_c), x % SC_ORDER)
+
+    @given(st.integers(0, 2**512 - 1))
+    @example(2**512 - 1)
+    @example(SC_ORDER**2)
+    def test_reduce(self, x):
+        z_c = make_sc()
+        sc_reduce(z_c, TestSchnorr.int_to_bytes(x, 64))
+        self.assertEqual(sc_val(z_c), x % SC_ORDER)
+
+    @given(st_sc, st_sc)
+    @example(SC_ORDER - 1, SC_ORDER - 1)
+    def test_add(self, f, g):
+        h_c = make_sc()
+        sc_add(h_c, make_sc(f), make_sc(g))
+        self.assertEqual(sc_val(h_c), (f + g) % SC_ORDER)
+
+    @given(st_sc)
+    @example(0)
+    def test_neg(self, f):
+        h_c = make_sc()
+        sc_neg(h_c, make_sc(f))
+        self.assertEqual(sc_val(h_c), -f % SC_ORDER)
+
+    @given(st_sc, st_sc)
+    @example(SC_ORDER - 1, SC_ORDER - 1)
+    def test_mul(self, f, g):
+        h_c = make_sc()
+        sc_mul(h_c, make_sc(f), make_sc(g))
+        self.assertEqual(sc_val(h_c), (f * g) % SC_ORDER)
+
+    @given(st_sc, st_sc, st_sc)
+    @example(SC_ORDER - 1, SC_ORDER - 1, SC_ORDER - 1)
+    def test_muladd(self, f, g, a):
+        h_c = make_sc()
+        sc_muladd(h_c, make_sc(f), make_sc(g), make_sc(a))
+        self.assertEqual(sc_val(h_c), (f * g + a) % SC_ORDER)
+
+
+class TestSchnorr(unittest.TestCase):
+    @staticmethod
+    def int_to_bytes(x, length):
+        return (ctypes.c_ubyte * length)(*[(x >> (8*i)) & 0xFF for i in range(length)])
+
+    @staticmethod
+    def bytes_to_int(b):
+        return sum(ord(c) << (8*i) for i, c in enumerate(b))
+
+    @staticmethod
+    def point_to_str(point):
+        (x, y) = point.xy()
+        return ''.join(chr(c) for c in TestGE.point_to_bytes(x.lift(), y.lift()))
+
+    def make_keypair(self):
+        public_key_c = (ctypes.c_ubyte * 64)(0)
+        secret_key_c = (ctypes.c_ubyte * 96)(0)
+        self.assertEqual(schnorr_keypair(public_key_c, secret_key_c), 0)
+        return public_key_c, secret_key_c
+
+    @staticmethod
+    def add_p(encoding):
+        """Encode the x-coordinate as x + p, which is not canonical"""
+        x = sum(ord(c) << (8*i) for i, c in enumerate(encoding[:32])) + P
+        return ''.join(chr((x >> (8*i)) & 0xFF) for i in range(32)) + encoding[32:]
+
+    def sign(self, seed, msg, tamper=None):
+        """Compute the signature from schnorr.h in Python, where `tamper`
+        ('R' or 'A') encodes that point with `add_p`"""
+        h = hashlib.sha512(seed).digest()
+        a = self.bytes_to_int(h[:32]) % 2**255
+        public_key = self.point_to_str(a * SCHNORR_G)
+        if tamper == 'A':
+            public_key = self.add_p(public_key)
+        r = self.bytes_to_int(hashlib.sha512(h + msg).digest()[:32]) % 2**255
+        big_r = self.point_to_str(r * SCHNORR_G)
+        if tamper == 'R':
+            big_r = self.add_p(big_r)
+        e = self.bytes_to_int(hashlib.sha512(big_r + public_key + msg).digest()) % SC_ORDER
+        s = (r + e * a) % SC_ORDER
+        return public_key, big_r + ''.join(chr(c) for c in self.int_to_bytes(s, 32))
+
+    @given(st.binary(max_size=256))
+    @example('')
+    def test_sign(self, msg):
+        public_key_c, secret_key_c = self.make_keypair()
+        seed = ''.join(chr(c) for c in secret_key_c[:32])
+        expected_public_key, expected_sig = self.sign(seed, msg)
+        self.assertEqual(''.join(chr(c) for c in public_key_c), expected_public_key)
+        self.assertEqual(''.join(chr(c) for c in secret_key_c[32:]), expected_public_key)
+
+        sig_c = (ctypes.c_ubyte * 96)(0)
+        self.assertEqual(schnorr_sign(sig_c, msg, len(msg), secret_key_c), 0)
+        self.assertEqual(''.join(chr(c) for c in sig_c), expected_sig)
+        self.assertEqual(schnorr_verify(sig_c, msg, len(msg), public_key_c), 0)
+
+    @given(st.binary(max_size=256), st.integers(0, 96*8 - 1))
+    def test_verify_invalid(self, msg, bit):
+        public_key_c, secret_key_c = self.make_keypair()
+        sig_c = (ctypes.c_ubyte * 96)(0)
+        self.assertEqual(schnorr_sign(sig_c, msg, len(msg), secret_key_c), 0)
+        self.assertNotEqual(schnorr_verify(sig_c, msg + 'x', len(msg) + 1, public_key_c), 0)
+        sig_c[bit // 8] ^= 1 << (bit % 8)
+        self.assertNotEqual(schnorr_verify(sig_c, msg, len(msg), public_key_c), 0)
+
+    def test_verify_noncanonical(self):
+        # s + n encodes the same scalar, but it must be rejected
+        public_key_c, secret_key_c = self.make_keypair()
+        sig_c = (ctypes.c_ubyte * 96)(0)
+        for i in range(100):
+            msg = 'message %d' % i
+            self.assertEqual(schnorr_sign(sig_c, msg, len(msg), secret_key_c), 0)
+            s = self.bytes_to_int(''.join(chr(c) for c in sig_c[64:]))
+            if s + SC_ORDER < 2**256:
+                break
+        self.assertEqual(schnorr_verify(sig_c, msg, len(msg), public_key_c), 0)
+        sig_c[64:] = list(self.int_to_bytes(s + SC_ORDER, 32))
+        self.assertNotEqual(schnorr_verify(sig_c, msg, len(msg), public_key_c), 0)
+
+    @given(st.binary(min_size=32, max_size=32), st.binary(max_size=64),
+           st.sampled_from(['R', 'A']))
+    def test_verify_noncanonical_point(self, seed, msg, tamper):
+        # A signature that is valid for the reduced points, but whose R or A
+        # is encoded with x + p: both verifiers must reject it
+        public_key, sig = self.sign(seed, msg, tamper)
+        public_key_c = (ctypes.c_ubyte * 64)(*[ord(c) for c in public_key])
+        sig_c = (ctypes.c_ubyte * 96)(*[ord(c) for c in sig])
+        self.assertNotEqual(schnorr_verify(sig_c, msg, len(msg), public_key_c), 0)
+        ret = schnorr_verify_batch(((ctypes.c_ubyte * 96) * 1)(sig_c),
+                                   (ctypes.c_char_p * 1)(msg), (ctypes.c_size_t * 1)(len(msg)),
+                                   ((ctypes.c_ubyte * 64) * 1)(public_key_c), ctypes.c_size_t(1))
+        self.assertNotEqual(ret, 0)
+
+    def check_verify_batch(self, msgs, bad):
+        sigs_c = ((ctypes.c_ubyte * 96) * len(msgs))()
+        public_keys_c = ((ctypes.c_ubyte * 64) * len(msgs))()
+        for i, msg in enumerate(msgs):
+            public_key_c, secret_key_c = self.make_keypair()
+            self.assertEqual(schnorr_sign(sigs_c[i], msg, len(msg), secret_key_c), 0)
+            public_keys_c[i][:] = list(public_key_c)
+        if bad is not None:
+            # Verify the signature of bad with the message of the next one
+            msgs = list(msgs)
+            msgs[bad % len(msgs)] = msgs[(bad + 1) % len(msgs)] + 'x'
+        msgs_c = (ctypes.c_char_p * len(msgs))(*msgs)
+        msg_lens_c = (ctypes.c_size_t * len(msgs))(*[len(msg) for msg in msgs])
+        ret = schnorr_verify_batch(sigs_c, msgs_c, msg_lens_c, public_keys_c,
+                                   ctypes.c_size_t(len(msgs)))
+        if bad is None:
+            self.assertEqual(ret, 0)
+        else:
+            self.assertNotEqual(ret, 0)
+
+    @settings(max_examples=20)
+    @given(st.lists(st.binary(max_size=64), min_size=1, max_size=20),
+           st.one_of(st.none(), st.integers(0, 19)))
+    def test_verify_batch(self, msgs, bad):
+        self.check_verify_batch(msgs, bad)
+
+
+class TestHashToCurve(unittest.TestCase):
+    DST = 'curve13318-test'
+
+    @staticmethod
+    def expand_message(msg, dst):
+        """expand_message_xmd with SHA-512, for 96 bytes"""
+        dst_prime = dst + chr(len(dst))
+        b0 = hashlib.sha512('\0' * 128 + msg + '\0\x60\0' + dst_prime).digest()
+        b1 = hashlib.sha512(b0 + '\x01' + dst_prime).digest()
+        b2 = hashlib.sha512(''.join(chr(ord(x) ^ ord(y)) for x, y in zip(b0, b1)) +
+                            '\x02' + dst_prime).digest()
+        return b1 + b2[:32]
+
+    def hash_to_field(self, msg, dst):
+        uniform = self.expand_message(msg, dst)
+        return [F(int(uniform[48*i:48*(i + 1)].encode('hex'), 16)) for i in range(2)]
+
+    @staticmethod
+    def map_to_curve(u):
+        """The simplified SWU map with Z = 2"""
+        A, B, Z = F(-3), F(13318), F(2)
+        tv = Z * u**2
+        if tv**2 + tv == 0:
+            x1 = B / (Z * A)
+        else:
+            x1 = (-B / A) * (1 + 1 / (tv**2 + tv))
+        gx1 = x1**3 + A * x1 + B
+        if gx1.is_square():
+            x, y = x1, gx1.sqrt()
+        else:
+            x = tv * x1
+            y = (x**3 + A * x + B).sqrt()
+        if u.lift() % 2 != y.lift() % 2:
+            y = -y
+        return E(x, y)
+
+    @staticmethod
+    def ge_to_str(point_c):
+        bytes_c = (ctypes.c_ubyte * 64)(0)
+        ge_tobytes(bytes_c, point_c)
+        return ''.join(chr(c) for c in bytes_c)
+
+    @given(st.binary(max_size=256), st.binary(max_size=255))
+    @example('', '')
+    def test_hash_to_field(self, msg, dst):
+        u_c = (ctypes.c_ubyte * 64)(0)
+        self.assertEqual(hash_to_field(u_c, msg, len(msg), dst, len(dst)), 0)
+        expected = self.hash_to_field(msg, dst)
+        for i in range(2):
+            u = sum(c << (8*j) for j, c in enumerate(u_c[32*i:32*(i + 1)]))
+            self.assertEqual(u, expected[i].lift())
+
+    def test_dst_too_long(self):
+        u_c = (ctypes.c_ubyte * 64)(0)
+        out_c = (ctypes.c_ubyte * 64)(0)
+        dst = 'x' * 256
+        self.assertNotEqual(hash_to_field(u_c, 'msg', 3, dst, len(dst)), 0)
+        self.assertNotEqual(hash_to_curve(out_c, 'msg', 3, dst, len(dst)), 0)
+
+    @given(st.integers(0, P - 1))
+    @example(0)
+    @example(1)
+    @example(P - 1)
+    def test_map_to_curve(self, u):
+        point_c = ge_type()
+        ge_map_to_curve(point_c, TestSchnorr.int_to_bytes(u, 32))
+        expected = TestSchnorr.point_to_str(self.map_to_curve(F(u)))
+        self.assertEqual(self.ge_to_str(point_c), expected)
+
+    @given(st.lists(st.integers(0, P - 1), min_size=4, max_size=4))
+    @example([0, 1, P - 1, 2])
+    def test_map_to_curve_x4(self, values):
+        u_c = ((ctypes.c_ubyte * 32) * 4)()
+        for i, u in enumerate(values):
+            u_c[i] = TestSchnorr.int_to_bytes(u, 32)
+        vp_c = allocate_aligned(ge_x4_type, 32)
+        ge_map_to_curve_x4(vp_c, u_c)
+        for i, lane in enumerate(ge_x4_lanes(vp_c)):
+            point_c = ge_type(*[fe12_type(*coord) for coord in lane])
+            expected = TestSchnorr.point_to_str(self.map_to_curve(F(values[i])))
+            self.assertEqual(self.ge_to_str(point_c), expected)
+
+    @given(st.binary(max_size=256))
+    @example('')
+    def test_hash_to_curve(self, msg):
+        out_c = (ctypes.c_ubyte * 64)(0)
+        self.assertEqual(hash_to_curve(out_c, msg, len(msg), self.DST, len(self.DST)), 0)
+        u0, u1 = self.hash_to_field(msg, self.DST)
+        expected = self.map_to_curve(u0) + self.map_to_curve(u1)
+        self.assertEqual(''.join(chr(c) for c in out_c), TestSchnorr.point_to_str(expected))
+
+    @given(st.lists(st.binary(max_size=64), min_size=4, max_size=4))
+    def test_hash_to_curve_x4(self, msgs):
+        out_c = ((ctypes.c_ubyte * 64) * 4)()
+        msgs_c = (ctypes.c_char_p * 4)(*msgs)
+        msg_lens_c = (ctypes.c_size_t * 4)(*[len(msg) for msg in msgs])
+        self.assertEqual(hash_to_curve_x4(out_c, msgs_c, msg_lens_c, self.DST,
+                                          ctypes.c_size_t(len(self.DST))), 0)
+        for i, msg in enumerate(msgs):
+            single_c = (ctypes.c_ubyte * 64)(0)
+            self.assertEqual(hash_to_curve(single_c, msg, len(msg), self.DST, len(self.DST)), 0)
+            self.assertEqual(list(out_c[i]), list(single_c))
+
+
 def allocate_aligned(ty, align):
     """
     Python does not do any aligned allocations by default. At least, not
@@ -778,6 +1761,52 @@ def make_fe12x4(limbs, lane):
         vz_c[4*i + lane] = limb
     return z, vz_c
 
+def make_ge_x4(point_c):
+    """Make a ge_x4 with `point_c` (a ge value) in all four lanes"""
+    stashed = []
+    vp_c = ge_x4_type(0.0)
+    while ctypes.addressof(vp_c) % 32 != 0:
+        stashed.append(vp_c)
+        vp_c = ge_x4_type(0.0)
+    for c in range(3):
+        for i in range(12):
+            for lane in range(4):
+                vp_c[48*c + 4*i + lane] = point_c[c][i]
+    return vp_c
+
+def ge_x4_lanes(vp_c):
+    """Split a ge_x4 into its four lanes, as lists of coordinates"""
+    return [[list(vp_c[48*c + lane:48*(c + 1):4]) for c in range(3)]
+            for lane in range(4)]
+
+def ge_add_x4_lanes(p3_c, p1_c, p2_c):
+    """ge_add with ge_add_x4: all lanes must give the same result"""
+    vp3_c = make_ge_x4(p3_c)
+    ge_add_x4(vp3_c, make_ge_x4(p1_c), make_ge_x4(p2_c))
+    lanes = ge_x4_lanes(vp3_c)
+    assert all(lane == lanes[0] for lane in lanes), lanes
+    for c in range(3):
+        p3_c[c] = fe12_type(*lanes[0][c])
+
+def ge_double_x4_lanes(p3_c, p_c):
+    """ge_double with ge_double_x4: all lanes must give the same result"""
+    vp3_c = make_ge_x4(p3_c)
+    ge_double_x4(vp3_c, make_ge_x4(p_c))
+    lanes = ge_x4_lanes(vp3_c)
+    assert all(lane == lanes[0] for lane in lanes), lanes
+    for c in range(3):
+        p3_c[c] = fe12_type(*lanes[0][c])
+
+def make_fe12x4_values(values):
+    """Make a squeezed fe12x4 with the integers in `values` in its lanes"""
+    bytes_c = ((ctypes.c_ubyte * 32) * 4)()
+    for i, x in enumerate(values):
+        bytes_c[i] = (ctypes.c_ubyte * 32)(*[(x >> (8*j)) & 0xFF for j in range(32)])
+    _, z_c = make_fe12x4([], 0)
+    fe12x4_frombytes(z_c, bytes_c)
+    fe12x4_squeeze(z_c)
+    return z_c
+
 def fe12_val(z):
     return sum(int(x) for x in z)
 
@@ -818,6 +1847,18 @@ def fe51_val(h):
         val += limb * 2**(51*i)
     return val
 
+def make_sc(value=0):
+    return sc_type(*[(value >> (64*i)) & (2**64 - 1) for i in range(4)])
+
+def sc_val(h):
+    return sum(limb * 2**(64*i) for i, limb in enumerate(h))
+
+def make_fe64(value=0):
+    return fe64_type(*[(value >> (64*i)) & (2**64 - 1) for i in range(4)])
+
+def fe64_val(h):
+    return sum(limb * 2**(64*i) for i, limb in enumerate(h))
+
 def make_ge(x, z, sign):
     if F(z) != 0:
         try: